@@ -26,6 +26,8 @@
 #include "egg-dh.h"
 #include "egg-secure-memory.h"
 
+#include <string.h>
+
 /* Enabling this is a complete security compromise */
 #define DEBUG_DH_SECRET 0
 
@@ -212,6 +214,249 @@ static const DHGroup dh_groups[] = {
 	}
 };
 
+/*
+ * Fixed base exponentiation for the default groups, using a Lim-Lee comb.
+ *
+ * The exponent is split into COMB_TEETH rows of 'columns' bits each. The
+ * table holds the product of base^(2^(row * columns)) for every combination
+ * of rows, so one pass over the columns takes a squaring and a multiply
+ * each.
+ *
+ * This only makes the exponentiation faster, it is not constant time. Table
+ * entries are read with a full masked scan, but gcry_mpi_mulm() takes less
+ * time for short operands, such as the one for a zero digit, and the length
+ * of the exponent shows as well.
+ */
+
+#define COMB_TEETH 6
+#define COMB_ENTRIES (1 << COMB_TEETH)
+
+typedef struct {
+	gcry_mpi_t prime;
+	gcry_mpi_t base;
+	guint columns;
+	gsize n_entry;
+	guint64 *entries;
+} DHComb;
+
+G_LOCK_DEFINE_STATIC (dh_combs);
+static DHComb *dh_combs[G_N_ELEMENTS (dh_groups)] = { NULL, };
+
+static void
+dh_comb_store (DHComb *comb,
+               guint index,
+               gcry_mpi_t value)
+{
+	guchar *entry;
+	gsize n_value;
+	gcry_error_t gcry;
+
+	entry = (guchar *)(comb->entries + index * (comb->n_entry / 8));
+	gcry = gcry_mpi_print (GCRYMPI_FMT_USG, NULL, 0, &n_value, value);
+	g_return_if_fail (gcry == 0 && n_value <= comb->n_entry);
+
+	/* Right aligned, big endian, zero padded */
+	memset (entry, 0, comb->n_entry);
+	gcry = gcry_mpi_print (GCRYMPI_FMT_USG, entry + (comb->n_entry - n_value),
+	                       n_value, NULL, value);
+	g_return_if_fail (gcry == 0);
+}
+
+static DHComb *
+dh_comb_new (const DHGroup *group,
+             gcry_mpi_t prime,
+             gcry_mpi_t base)
+{
+	gcry_mpi_t rows[COMB_TEETH];
+	gcry_mpi_t value;
+	DHComb *comb;
+	guint row, i, j;
+
+	comb = g_new0 (DHComb, 1);
+	comb->prime = gcry_mpi_copy (prime);
+	comb->base = gcry_mpi_copy (base);
+	comb->columns = (group->bits + COMB_TEETH - 1) / COMB_TEETH;
+	comb->n_entry = ((group->n_prime + 7) / 8) * 8;
+	comb->entries = g_malloc0 (COMB_ENTRIES * comb->n_entry);
+
+	/* base^(2^(row * columns)) for each row */
+	rows[0] = gcry_mpi_copy (base);
+	for (row = 1; row < COMB_TEETH; row++) {
+		rows[row] = gcry_mpi_copy (rows[row - 1]);
+		for (i = 0; i < comb->columns; i++)
+			gcry_mpi_mulm (rows[row], rows[row], rows[row], prime);
+	}
+
+	/* Every combination of rows */
+	value = gcry_mpi_new (group->bits);
+	for (i = 0; i < COMB_ENTRIES; i++) {
+		gcry_mpi_set_ui (value, 1);
+		for (j = 0; j < COMB_TEETH; j++) {
+			if (i & (1 << j))
+				gcry_mpi_mulm (value, value, rows[j], prime);
+		}
+		dh_comb_store (comb, i, value);
+	}
+
+	gcry_mpi_release (value);
+	for (row = 0; row < COMB_TEETH; row++)
+		gcry_mpi_release (rows[row]);
+
+	return comb;
+}
+
+static const DHComb *
+dh_comb_for_params (gcry_mpi_t prime,
+                    gcry_mpi_t base)
+{
+	const DHGroup *group;
+	gcry_mpi_t check_prime;
+	gcry_mpi_t check_base;
+	DHComb *comb = NULL;
+	gcry_error_t gcry;
+	guint pbits;
+	guint index;
+
+	pbits = gcry_mpi_get_nbits (prime);
+
+	for (group = dh_groups, index = 0; group->name; ++group, ++index) {
+		if (group->bits != pbits)
+			continue;
+
+		G_LOCK (dh_combs);
+
+		/* Built lazily the first time the group is used */
+		if (dh_combs[index] == NULL) {
+			gcry = gcry_mpi_scan (&check_prime, GCRYMPI_FMT_USG, group->prime, group->n_prime, NULL);
+			g_assert (gcry == 0);
+			gcry = gcry_mpi_scan (&check_base, GCRYMPI_FMT_USG, group->base, group->n_base, NULL);
+			g_assert (gcry == 0);
+
+			if (gcry_mpi_cmp (check_prime, prime) == 0 &&
+			    gcry_mpi_cmp (check_base, base) == 0)
+				dh_combs[index] = dh_comb_new (group, prime, base);
+
+			gcry_mpi_release (check_prime);
+			gcry_mpi_release (check_base);
+		}
+
+		comb = dh_combs[index];
+
+		G_UNLOCK (dh_combs);
+
+		if (comb != NULL &&
+		    gcry_mpi_cmp (comb->prime, prime) == 0 &&
+		    gcry_mpi_cmp (comb->base, base) == 0)
+			return comb;
+	}
+
+	return NULL;
+}
+
+static void
+dh_comb_select (const DHComb *comb,
+                guint digit,
+                guint64 *selected)
+{
+	const guint64 *entry;
+	gsize n_words;
+	guint64 mask;
+	guint i;
+	gsize j;
+
+	n_words = comb->n_entry / 8;
+	memset (selected, 0, comb->n_entry);
+
+	/* Copy out the entry for this digit into selected */
+	for (i = 0; i < COMB_ENTRIES; i++) {
+		mask = (guint64)((((i ^ digit) & 0xFFFF) - 1) >> 16) & 1;
+		mask = ~(mask - 1);
+		entry = comb->entries + i * n_words;
+		for (j = 0; j < n_words; j++)
+			selected[j] |= entry[j] & mask;
+	}
+}
+
+static gboolean
+dh_comb_powm (const DHComb *comb,
+              gcry_mpi_t result,
+              gcry_mpi_t exponent)
+{
+	guint64 *selected;
+	guchar *bytes;
+	gsize n_bytes;
+	gsize n_exponent;
+	gcry_mpi_t value;
+	gcry_error_t gcry;
+	gboolean ret;
+	guint digit;
+	guint bit;
+	gint column;
+	guint row;
+
+	n_bytes = (comb->columns * COMB_TEETH + 7) / 8;
+	gcry = gcry_mpi_print (GCRYMPI_FMT_USG, NULL, 0, &n_exponent, exponent);
+	g_return_val_if_fail (gcry == 0, FALSE);
+	if (n_exponent > n_bytes)
+		return FALSE;
+
+	bytes = egg_secure_alloc (n_bytes);
+	selected = egg_secure_alloc (comb->n_entry);
+
+	/* The exponent, right aligned, big endian, zero padded */
+	gcry = gcry_mpi_print (GCRYMPI_FMT_USG, bytes + (n_bytes - n_exponent),
+	                       n_exponent, NULL, exponent);
+	ret = (gcry == 0);
+
+	gcry_mpi_set_ui (result, 1);
+
+	for (column = comb->columns - 1; ret && column >= 0; column--) {
+		gcry_mpi_mulm (result, result, result, comb->prime);
+
+		digit = 0;
+		for (row = 0; row < COMB_TEETH; row++) {
+			bit = row * comb->columns + column;
+			digit |= ((bytes[n_bytes - 1 - bit / 8] >> (bit % 8)) & 1) << row;
+		}
+
+		/* Entry zero holds one, so a zero digit needs no special case */
+		dh_comb_select (comb, digit, selected);
+		gcry = gcry_mpi_scan (&value, GCRYMPI_FMT_USG, selected, comb->n_entry, NULL);
+		if (gcry != 0) {
+			ret = FALSE;
+			break;
+		}
+		gcry_mpi_mulm (result, result, value, comb->prime);
+		gcry_mpi_release (value);
+	}
+
+	egg_secure_clear (selected, comb->n_entry);
+	egg_secure_free (selected);
+	egg_secure_clear (bytes, n_bytes);
+	egg_secure_free (bytes);
+
+	/* On failure the caller falls back to gcry_mpi_powm() */
+	return ret;
+}
+
+gboolean
+egg_dh_powm_fixed_base (gcry_mpi_t result, gcry_mpi_t base,
+                        gcry_mpi_t exponent, gcry_mpi_t prime)
+{
+	const DHComb *comb;
+
+	g_return_val_if_fail (result, FALSE);
+	g_return_val_if_fail (base, FALSE);
+	g_return_val_if_fail (exponent, FALSE);
+	g_return_val_if_fail (prime, FALSE);
+
+	comb = dh_comb_for_params (prime, base);
+	if (comb == NULL)
+		return FALSE;
+
+	return dh_comb_powm (comb, result, exponent);
+}
+
 gboolean
 egg_dh_default_params_raw (const gchar *name, gconstpointer *prime,
                            gsize *n_prime, gconstpointer *base, gsize *n_base)
@@ -303,7 +548,10 @@ egg_dh_gen_pair (gcry_mpi_t prime, gcry_mpi_t base, guint bits,
 
 	*pub = gcry_mpi_new (gcry_mpi_get_nbits (*priv));
 	g_return_val_if_fail (*pub, FALSE);
-	gcry_mpi_powm (*pub, base, *priv, prime);
+
+	/* Use the precomputed tables when these are the default params */
+	if (!egg_dh_powm_fixed_base (*pub, base, *priv, prime))
+		gcry_mpi_powm (*pub, base, *priv, prime);
 
 	return TRUE;
 }
@@ -44,6 +44,11 @@ gboolean   egg_dh_gen_pair                                    (gcry_mpi_t prime,
                                                                gcry_mpi_t *pub,
                                                                gcry_mpi_t *priv);
 
+gboolean   egg_dh_powm_fixed_base                             (gcry_mpi_t result,
+                                                               gcry_mpi_t base,
+                                                               gcry_mpi_t exponent,
+                                                               gcry_mpi_t prime);
+
 gpointer   egg_dh_gen_secret                                  (gcry_mpi_t peer,
                                                                gcry_mpi_t priv,
                                                                gcry_mpi_t prime,
@@ -185,9 +185,137 @@ test_default_bad (void)
 	g_assert (!ret);
 }
 
+static const gchar *fixed_base_groups[] = {
+	"ietf-ike-grp-modp-768",
+	"ietf-ike-grp-modp-1024",
+	"ietf-ike-grp-modp-1536",
+	"ietf-ike-grp-modp-2048",
+	"ietf-ike-grp-modp-3072",
+	"ietf-ike-grp-modp-4096",
+	"ietf-ike-grp-modp-8192",
+};
+
+static void
+test_fixed_base (gconstpointer data)
+{
+	const gchar *name = data;
+	gcry_mpi_t p, g, x;
+	gcry_mpi_t fixed, check;
+	gboolean ret;
+	guint bits;
+	gint i;
+
+	ret = egg_dh_default_params (name, &p, &g);
+	g_assert (ret);
+	bits = gcry_mpi_get_nbits (p);
+
+	fixed = gcry_mpi_new (bits);
+	check = gcry_mpi_new (bits);
+	x = gcry_mpi_snew (bits);
+
+	for (i = 0; i < 4; i++) {
+		gcry_mpi_randomize (x, bits - 1, GCRY_WEAK_RANDOM);
+		ret = egg_dh_powm_fixed_base (fixed, g, x, p);
+		g_assert (ret);
+		gcry_mpi_powm (check, g, x, p);
+		g_assert (gcry_mpi_cmp (fixed, check) == 0);
+	}
+
+	/* Small and zero exponents */
+	gcry_mpi_set_ui (x, 1);
+	ret = egg_dh_powm_fixed_base (fixed, g, x, p);
+	g_assert (ret);
+	g_assert (gcry_mpi_cmp (fixed, g) == 0);
+
+	gcry_mpi_set_ui (x, 0);
+	ret = egg_dh_powm_fixed_base (fixed, g, x, p);
+	g_assert (ret);
+	g_assert (gcry_mpi_cmp_ui (fixed, 1) == 0);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (x);
+	gcry_mpi_release (fixed);
+	gcry_mpi_release (check);
+}
+
+static void
+test_fixed_base_other (void)
+{
+	gcry_mpi_t p, g, x, result;
+	gboolean ret;
+
+	ret = egg_dh_default_params ("ietf-ike-grp-modp-1024", &p, &g);
+	g_assert (ret);
+
+	/* Not the default base, so no tables */
+	gcry_mpi_set_ui (g, 5);
+	x = gcry_mpi_set_ui (NULL, 12345);
+	result = gcry_mpi_new (1024);
+	ret = egg_dh_powm_fixed_base (result, g, x, p);
+	g_assert (!ret);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (x);
+	gcry_mpi_release (result);
+}
+
+static void
+test_benchmark_fixed_base (gconstpointer data)
+{
+	const gchar *name = data;
+	gcry_mpi_t p, g, x, result;
+	gdouble fixed = 0;
+	gdouble generic = 0;
+	gboolean ret;
+	guint iterations;
+	guint bits;
+	guint i;
+
+	ret = egg_dh_default_params (name, &p, &g);
+	g_assert (ret);
+	bits = gcry_mpi_get_nbits (p);
+	iterations = MAX (400000 / bits / 4, 4);
+
+	result = gcry_mpi_new (bits);
+	x = gcry_mpi_snew (bits);
+	gcry_mpi_randomize (x, bits - 1, GCRY_WEAK_RANDOM);
+
+	/* Build the tables outside of the timing */
+	ret = egg_dh_powm_fixed_base (result, g, x, p);
+	g_assert (ret);
+
+	for (i = 0; i < iterations; i++) {
+		gcry_mpi_randomize (x, bits - 1, GCRY_WEAK_RANDOM);
+
+		g_test_timer_start ();
+		egg_dh_powm_fixed_base (result, g, x, p);
+		fixed += g_test_timer_elapsed ();
+
+		g_test_timer_start ();
+		gcry_mpi_powm (result, g, x, p);
+		generic += g_test_timer_elapsed ();
+	}
+
+	g_test_minimized_result (fixed / iterations, "%s fixed base: %.3f msec",
+	                         name, (fixed / iterations) * 1000);
+	g_test_minimized_result (generic / iterations, "%s gcry_mpi_powm: %.3f msec",
+	                         name, (generic / iterations) * 1000);
+
+	gcry_mpi_release (p);
+	gcry_mpi_release (g);
+	gcry_mpi_release (x);
+	gcry_mpi_release (result);
+}
+
 int
 main (int argc, char **argv)
 {
+	const gchar *name;
+	gchar *path;
+	guint i;
+
 	g_test_init (&argc, &argv, NULL);
 
 	if (!g_test_quick ()) {
@@ -204,5 +332,24 @@ main (int argc, char **argv)
 	g_test_add_func ("/dh/default_8192", test_default_8192);
 	g_test_add_func ("/dh/default_bad", test_default_bad);
 
+	for (i = 0; i < G_N_ELEMENTS (fixed_base_groups); i++) {
+		name = fixed_base_groups[i];
+
+		/* The larger groups take a while to build tables for */
+		if (i < 2 || !g_test_quick ()) {
+			path = g_strdup_printf ("/dh/fixed_base/%s", name);
+			g_test_add_data_func (path, name, test_fixed_base);
+			g_free (path);
+		}
+
+		if (g_test_perf ()) {
+			path = g_strdup_printf ("/dh/benchmark_fixed_base/%s", name);
+			g_test_add_data_func (path, name, test_benchmark_fixed_base);
+			g_free (path);
+		}
+	}
+
+	g_test_add_func ("/dh/fixed_base_other", test_fixed_base_other);
+
 	return g_test_run ();
 }
@@ -19,10 +19,10 @@ service = mock.SecretService()
 service.add_standard_objects()
 
 collection = mock.SecretCollection(service, "todelete", locked=False)
-mock.SecretItem(collection, "item", attributes={ "number": "1", "string": "one", "even": "false" }, secret="uno")
-mock.SecretItem(collection, "confirm", attributes={ "number": "2", "string": "two", "even": "true" }, secret="dos", confirm=True)
+mock.SecretItem(collection, "item", attributes={ "number": "1", "string": "one", "even": "false", "batch": "true" }, secret="uno")
+mock.SecretItem(collection, "confirm", attributes={ "number": "2", "string": "two", "even": "true", "batch": "true" }, secret="dos", confirm=True)
 
 collection = mock.SecretCollection(service, "twodelete", locked=True)
-mock.SecretItem(collection, "locked", attributes={ "number": "3", "string": "three", "even": "false" }, secret="tres")
+mock.SecretItem(collection, "locked", attributes={ "number": "3", "string": "three", "even": "false", "batch": "true" }, secret="tres")
 
 service.listen()
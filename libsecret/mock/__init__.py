@@ -10,4 +10,5 @@
 #
 
 from .service import SecretItem, SecretCollection, SecretService, SecretPrompt
-from .service import PlainAlgorithm, NotSupported
+from .service import PlainAlgorithm, AesAlgorithm, X25519Algorithm, X25519GcmAlgorithm
+from .service import NotSupported
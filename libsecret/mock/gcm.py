@@ -0,0 +1,77 @@
+#
+# Copyright 2012 Red Hat Inc.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation; either version 2.1 of the licence or (at
+# your option) any later version.
+#
+# See the included COPYING file for more information.
+#
+
+# AES-GCM as described in NIST SP 800-38D, with 96-bit nonces and without
+# additional authenticated data. This is slow and only suitable for testing.
+
+from mock import aes
+
+TAG_SIZE = 16
+NONCE_SIZE = 12
+
+_R = 0xE1 << 120
+
+def _block_encrypt(key, block):
+	cipher = aes.AES()
+	return bytes(cipher.encrypt(list(block), key, len(key)))
+
+def _gf_mult(x, y):
+	z = 0
+	v = y
+	for i in range(127, -1, -1):
+		if (x >> i) & 1:
+			z ^= v
+		if v & 1:
+			v = (v >> 1) ^ _R
+		else:
+			v >>= 1
+	return z
+
+def _ghash(h, data):
+	y = 0
+	for i in range(0, len(data), 16):
+		block = data[i:i + 16].ljust(16, b'\x00')
+		y = _gf_mult(y ^ int.from_bytes(block, 'big'), h)
+	length = (len(data) * 8).to_bytes(16, 'big')
+	y = _gf_mult(y ^ int.from_bytes(length, 'big'), h)
+	return y
+
+def _ctr(key, counter, data):
+	output = bytearray()
+	for i in range(0, len(data), 16):
+		counter = (counter & ~0xFFFFFFFF) | ((counter + 1) & 0xFFFFFFFF)
+		stream = _block_encrypt(key, counter.to_bytes(16, 'big'))
+		chunk = data[i:i + 16]
+		output.extend(a ^ b for (a, b) in zip(chunk, stream))
+	return bytes(output)
+
+def _tag(key, j0, h, ciphertext):
+	mask = int.from_bytes(_block_encrypt(key, j0.to_bytes(16, 'big')), 'big')
+	return (_ghash(h, ciphertext) ^ mask).to_bytes(16, 'big')
+
+def encrypt(key, nonce, plaintext):
+	if len(nonce) != NONCE_SIZE:
+		raise ValueError("invalid GCM nonce")
+	h = int.from_bytes(_block_encrypt(key, b'\x00' * 16), 'big')
+	j0 = int.from_bytes(bytes(nonce) + b'\x00\x00\x00\x01', 'big')
+	ciphertext = _ctr(key, j0, bytes(plaintext))
+	return ciphertext + _tag(key, j0, h, ciphertext)
+
+def decrypt(key, nonce, data):
+	if len(nonce) != NONCE_SIZE or len(data) < TAG_SIZE:
+		raise ValueError("invalid GCM parameters")
+	data = bytes(data)
+	ciphertext, tag = data[:-TAG_SIZE], data[-TAG_SIZE:]
+	h = int.from_bytes(_block_encrypt(key, b'\x00' * 16), 'big')
+	j0 = int.from_bytes(bytes(nonce) + b'\x00\x00\x00\x01', 'big')
+	if _tag(key, j0, h, ciphertext) != tag:
+		raise ValueError("GCM authentication failed")
+	return _ctr(key, j0, ciphertext)
@@ -16,7 +16,7 @@ import os
 import sys
 import time
 
-from mock import aes, dh, hkdf
+from mock import aes, dh, gcm, hkdf, x25519
 
 import dbus
 import dbus.service
@@ -108,6 +108,32 @@ class AesAlgorithm():
 		return aes.strip_PKCS7_padding(decr)
 
 
+class X25519Algorithm(AesAlgorithm):
+	def negotiate(self, service, sender, param):
+		if type (param) != dbus.ByteArray:
+			raise InvalidArgs("invalid argument passed to OpenSession")
+		privat, publi = x25519.generate_pair()
+		try:
+			ikm = x25519.derive_key(privat, bytes(param))
+		except ValueError:
+			raise InvalidArgs("invalid X25519 public key passed to OpenSession")
+		key = hkdf.hkdf(ikm, 16)
+		session = SecretSession(service, sender, self, key)
+		return (dbus.ByteArray(publi, variant_level=1), session)
+
+
+class X25519GcmAlgorithm(X25519Algorithm):
+	def encrypt(self, key, data):
+		nonce = os.urandom(gcm.NONCE_SIZE)
+		return nonce, gcm.encrypt(key, nonce, data)
+
+	def decrypt(self, key, param, data):
+		try:
+			return gcm.decrypt(key, param, data)
+		except ValueError:
+			raise InvalidArgs("invalid encrypted secret")
+
+
 class SecretPrompt(dbus.service.Object):
 	def __init__(self, service, sender, prompt_name=None, delay=0,
 	             dismiss=False, action=None):
@@ -244,6 +270,7 @@ class SecretItem(dbus.service.Object):
 		if self.get_locked():
 			raise IsLocked("secret is locked: %s" % self.path)
 		(self.secret, self.content_type) = session.decode_secret(secret)
+		self.collection.item_changed(self)
 
 	@dbus.service.method('org.freedesktop.Secret.Item', sender_keyword='sender')
 	def Delete(self, sender=None):
@@ -293,6 +320,7 @@ class SecretItem(dbus.service.Object):
 		else:
 			raise InvalidArgs('Not writable %s property' % property_name)
 		self.PropertiesChanged(interface_name, { property_name: new_value }, [])
+		self.collection.item_changed(self)
 
 	@dbus.service.signal(dbus.PROPERTIES_IFACE, signature='sa{sv}as')
 	def PropertiesChanged(self, interface_name, changed_properties, invalidated_properties):
@@ -325,11 +353,26 @@ class SecretCollection(dbus.service.Object):
 		self.items[item.path] = item
 		for alias in self.aliased:
 			item.add_alias(alias)
+		if self.service.item_signals:
+			self.ItemCreated(dbus.ObjectPath(item.path))
+		self.items_changed()
 
 	def remove_item(self, item):
 		for alias in self.aliased:
 			item.remove_alias(alias)
 		del self.items[item.path]
+		if self.service.item_signals:
+			self.ItemDeleted(dbus.ObjectPath(item.path))
+		self.items_changed()
+
+	def items_changed(self):
+		if self.service.items_property_signals:
+			items = dbus.Array([dbus.ObjectPath(i) for i in self.items], signature='o', variant_level=1)
+			self.PropertiesChanged('org.freedesktop.Secret.Collection', { "Items": items }, [])
+
+	def item_changed(self, item):
+		if self.service.item_signals:
+			self.ItemChanged(dbus.ObjectPath(item.path))
 
 	def add_alias(self, name):
 		if name in self.aliased:
@@ -406,6 +449,7 @@ class SecretCollection(dbus.service.Object):
 			item.secret = secret
 			item.attributes = attributes
 			item.content_type = content_type
+			self.item_changed(item)
 		return (dbus.ObjectPath(item.path), dbus.ObjectPath("/"))
 
 	@dbus.service.method('org.freedesktop.Secret.Collection')
@@ -458,14 +502,48 @@ class SecretCollection(dbus.service.Object):
 	def PropertiesChanged(self, interface_name, changed_properties, invalidated_properties):
 		self.modified = time.time()
 
+	@dbus.service.signal('org.freedesktop.Secret.Collection', signature='o')
+	def ItemCreated(self, item_path):
+		pass
+
+	@dbus.service.signal('org.freedesktop.Secret.Collection', signature='o')
+	def ItemDeleted(self, item_path):
+		pass
+
+	@dbus.service.signal('org.freedesktop.Secret.Collection', signature='o')
+	def ItemChanged(self, item_path):
+		pass
+
 
 class SecretService(dbus.service.Object):
 
 	algorithms = {
 		'plain': PlainAlgorithm(),
 		"dh-ietf1024-sha256-aes128-cbc-pkcs7": AesAlgorithm(),
+		"x25519-sha256-aes128-cbc-pkcs7": X25519Algorithm(),
+		"x25519-sha256-aes128-gcm": X25519GcmAlgorithm(),
 	}
 
+	capabilities = [
+		"lookup-secret",
+		"delete-items",
+	]
+
+	# The spec signals for items, off by default to not disturb other tests
+	item_signals = False
+
+	# Also announce item changes with PropertiesChanged(Items), like gnome-keyring
+	items_property_signals = False
+
+	# Not part of the spec, so off by default like most real services
+	object_manager = False
+
+	# How many GetManagedObjects calls fail before it works again
+	object_manager_failures = 0
+
+	# Reply to LookupSecret with the wrong signature
+	lookup_secret_malformed = False
+
 	def __init__(self):
 		self.bus = dbus.SessionBus()
 		dbus.service.Object.__init__(self, self.bus, '/org/freedesktop/secrets')
@@ -644,6 +722,46 @@ class SecretService(dbus.service.Object):
 				results[item_path] = item.GetSecret(session_path, sender)
 		return results
 
+	@dbus.service.method('org.freedesktop.Secret.Service', sender_keyword='sender')
+	def LookupSecret(self, attributes, session_path, sender=None):
+		if "lookup-secret" not in self.capabilities:
+			raise dbus.exceptions.DBusException("LookupSecret is not supported",
+			                                    name="org.freedesktop.DBus.Error.UnknownMethod")
+		(unlocked, locked) = self.SearchItems(attributes)
+		if self.lookup_secret_malformed:
+			return dbus.Array(unlocked, "o")
+		results = self.GetSecrets(unlocked[:1], session_path, sender)
+		if results:
+			locked = [ ]
+		return (results, dbus.Array(locked, "o"))
+
+	@dbus.service.method('org.freedesktop.Secret.Service', sender_keyword='sender')
+	def DeleteItems(self, item_paths, sender=None):
+		if "delete-items" not in self.capabilities:
+			raise dbus.exceptions.DBusException("DeleteItems is not supported",
+			                                    name="org.freedesktop.DBus.Error.UnknownMethod")
+		deleted = []
+		prompts = []
+		for item_path in item_paths:
+			item = objects.get(item_path, None)
+			if not isinstance(item, SecretItem) or item.get_locked():
+				continue
+			if item.confirm:
+				prompts.append(item)
+			else:
+				item.perform_delete()
+				deleted.append(item_path)
+		def prompt_callback():
+			for item in prompts:
+				item.perform_delete()
+			return dbus.Array([i.path for i in prompts], signature='o', variant_level=1)
+		deleted = dbus.Array(deleted, signature='o')
+		if prompts:
+			prompt = SecretPrompt(self, sender, dismiss=False, action=prompt_callback)
+			return (deleted, dbus.ObjectPath(prompt.path))
+		else:
+			return (deleted, dbus.ObjectPath("/"))
+
 	@dbus.service.method('org.freedesktop.Secret.Service')
 	def ReadAlias(self, name):
 		if name not in self.aliases:
@@ -659,6 +777,24 @@ class SecretService(dbus.service.Object):
 				raise NoSuchObject("no such Collection")
 			self.set_alias(name, self.collections[collection])
 
+	@dbus.service.method('org.freedesktop.DBus.ObjectManager', out_signature='a{oa{sa{sv}}}')
+	def GetManagedObjects(self):
+		if not self.object_manager:
+			raise dbus.exceptions.DBusException("GetManagedObjects is not supported",
+			                                    name="org.freedesktop.DBus.Error.UnknownMethod")
+		if self.object_manager_failures > 0:
+			self.object_manager_failures -= 1
+			raise dbus.exceptions.DBusException("GetManagedObjects failed for now",
+			                                    name="org.freedesktop.DBus.Error.Failed")
+		managed = { }
+		for collection in self.collections.values():
+			interface = 'org.freedesktop.Secret.Collection'
+			managed[dbus.ObjectPath(collection.path)] = { interface: collection.GetAll(interface) }
+			for item in collection.items.values():
+				interface = 'org.freedesktop.Secret.Item'
+				managed[dbus.ObjectPath(item.path)] = { interface: item.GetAll(interface) }
+		return managed
+
 	@dbus.service.method(dbus.PROPERTIES_IFACE, in_signature='ss', out_signature='v')
 	def Get(self, interface_name, property_name):
 		return self.GetAll(interface_name)[property_name]
@@ -666,9 +802,12 @@ class SecretService(dbus.service.Object):
 	@dbus.service.method(dbus.PROPERTIES_IFACE, in_signature='s', out_signature='a{sv}')
 	def GetAll(self, interface_name):
 		if interface_name == 'org.freedesktop.Secret.Service':
-			return {
+			props = {
 				'Collections': dbus.Array([dbus.ObjectPath(c.path) for c in self.collections.values()], signature='o', variant_level=1)
 			}
+			if self.capabilities:
+				props['Capabilities'] = dbus.Array(self.capabilities, signature='s', variant_level=1)
+			return props
 		else:
 			raise InvalidArgs('Unknown %s interface' % interface_name)
 
@@ -0,0 +1,80 @@
+#
+# Copyright 2012 Red Hat Inc.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation; either version 2.1 of the licence or (at
+# your option) any later version.
+#
+# See the included COPYING file for more information.
+#
+
+# X25519 as described in RFC 7748. This is slow and not constant time,
+# and is only suitable for testing.
+
+import os
+
+P = 2 ** 255 - 19
+A24 = 121665
+BASE = 9
+
+def decode_scalar(scalar):
+	k = bytearray(scalar)
+	k[0] &= 248
+	k[31] &= 127
+	k[31] |= 64
+	return int.from_bytes(bytes(k), 'little')
+
+def decode_u(u):
+	u = bytearray(u)
+	u[31] &= 127
+	return int.from_bytes(bytes(u), 'little')
+
+def encode_u(u):
+	return (u % P).to_bytes(32, 'little')
+
+def ladder(k, u):
+	x1 = u
+	x2, z2 = 1, 0
+	x3, z3 = u, 1
+	swap = 0
+	for t in reversed(range(255)):
+		kt = (k >> t) & 1
+		swap ^= kt
+		if swap:
+			x2, x3 = x3, x2
+			z2, z3 = z3, z2
+		swap = kt
+		a = (x2 + z2) % P
+		aa = (a * a) % P
+		b = (x2 - z2) % P
+		bb = (b * b) % P
+		e = (aa - bb) % P
+		c = (x3 + z3) % P
+		d = (x3 - z3) % P
+		da = (d * a) % P
+		cb = (c * b) % P
+		x3 = ((da + cb) ** 2) % P
+		z3 = (x1 * ((da - cb) ** 2)) % P
+		x2 = (aa * bb) % P
+		z2 = (e * (aa + A24 * e)) % P
+	if swap:
+		x2, x3 = x3, x2
+		z2, z3 = z3, z2
+	return (x2 * pow(z2, P - 2, P)) % P
+
+def scalar_mult(scalar, u):
+	return encode_u(ladder(decode_scalar(scalar), decode_u(u)))
+
+def generate_pair():
+	privat = os.urandom(32)
+	publi = encode_u(ladder(decode_scalar(privat), BASE))
+	return (privat, publi)
+
+def derive_key(privat, peer):
+	if len(peer) != 32:
+		raise ValueError("invalid X25519 public key")
+	shared = scalar_mult(privat, peer)
+	if shared == b'\x00' * 32:
+		raise ValueError("invalid X25519 public key")
+	return shared
@@ -0,0 +1,693 @@
+/* libsecret - GLib wrapper for Secret Service
+ *
+ * Copyright 2012 Red Hat Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the licence or (at
+ * your option) any later version.
+ *
+ * See the included COPYING file for more information.
+ */
+
+#include "config.h"
+
+#include "secret-private.h"
+
+#include <string.h>
+
+#ifdef HAVE_GETRLIMIT
+#include <sys/resource.h>
+#endif
+
+/*
+ * A cache of SearchItems replies, keyed by the attributes searched for.
+ * Each reply holds the paths of the matching items, split by whether
+ * they are locked or not.
+ *
+ * Secret values may also be cached, keyed by item path. These are kept in
+ * secure memory, so their total size is limited to a budget, and the least
+ * recently used are evicted to stay within it. They can also expire a
+ * while after they were retrieved, after which they are fetched again.
+ *
+ * The cache is kept coherent with the signals the secret service emits.
+ * These are seen in a GDBusConnection filter, which runs as messages
+ * arrive, so an entry is dropped before any reply that follows the signal
+ * on the bus is dispatched. Replies to searches which were in flight
+ * while a signal arrived are not stored.
+ */
+
+#define CACHE_MAX_SEARCHES 1024
+
+#define CACHE_DEFAULT_BUDGET (1024 * 1024)
+
+typedef struct {
+	GList link;
+	gchar *path;
+	SecretValue *value;
+	gsize size;
+	gint64 expires;
+} CacheSecret;
+
+struct _SecretCache {
+	gint refs;
+	gchar *bus_name;
+
+	/* Locked by mutex */
+	GMutex mutex;
+	guint64 generation;
+
+	gboolean searching;
+	GHashTable *searches;
+	guint64 hits;
+	guint64 misses;
+	guint64 invalidations;
+
+	gsize budget;
+	gint64 ttl;
+	GHashTable *secrets;
+	GQueue lru;
+	gsize secret_bytes;
+	guint64 secret_hits;
+	guint64 secret_misses;
+	guint64 evictions;
+};
+
+static void
+cache_secret_free (gpointer data)
+{
+	CacheSecret *secret = data;
+	secret_value_unref (secret->value);
+	g_free (secret->path);
+	g_slice_free (CacheSecret, secret);
+}
+
+SecretCache *
+_secret_cache_new (const gchar *bus_name)
+{
+	SecretCache *cache;
+
+	cache = g_slice_new0 (SecretCache);
+	cache->refs = 1;
+	cache->bus_name = g_strdup (bus_name);
+	g_mutex_init (&cache->mutex);
+	cache->searches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                         (GDestroyNotify)g_variant_unref);
+	cache->secrets = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+	                                        cache_secret_free);
+	g_queue_init (&cache->lru);
+
+	return cache;
+}
+
+SecretCache *
+_secret_cache_ref (SecretCache *cache)
+{
+	g_return_val_if_fail (cache != NULL, NULL);
+	g_atomic_int_inc (&cache->refs);
+	return cache;
+}
+
+void
+_secret_cache_unref (gpointer data)
+{
+	SecretCache *cache = data;
+
+	g_return_if_fail (cache != NULL);
+
+	if (g_atomic_int_dec_and_test (&cache->refs)) {
+		g_hash_table_destroy (cache->searches);
+		g_hash_table_destroy (cache->secrets);
+		g_mutex_clear (&cache->mutex);
+		g_free (cache->bus_name);
+		g_slice_free (SecretCache, cache);
+	}
+}
+
+void
+_secret_cache_enable_searches (SecretCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+	cache->searching = TRUE;
+	g_mutex_unlock (&cache->mutex);
+}
+
+gboolean
+_secret_cache_caches_searches (SecretCache *cache)
+{
+	gboolean searching;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+
+	g_mutex_lock (&cache->mutex);
+	searching = cache->searching;
+	g_mutex_unlock (&cache->mutex);
+
+	return searching;
+}
+
+static gint
+compare_attribute_names (gconstpointer a,
+                         gconstpointer b)
+{
+	return strcmp (*(const gchar **)a, *(const gchar **)b);
+}
+
+static gchar *
+cache_key_for_attributes (GVariant *attributes)
+{
+	GVariantBuilder builder;
+	GVariantIter iter;
+	GPtrArray *names;
+	GVariant *sorted;
+	const gchar *name;
+	const gchar *value;
+	gchar *key;
+	guint i;
+
+	/* The same attributes may come from hash tables in any order */
+	names = g_ptr_array_new ();
+	g_variant_iter_init (&iter, attributes);
+	while (g_variant_iter_next (&iter, "{&s&s}", &name, NULL))
+		g_ptr_array_add (names, (gpointer)name);
+	g_ptr_array_sort (names, compare_attribute_names);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{ss}"));
+	for (i = 0; i < names->len; i++) {
+		name = names->pdata[i];
+		g_variant_lookup (attributes, name, "&s", &value);
+		g_variant_builder_add (&builder, "{ss}", name, value);
+	}
+
+	sorted = g_variant_ref_sink (g_variant_builder_end (&builder));
+	key = g_variant_print (sorted, FALSE);
+	g_variant_unref (sorted);
+	g_ptr_array_free (names, TRUE);
+
+	return key;
+}
+
+gboolean
+_secret_cache_lookup_search (SecretCache *cache,
+                             GVariant *attributes,
+                             GVariant **reply,
+                             guint64 *generation)
+{
+	GVariant *found = NULL;
+	gchar *key;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (attributes != NULL, FALSE);
+	g_return_val_if_fail (reply != NULL, FALSE);
+
+	key = cache_key_for_attributes (attributes);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (cache->searching) {
+		found = g_hash_table_lookup (cache->searches, key);
+		if (found) {
+			*reply = g_variant_ref (found);
+			cache->hits++;
+		} else {
+			cache->misses++;
+		}
+	}
+	if (generation)
+		*generation = cache->generation;
+
+	g_mutex_unlock (&cache->mutex);
+
+	g_free (key);
+	return found != NULL;
+}
+
+void
+_secret_cache_store_search (SecretCache *cache,
+                            GVariant *attributes,
+                            GVariant *reply,
+                            guint64 generation)
+{
+	gchar *key;
+
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (g_variant_is_of_type (reply, G_VARIANT_TYPE ("(aoao)")));
+
+	key = cache_key_for_attributes (attributes);
+
+	g_mutex_lock (&cache->mutex);
+
+	/* Something changed while the search was in flight */
+	if (cache->searching && generation == cache->generation) {
+		if (g_hash_table_size (cache->searches) >= CACHE_MAX_SEARCHES)
+			g_hash_table_remove_all (cache->searches);
+		g_hash_table_replace (cache->searches, key, g_variant_ref (reply));
+		key = NULL;
+	}
+
+	g_mutex_unlock (&cache->mutex);
+
+	g_free (key);
+}
+
+void
+_secret_cache_get_search_stats (SecretCache *cache,
+                                guint64 *hits,
+                                guint64 *misses,
+                                guint64 *invalidations)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (hits)
+		*hits = cache->hits;
+	if (misses)
+		*misses = cache->misses;
+	if (invalidations)
+		*invalidations = cache->invalidations;
+
+	g_mutex_unlock (&cache->mutex);
+}
+
+static gsize
+cache_secure_budget (void)
+{
+#ifdef HAVE_GETRLIMIT
+	struct rlimit limit;
+
+	/* Leave the rest of the locked memory for sessions and callers */
+	if (getrlimit (RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+		return limit.rlim_cur / 2;
+#endif
+
+	return CACHE_DEFAULT_BUDGET;
+}
+
+static void
+cache_remove_secret (SecretCache *cache,
+                     CacheSecret *secret)
+{
+	g_queue_unlink (&cache->lru, &secret->link);
+	cache->secret_bytes -= secret->size;
+	g_hash_table_remove (cache->secrets, secret->path);
+}
+
+static void
+cache_clear_secrets (SecretCache *cache)
+{
+	g_hash_table_remove_all (cache->secrets);
+	g_queue_init (&cache->lru);
+	cache->secret_bytes = 0;
+}
+
+static void
+cache_trim_secrets (SecretCache *cache,
+                    gint64 now)
+{
+	CacheSecret *secret;
+	GList *link;
+
+	/* Expired secrets elsewhere in the list are dropped when looked up */
+	while ((link = g_queue_peek_tail_link (&cache->lru)) != NULL) {
+		secret = link->data;
+		if (cache->secret_bytes <= cache->budget &&
+		    (secret->expires == 0 || secret->expires > now))
+			break;
+		cache_remove_secret (cache, secret);
+		cache->evictions++;
+	}
+}
+
+void
+_secret_cache_set_secret_policy (SecretCache *cache,
+                                 gssize max_bytes,
+                                 guint max_age)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	cache->budget = max_bytes < 0 ? cache_secure_budget () : max_bytes;
+	cache->ttl = (gint64)max_age * G_USEC_PER_SEC;
+	if (cache->budget == 0)
+		cache_clear_secrets (cache);
+	else
+		cache_trim_secrets (cache, g_get_monotonic_time ());
+
+	g_mutex_unlock (&cache->mutex);
+}
+
+gboolean
+_secret_cache_caches_secrets (SecretCache *cache)
+{
+	gboolean caching;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+
+	g_mutex_lock (&cache->mutex);
+	caching = cache->budget > 0;
+	g_mutex_unlock (&cache->mutex);
+
+	return caching;
+}
+
+guint64
+_secret_cache_get_generation (SecretCache *cache)
+{
+	guint64 generation;
+
+	g_return_val_if_fail (cache != NULL, 0);
+
+	g_mutex_lock (&cache->mutex);
+	generation = cache->generation;
+	g_mutex_unlock (&cache->mutex);
+
+	return generation;
+}
+
+static CacheSecret *
+cache_lookup_secret (SecretCache *cache,
+                     const gchar *path)
+{
+	CacheSecret *secret;
+
+	secret = g_hash_table_lookup (cache->secrets, path);
+	if (secret && secret->expires != 0 && secret->expires <= g_get_monotonic_time ()) {
+		cache_remove_secret (cache, secret);
+		cache->evictions++;
+		secret = NULL;
+	}
+
+	return secret;
+}
+
+SecretValue *
+_secret_cache_lookup_secret (SecretCache *cache,
+                             const gchar *path,
+                             guint64 *generation)
+{
+	SecretValue *value = NULL;
+	CacheSecret *secret;
+
+	g_return_val_if_fail (cache != NULL, NULL);
+	g_return_val_if_fail (path != NULL, NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (cache->budget > 0) {
+		secret = cache_lookup_secret (cache, path);
+		if (secret) {
+			g_queue_unlink (&cache->lru, &secret->link);
+			g_queue_push_head_link (&cache->lru, &secret->link);
+			value = secret_value_ref (secret->value);
+			cache->secret_hits++;
+		} else {
+			cache->secret_misses++;
+		}
+	}
+	if (generation)
+		*generation = cache->generation;
+
+	g_mutex_unlock (&cache->mutex);
+
+	return value;
+}
+
+gboolean
+_secret_cache_contains_secret (SecretCache *cache,
+                               const gchar *path)
+{
+	gboolean found;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	g_mutex_lock (&cache->mutex);
+	found = cache_lookup_secret (cache, path) != NULL;
+	g_mutex_unlock (&cache->mutex);
+
+	return found;
+}
+
+void
+_secret_cache_store_secret (SecretCache *cache,
+                            const gchar *path,
+                            SecretValue *value,
+                            guint64 generation)
+{
+	CacheSecret *secret;
+	gsize size = 0;
+
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (path != NULL);
+
+	if (value != NULL) {
+		secret_value_get (value, &size);
+		value = secret_value_move_to_secure (secret_value_ref (value));
+	}
+
+	g_mutex_lock (&cache->mutex);
+
+	secret = g_hash_table_lookup (cache->secrets, path);
+	if (secret)
+		cache_remove_secret (cache, secret);
+
+	/* Not cached if it changed while it was being retrieved */
+	if (value != NULL && cache->budget > 0 && size <= cache->budget &&
+	    generation == cache->generation) {
+		secret = g_slice_new0 (CacheSecret);
+		secret->link.data = secret;
+		secret->path = g_strdup (path);
+		secret->value = value;
+		secret->size = size;
+		if (cache->ttl > 0)
+			secret->expires = g_get_monotonic_time () + cache->ttl;
+		g_hash_table_insert (cache->secrets, secret->path, secret);
+		g_queue_push_head_link (&cache->lru, &secret->link);
+		cache->secret_bytes += size;
+		cache_trim_secrets (cache, g_get_monotonic_time ());
+		value = NULL;
+	}
+
+	g_mutex_unlock (&cache->mutex);
+
+	if (value != NULL)
+		secret_value_unref (value);
+}
+
+void
+_secret_cache_get_secret_stats (SecretCache *cache,
+                                guint64 *hits,
+                                guint64 *misses,
+                                guint64 *evictions,
+                                gsize *bytes)
+{
+	g_return_if_fail (cache != NULL);
+
+	g_mutex_lock (&cache->mutex);
+
+	if (hits)
+		*hits = cache->secret_hits;
+	if (misses)
+		*misses = cache->secret_misses;
+	if (evictions)
+		*evictions = cache->evictions;
+	if (bytes)
+		*bytes = cache->secret_bytes;
+
+	g_mutex_unlock (&cache->mutex);
+}
+
+static void
+cache_invalidate_searches (SecretCache *cache)
+{
+	cache->generation++;
+	cache->invalidations += g_hash_table_size (cache->searches);
+	g_hash_table_remove_all (cache->searches);
+}
+
+static gboolean
+reply_contains_path (GVariant *reply,
+                     const gchar *path)
+{
+	GVariantIter iter;
+	GVariant *paths;
+	const gchar *item;
+	gboolean found = FALSE;
+	gsize i;
+
+	g_variant_iter_init (&iter, reply);
+	while (!found && (paths = g_variant_iter_next_value (&iter)) != NULL) {
+		for (i = 0; !found && i < g_variant_n_children (paths); i++) {
+			g_variant_get_child (paths, i, "&o", &item);
+			found = g_str_equal (item, path);
+		}
+		g_variant_unref (paths);
+	}
+
+	return found;
+}
+
+static void
+cache_invalidate_item (SecretCache *cache,
+                       const gchar *path)
+{
+	GHashTableIter iter;
+	CacheSecret *secret;
+	GVariant *reply;
+
+	cache->generation++;
+	g_hash_table_iter_init (&iter, cache->searches);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&reply)) {
+		if (reply_contains_path (reply, path)) {
+			g_hash_table_iter_remove (&iter);
+			cache->invalidations++;
+		}
+	}
+
+	secret = g_hash_table_lookup (cache->secrets, path);
+	if (secret)
+		cache_remove_secret (cache, secret);
+}
+
+static gboolean
+has_property (GVariant *changed,
+              const gchar **invalidated,
+              const gchar *name)
+{
+	GVariant *value;
+	guint i;
+
+	value = g_variant_lookup_value (changed, name, NULL);
+	if (value != NULL) {
+		g_variant_unref (value);
+		return TRUE;
+	}
+
+	for (i = 0; invalidated && invalidated[i] != NULL; i++) {
+		if (g_str_equal (invalidated[i], name))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+cache_properties_changed (SecretCache *cache,
+                          const gchar *path,
+                          GVariant *body)
+{
+	const gchar *interface;
+	const gchar **invalidated;
+	GVariant *changed;
+
+	if (!g_variant_is_of_type (body, G_VARIANT_TYPE ("(sa{sv}as)")))
+		return;
+
+	g_variant_get (body, "(&s@a{sv}^a&s)", &interface, &changed, &invalidated);
+
+	/* Changed attributes could make the item match any search */
+	if (g_str_equal (interface, SECRET_ITEM_INTERFACE)) {
+		if (has_property (changed, invalidated, "Attributes"))
+			cache_invalidate_searches (cache);
+		if (has_property (changed, invalidated, "Locked"))
+			cache_invalidate_item (cache, path);
+
+	/* Secrets may be reachable through aliases, so drop them all */
+	} else if (g_str_equal (interface, SECRET_COLLECTION_INTERFACE)) {
+		if (has_property (changed, invalidated, "Locked")) {
+			cache_invalidate_searches (cache);
+			cache_clear_secrets (cache);
+		} else if (has_property (changed, invalidated, "Items")) {
+			cache_invalidate_searches (cache);
+		}
+
+	} else if (g_str_equal (interface, SECRET_SERVICE_INTERFACE)) {
+		if (has_property (changed, invalidated, "Collections"))
+			cache_invalidate_searches (cache);
+	}
+
+	g_variant_unref (changed);
+	g_free (invalidated);
+}
+
+static void
+cache_process_signal (SecretCache *cache,
+                      const gchar *interface,
+                      const gchar *member,
+                      const gchar *path,
+                      GVariant *body)
+{
+	const gchar *name;
+
+	if (g_str_equal (interface, SECRET_SERVICE_INTERFACE)) {
+		if (g_str_equal (member, SECRET_SIGNAL_COLLECTION_CREATED)) {
+			cache_invalidate_searches (cache);
+		} else if (g_str_equal (member, SECRET_SIGNAL_COLLECTION_DELETED) ||
+		           g_str_equal (member, SECRET_SIGNAL_COLLECTION_CHANGED)) {
+			cache_invalidate_searches (cache);
+			cache_clear_secrets (cache);
+		}
+
+	} else if (g_str_equal (interface, SECRET_COLLECTION_INTERFACE)) {
+		if (g_str_equal (member, SECRET_SIGNAL_ITEM_CREATED)) {
+			cache_invalidate_searches (cache);
+
+		/* A changed item could now match any search */
+		} else if (g_str_equal (member, SECRET_SIGNAL_ITEM_CHANGED) &&
+		           g_variant_is_of_type (body, G_VARIANT_TYPE ("(o)"))) {
+			g_variant_get (body, "(&o)", &path);
+			cache_invalidate_item (cache, path);
+			cache_invalidate_searches (cache);
+
+		} else if (g_str_equal (member, SECRET_SIGNAL_ITEM_DELETED) &&
+		           g_variant_is_of_type (body, G_VARIANT_TYPE ("(o)"))) {
+			g_variant_get (body, "(&o)", &path);
+			cache_invalidate_item (cache, path);
+		}
+
+	} else if (g_str_equal (interface, SECRET_PROPERTIES_INTERFACE)) {
+		if (g_str_equal (member, "PropertiesChanged"))
+			cache_properties_changed (cache, path, body);
+
+	} else if (g_str_equal (interface, "org.freedesktop.DBus")) {
+		if (g_str_equal (member, "NameOwnerChanged") &&
+		    g_variant_is_of_type (body, G_VARIANT_TYPE ("(sss)"))) {
+			g_variant_get (body, "(&sss)", &name, NULL, NULL);
+			if (g_str_equal (name, cache->bus_name)) {
+				cache_invalidate_searches (cache);
+				cache_clear_secrets (cache);
+			}
+		}
+	}
+}
+
+void
+_secret_cache_process_message (SecretCache *cache,
+                               GDBusMessage *message)
+{
+	const gchar *interface;
+	const gchar *member;
+	const gchar *path;
+	GVariant *body;
+
+	g_return_if_fail (cache != NULL);
+
+	if (g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_SIGNAL)
+		return;
+
+	interface = g_dbus_message_get_interface (message);
+	member = g_dbus_message_get_member (message);
+	path = g_dbus_message_get_path (message);
+	body = g_dbus_message_get_body (message);
+	if (interface == NULL || member == NULL || path == NULL || body == NULL)
+		return;
+
+	g_mutex_lock (&cache->mutex);
+	cache_process_signal (cache, interface, member, path, body);
+	g_mutex_unlock (&cache->mutex);
+}
@@ -98,6 +98,13 @@ enum {
 	PROP_MODIFIED
 };
 
+enum {
+	ITEMS_CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
 struct _SecretCollectionPrivate {
 	/* Doesn't change between construct and finalize */
 	SecretService *service;
@@ -108,6 +115,9 @@ struct _SecretCollectionPrivate {
 	/* Protected by mutex */
 	GMutex mutex;
 	GHashTable *items;
+	GSequence *items_order;
+	GHashTable *objects;
+	GHashTable *creating;
 };
 
 static GInitableIface *secret_collection_initable_parent_iface = NULL;
@@ -139,6 +149,7 @@ secret_collection_init (SecretCollection *self)
 	g_mutex_init (&self->pv->mutex);
 	self->pv->cancellable = g_cancellable_new ();
 	self->pv->constructing = TRUE;
+	self->pv->creating = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
@@ -171,6 +182,9 @@ collection_take_service (SecretCollection *self,
 	g_object_add_weak_pointer (G_OBJECT (self->pv->service),
 	                           (gpointer *)&self->pv->service);
 
+	/* Does nothing while still constructing, see secret_collection_constructed() */
+	_secret_service_register_proxy (service, G_DBUS_PROXY (self));
+
 	/* Yes, we expect that the service will stay around */
 	g_object_unref (service);
 }
@@ -248,17 +262,36 @@ secret_collection_dispose (GObject *obj)
 }
 
 static void
-secret_collection_finalize (GObject *obj)
+secret_collection_constructed (GObject *obj)
 {
 	SecretCollection *self = SECRET_COLLECTION (obj);
 
+	G_OBJECT_CLASS (secret_collection_parent_class)->constructed (obj);
+
+	/* Signals for our object path are routed to us by the service */
 	if (self->pv->service)
+		_secret_service_register_proxy (self->pv->service, G_DBUS_PROXY (self));
+}
+
+static void
+secret_collection_finalize (GObject *obj)
+{
+	SecretCollection *self = SECRET_COLLECTION (obj);
+
+	if (self->pv->service) {
+		_secret_service_unregister_proxy (self->pv->service, G_DBUS_PROXY (self));
 		g_object_remove_weak_pointer (G_OBJECT (self->pv->service),
 		                              (gpointer *)&self->pv->service);
+	}
 
 	g_mutex_clear (&self->pv->mutex);
 	if (self->pv->items)
 		g_hash_table_destroy (self->pv->items);
+	if (self->pv->items_order)
+		g_sequence_free (self->pv->items_order);
+	if (self->pv->objects)
+		g_hash_table_unref (self->pv->objects);
+	g_hash_table_destroy (self->pv->creating);
 	g_object_unref (self->pv->cancellable);
 
 	G_OBJECT_CLASS (secret_collection_parent_class)->finalize (obj);
@@ -269,20 +302,248 @@ collection_update_items (SecretCollection *self,
                          GHashTable *items)
 {
 	GHashTable *previous;
-
-	g_hash_table_ref (items);
+	GSequence *previous_order;
+	GHashTable *index;
+	GSequence *order;
+	GHashTableIter iter;
+	gpointer path;
+	gpointer item;
+	guint removed = 0;
+	guint added;
+
+	/* Index each item by path, into the list in the order they're exposed */
+	order = g_sequence_new (g_object_unref);
+	index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_iter_init (&iter, items);
+	while (g_hash_table_iter_next (&iter, &path, &item)) {
+		g_hash_table_insert (index, g_strdup (path),
+		                     g_sequence_append (order, g_object_ref (item)));
+	}
+	added = g_sequence_get_length (order);
 
 	g_mutex_lock (&self->pv->mutex);
 	previous = self->pv->items;
-	self->pv->items = items;
+	previous_order = self->pv->items_order;
+	self->pv->items = index;
+	self->pv->items_order = order;
 	g_mutex_unlock (&self->pv->mutex);
 
-	if (previous != NULL)
+	if (previous != NULL) {
+		removed = g_sequence_get_length (previous_order);
 		g_hash_table_unref (previous);
+		g_sequence_free (previous_order);
+	}
 
+	g_signal_emit (self, signals[ITEMS_CHANGED], 0, 0, removed, added);
 	g_object_notify (G_OBJECT (self), "items");
 }
 
+static void
+collection_update_cached_items (SecretCollection *self,
+                                const gchar *path,
+                                gboolean present)
+{
+	GVariantBuilder builder;
+	gboolean found = FALSE;
+	GVariantIter iter;
+	const gchar *other;
+	GVariant *paths;
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
+	if (paths == NULL)
+		return;
+
+	/* Keep "Items" current for daemons that only send ItemCreated and ItemDeleted */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("ao"));
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_next (&iter, "&o", &other)) {
+		if (g_str_equal (other, path)) {
+			found = TRUE;
+			if (!present)
+				continue;
+		}
+		g_variant_builder_add (&builder, "o", other);
+	}
+	if (present && !found)
+		g_variant_builder_add (&builder, "o", path);
+
+	if (found != present)
+		g_dbus_proxy_set_cached_property (G_DBUS_PROXY (self), "Items",
+		                                  g_variant_builder_end (&builder));
+	else
+		g_variant_builder_clear (&builder);
+
+	g_variant_unref (paths);
+}
+
+static void
+collection_add_item (SecretCollection *self,
+                     SecretItem *item)
+{
+	const gchar *path;
+	GSequenceIter *iter;
+	gboolean added = FALSE;
+	guint position = 0;
+
+	path = g_dbus_proxy_get_object_path (G_DBUS_PROXY (item));
+
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->items != NULL && !g_hash_table_contains (self->pv->items, path)) {
+		iter = g_sequence_append (self->pv->items_order, g_object_ref (item));
+		g_hash_table_insert (self->pv->items, g_strdup (path), iter);
+		position = g_sequence_iter_get_position (iter);
+		added = TRUE;
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (added) {
+		g_signal_emit (self, signals[ITEMS_CHANGED], 0, position, 0, 1);
+		g_object_notify (G_OBJECT (self), "items");
+	}
+}
+
+static void
+collection_remove_item (SecretCollection *self,
+                        const gchar *path)
+{
+	SecretItem *item = NULL;
+	GSequenceIter *iter = NULL;
+	guint position = 0;
+
+	collection_update_cached_items (self, path, FALSE);
+
+	g_mutex_lock (&self->pv->mutex);
+	g_hash_table_remove (self->pv->creating, path);
+	if (self->pv->items != NULL)
+		iter = g_hash_table_lookup (self->pv->items, path);
+	if (iter != NULL) {
+		position = g_sequence_iter_get_position (iter);
+		item = g_object_ref (g_sequence_get (iter));
+		g_hash_table_remove (self->pv->items, path);
+		g_sequence_remove (iter);
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (item != NULL) {
+		g_signal_emit (self, signals[ITEMS_CHANGED], 0, position, 1, 0);
+		g_object_notify (G_OBJECT (self), "items");
+		g_object_unref (item);
+	}
+}
+
+typedef struct {
+	SecretCollection *collection;
+	gchar *path;
+} CreatedClosure;
+
+static void
+on_item_created (GObject *source,
+                 GAsyncResult *result,
+                 gpointer user_data)
+{
+	CreatedClosure *closure = user_data;
+	SecretCollection *self = closure->collection;
+	SecretItem *item;
+	gboolean current;
+
+	/* Ignore failures, the item may well have gone away again */
+	item = secret_item_new_for_dbus_path_finish (result, NULL);
+
+	/* Dropped when ItemDeleted came in while this was loading */
+	g_mutex_lock (&self->pv->mutex);
+	current = g_hash_table_lookup (self->pv->creating, closure->path) == closure;
+	if (current)
+		g_hash_table_remove (self->pv->creating, closure->path);
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (item != NULL) {
+		if (current) {
+			collection_update_cached_items (self, closure->path, TRUE);
+			collection_add_item (self, item);
+		}
+		g_object_unref (item);
+	}
+
+	g_object_unref (self);
+	g_free (closure->path);
+	g_slice_free (CreatedClosure, closure);
+}
+
+static void
+collection_create_item (SecretCollection *self,
+                        const gchar *item_path)
+{
+	CreatedClosure *closure = NULL;
+	gboolean loaded;
+
+	g_mutex_lock (&self->pv->mutex);
+	loaded = self->pv->items != NULL;
+	if (loaded && self->pv->service != NULL &&
+	    !g_hash_table_contains (self->pv->items, item_path) &&
+	    !g_hash_table_contains (self->pv->creating, item_path)) {
+		closure = g_slice_new0 (CreatedClosure);
+		closure->collection = g_object_ref (self);
+		closure->path = g_strdup (item_path);
+		g_hash_table_insert (self->pv->creating, g_strdup (item_path), closure);
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	/* Nothing to load, but a later load of the items should see it */
+	if (!loaded)
+		collection_update_cached_items (self, item_path, TRUE);
+
+	if (closure != NULL)
+		secret_item_new_for_dbus_path (self->pv->service, item_path, SECRET_ITEM_NONE,
+		                               self->pv->cancellable, on_item_created,
+		                               closure);
+}
+
+static void
+collection_diff_items (SecretCollection *self,
+                       GVariant *paths)
+{
+	GPtrArray *removed;
+	GHashTable *wanted;
+	GHashTableIter iter;
+	GVariantIter viter;
+	const gchar *path;
+	gpointer key;
+	guint i;
+
+	wanted = g_hash_table_new (g_str_hash, g_str_equal);
+	g_variant_iter_init (&viter, paths);
+	while (g_variant_iter_next (&viter, "&o", &path))
+		g_hash_table_add (wanted, (gpointer)path);
+
+	removed = g_ptr_array_new_with_free_func (g_free);
+
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->items != NULL) {
+		g_hash_table_iter_init (&iter, self->pv->items);
+		while (g_hash_table_iter_next (&iter, &key, NULL)) {
+			if (!g_hash_table_contains (wanted, key))
+				g_ptr_array_add (removed, g_strdup (key));
+		}
+	}
+	g_hash_table_iter_init (&iter, self->pv->creating);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		if (!g_hash_table_contains (wanted, key))
+			g_ptr_array_add (removed, g_strdup (key));
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	/* Only the items that came or went, rather than loading them all again */
+	for (i = 0; i < removed->len; i++)
+		collection_remove_item (self, removed->pdata[i]);
+
+	g_variant_iter_init (&viter, paths);
+	while (g_variant_iter_next (&viter, "&o", &path))
+		collection_create_item (self, path);
+
+	g_ptr_array_free (removed, TRUE);
+	g_hash_table_unref (wanted);
+}
+
 static void
 handle_property_changed (SecretCollection *self,
                          const gchar *property_name,
@@ -308,7 +569,7 @@ handle_property_changed (SecretCollection *self,
 		g_mutex_unlock (&self->pv->mutex);
 
 		if (perform)
-			secret_collection_load_items (self, self->pv->cancellable, NULL, NULL);
+			collection_diff_items (self, value);
 	}
 }
 
@@ -340,78 +601,34 @@ secret_collection_signal (GDBusProxy *proxy,
 	SecretCollection *self = SECRET_COLLECTION (proxy);
 	SecretItem *item;
 	const gchar *item_path;
-	GVariantBuilder builder;
-	gboolean found = FALSE;
-	GVariantIter iter;
-	GVariant *value;
-	GVariant *paths;
-	GVariant *path;
 
 	/*
 	 * Remember that these signals come from a time before PropertiesChanged.
 	 * We support them because they're in the spec, and ksecretservice uses them.
+	 *
+	 * Only the one item is added or removed, rather than loading them all again.
 	 */
 
-	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
-
-	/* A new collection was added, add it to the Collections property */
+	/* A new item was added, load it and add it to our items */
 	if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_CREATED)) {
-		g_variant_get (parameters, "(@o)", &value);
-		g_variant_builder_init (&builder, G_VARIANT_TYPE ("ao"));
-		g_variant_iter_init (&iter, paths);
-		while ((path = g_variant_iter_next_value (&iter)) != NULL) {
-			if (g_variant_equal (path, value)) {
-				found = TRUE;
-				break;
-			}
-			g_variant_builder_add_value (&builder, path);
-			g_variant_unref (path);
-		}
-		if (!found) {
-			g_variant_builder_add_value (&builder, value);
-			handle_property_changed (self, "Items", g_variant_builder_end (&builder));
-		}
-		g_variant_builder_clear (&builder);
-		g_variant_unref (value);
+		g_variant_get (parameters, "(&o)", &item_path);
+		collection_create_item (self, item_path);
 
-	/* A collection was deleted, remove it from the Collections property */
+	/* An item was deleted, remove it from our items */
 	} else if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_DELETED)) {
-		g_variant_get (parameters, "(@o)", &value);
-		g_variant_builder_init (&builder, G_VARIANT_TYPE ("ao"));
-		g_variant_iter_init (&iter, paths);
-		while ((path = g_variant_iter_next_value (&iter)) != NULL) {
-			if (g_variant_equal (path, value))
-				found = TRUE;
-			else
-				g_variant_builder_add_value (&builder, path);
-			g_variant_unref (path);
-		}
-		if (found)
-			handle_property_changed (self, "Items", g_variant_builder_end (&builder));
-		g_variant_unref (value);
+		g_variant_get (parameters, "(&o)", &item_path);
+		collection_remove_item (self, item_path);
 
-	/* The collection changed, update it */
+	/* The item changed, update it */
 	} else if (g_str_equal (signal_name, SECRET_SIGNAL_ITEM_CHANGED)) {
 		g_variant_get (parameters, "(&o)", &item_path);
 
-		g_mutex_lock (&self->pv->mutex);
-
-		if (self->pv->items)
-			item = g_hash_table_lookup (self->pv->items, item_path);
-		else
-			item = NULL;
-		if (item)
-			g_object_ref (item);
-
-		g_mutex_unlock (&self->pv->mutex);
-
+		item = _secret_collection_find_item_instance (self, item_path);
 		if (item) {
 			secret_item_refresh (item);
 			g_object_unref (item);
 		}
 	}
-
-	g_variant_unref (paths);
 }
 
 static void
@@ -422,6 +639,7 @@ secret_collection_class_init (SecretCollectionClass *klass)
 
 	gobject_class->get_property = secret_collection_get_property;
 	gobject_class->set_property = secret_collection_set_property;
+	gobject_class->constructed = secret_collection_constructed;
 	gobject_class->dispose = secret_collection_dispose;
 	gobject_class->finalize = secret_collection_finalize;
 
@@ -459,6 +677,22 @@ secret_collection_class_init (SecretCollectionClass *klass)
 	             g_param_spec_boxed ("items", "Items", "Items in collection",
 	                                 _secret_list_get_type (), G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * SecretCollection::items-changed:
+	 * @self: the collection
+	 * @position: the position in secret_collection_get_items() of the change
+	 * @removed: the number of items removed at @position
+	 * @added: the number of items added at @position
+	 *
+	 * Emitted when items are added to or removed from the collection. When
+	 * a single item is created or deleted only that change is reported,
+	 * when all the items are loaded again every item is reported as
+	 * replaced.
+	 */
+	signals[ITEMS_CHANGED] = g_signal_new ("items-changed", SECRET_TYPE_COLLECTION,
+	                                       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+	                                       G_TYPE_NONE, 3, G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT);
+
 	/**
 	 * SecretCollection:label:
 	 *
@@ -539,6 +773,10 @@ secret_collection_initable_init (GInitable *initable,
 
 	proxy = G_DBUS_PROXY (initable);
 
+	/* Not by GDBusProxy, which would watch for changes itself */
+	if (!_secret_util_have_cached_properties (proxy))
+		_secret_util_load_properties_sync (proxy, cancellable);
+
 	if (!_secret_util_have_cached_properties (proxy)) {
 		g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
 		             "No such secret collection at path: %s",
@@ -644,6 +882,43 @@ on_init_service (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+collection_init_with_properties (SecretCollection *self,
+                                 GSimpleAsyncResult *res)
+{
+	InitClosure *init = g_simple_async_result_get_op_res_gpointer (res);
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+
+	if (!_secret_util_have_cached_properties (proxy)) {
+		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                 "No such secret collection at path: %s",
+		                                 g_dbus_proxy_get_object_path (proxy));
+		g_simple_async_result_complete (res);
+
+	} else if (self->pv->service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
+		                    on_init_service, g_object_ref (res));
+
+	} else {
+		collection_ensure_for_flags_async (self, self->pv->init_flags,
+		                                   init->cancellable, res);
+	}
+}
+
+static void
+on_init_properties (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretCollection *self = SECRET_COLLECTION (source);
+
+	_secret_util_load_properties_finish (G_DBUS_PROXY (self), result);
+	collection_init_with_properties (self, res);
+
+	g_object_unref (res);
+}
+
 static void
 on_init_base (GObject *source,
               GAsyncResult *result,
@@ -661,18 +936,12 @@ on_init_base (GObject *source,
 		g_simple_async_result_complete (res);
 
 	} else if (!_secret_util_have_cached_properties (proxy)) {
-		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
-		                                 "No such secret collection at path: %s",
-		                                 g_dbus_proxy_get_object_path (proxy));
-		g_simple_async_result_complete (res);
-
-	} else if (self->pv->service == NULL) {
-		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
-		                    on_init_service, g_object_ref (res));
+		/* Not by GDBusProxy, which would watch for changes itself */
+		_secret_util_load_properties (proxy, init->cancellable,
+		                              on_init_properties, g_object_ref (res));
 
 	} else {
-		collection_ensure_for_flags_async (self, self->pv->init_flags,
-		                                   init->cancellable, res);
+		collection_init_with_properties (self, res);
 	}
 
 	g_object_unref (res);
@@ -776,6 +1045,138 @@ on_load_item (GObject *source,
 	g_object_unref (res);
 }
 
+static GHashTable *
+collection_objects_for_items (SecretCollection *self,
+                              GHashTable *objects)
+{
+	GHashTableIter iter;
+	GHashTable *items;
+	gpointer interfaces;
+	gpointer path;
+	gchar *prefix;
+
+	/* GetManagedObjects describes the whole service, keep our items only */
+	prefix = g_strconcat (g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)), "/", NULL);
+	items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                               (GDestroyNotify)g_variant_unref);
+
+	g_hash_table_iter_init (&iter, objects);
+	while (g_hash_table_iter_next (&iter, &path, &interfaces)) {
+		if (g_str_has_prefix (path, prefix))
+			g_hash_table_insert (items, g_strdup (path), g_variant_ref (interfaces));
+	}
+
+	g_free (prefix);
+	return items;
+}
+
+static GHashTable *
+collection_take_objects (SecretCollection *self)
+{
+	GHashTable *objects;
+
+	g_mutex_lock (&self->pv->mutex);
+	objects = self->pv->objects;
+	self->pv->objects = NULL;
+	g_mutex_unlock (&self->pv->mutex);
+
+	return objects;
+}
+
+static guint
+collection_count_missing_items (SecretCollection *self)
+{
+	SecretItem *item;
+	GVariantIter iter;
+	const gchar *path;
+	GVariant *paths;
+	guint missing = 0;
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
+	g_return_val_if_fail (paths != NULL, 0);
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_next (&iter, "&o", &path)) {
+		item = _secret_collection_find_item_instance (self, path);
+		if (item == NULL)
+			missing++;
+		else
+			g_object_unref (item);
+	}
+
+	g_variant_unref (paths);
+	return missing;
+}
+
+static void
+collection_load_items_for_objects (SecretCollection *self,
+                                   GHashTable *objects,
+                                   GSimpleAsyncResult *res)
+{
+	ItemsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretItem *item;
+	const gchar *path;
+	GVariant *paths;
+	GVariantIter iter;
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
+	g_return_if_fail (paths != NULL);
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_loop (&iter, "&o", &path)) {
+		item = _secret_collection_find_item_instance (self, path);
+
+		/* No such collection yet create a new one */
+		if (item == NULL) {
+			if (objects != NULL)
+				_secret_item_new_for_objects (self->pv->service, path, objects, SECRET_ITEM_NONE,
+				                              closure->cancellable, on_load_item, g_object_ref (res));
+			else
+				secret_item_new_for_dbus_path (self->pv->service, path, SECRET_ITEM_NONE,
+				                               closure->cancellable, on_load_item, g_object_ref (res));
+			closure->items_loading++;
+
+		} else {
+			g_hash_table_insert (closure->items, g_strdup (path), item);
+		}
+	}
+
+	if (closure->items_loading == 0) {
+		collection_update_items (self, closure->items);
+		g_simple_async_result_complete_in_idle (res);
+	}
+
+	g_variant_unref (paths);
+}
+
+static void
+on_load_items_objects (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretCollection *self = SECRET_COLLECTION (g_async_result_get_source_object (user_data));
+	GHashTable *objects;
+	GHashTable *items;
+	GError *error = NULL;
+
+	objects = _secret_service_get_managed_objects_finish (SECRET_SERVICE (source), result, &error);
+	if (error == NULL) {
+		items = objects ? collection_objects_for_items (self, objects) : NULL;
+		collection_load_items_for_objects (self, items, res);
+		if (items != NULL)
+			g_hash_table_unref (items);
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	if (objects != NULL)
+		g_hash_table_unref (objects);
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
 /**
  * secret_collection_load_items:
  * @self: the secret collection
@@ -799,18 +1200,12 @@ secret_collection_load_items (SecretCollection *self,
                               gpointer user_data)
 {
 	ItemsClosure *closure;
-	SecretItem *item;
 	GSimpleAsyncResult *res;
-	const gchar *path;
-	GVariant *paths;
-	GVariantIter iter;
+	GHashTable *objects;
 
 	g_return_if_fail (SECRET_IS_COLLECTION (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
-	g_return_if_fail (paths != NULL);
-
 	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
 	                                 secret_collection_load_items);
 	closure = g_slice_new0 (ItemsClosure);
@@ -818,27 +1213,19 @@ secret_collection_load_items (SecretCollection *self,
 	closure->items = items_table_new ();
 	g_simple_async_result_set_op_res_gpointer (res, closure, items_closure_free);
 
-	g_variant_iter_init (&iter, paths);
-	while (g_variant_iter_loop (&iter, "&o", &path)) {
-		item = _secret_collection_find_item_instance (self, path);
+	/* Already retrieved along with the collection itself? */
+	objects = collection_take_objects (self);
 
-		/* No such collection yet create a new one */
-		if (item == NULL) {
-			secret_item_new_for_dbus_path (self->pv->service, path, SECRET_ITEM_NONE,
-			                               cancellable, on_load_item, g_object_ref (res));
-			closure->items_loading++;
+	/* One GetAll is no slower than retrieving everything */
+	if (objects == NULL && self->pv->service != NULL &&
+	    collection_count_missing_items (self) > 1)
+		_secret_service_get_managed_objects (self->pv->service, cancellable,
+		                                     on_load_items_objects, g_object_ref (res));
+	else
+		collection_load_items_for_objects (self, objects, res);
 
-		} else {
-			g_hash_table_insert (closure->items, g_strdup (path), item);
-		}
-	}
-
-	if (closure->items_loading == 0) {
-		collection_update_items (self, closure->items);
-		g_simple_async_result_complete_in_idle (res);
-	}
-
-	g_variant_unref (paths);
+	if (objects != NULL)
+		g_hash_table_unref (objects);
 	g_object_unref (res);
 }
 
@@ -892,6 +1279,8 @@ secret_collection_load_items_sync (SecretCollection *self,
                                    GCancellable *cancellable,
                                    GError **error)
 {
+	GHashTable *objects = NULL;
+	GError *local_error = NULL;
 	SecretItem *item;
 	GHashTable *items;
 	GVariant *paths;
@@ -903,6 +1292,23 @@ secret_collection_load_items_sync (SecretCollection *self,
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	objects = collection_take_objects (self);
+
+	if (objects == NULL && self->pv->service != NULL &&
+	    collection_count_missing_items (self) > 1) {
+		objects = _secret_service_get_managed_objects_sync (self->pv->service, cancellable,
+		                                                    &local_error);
+		if (local_error != NULL) {
+			g_propagate_error (error, local_error);
+			return FALSE;
+		}
+		if (objects != NULL) {
+			items = collection_objects_for_items (self, objects);
+			g_hash_table_unref (objects);
+			objects = items;
+		}
+	}
+
 	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Items");
 	g_return_val_if_fail (paths != NULL, FALSE);
 
@@ -914,9 +1320,13 @@ secret_collection_load_items_sync (SecretCollection *self,
 
 		/* No such collection yet create a new one */
 		if (item == NULL) {
-			item = secret_item_new_for_dbus_path_sync (self->pv->service, path,
-			                                           SECRET_ITEM_NONE,
-			                                           cancellable, error);
+			if (objects != NULL)
+				item = _secret_item_new_for_objects_sync (self->pv->service, path, objects,
+				                                          SECRET_ITEM_NONE, cancellable, error);
+			else
+				item = secret_item_new_for_dbus_path_sync (self->pv->service, path,
+				                                           SECRET_ITEM_NONE,
+				                                           cancellable, error);
 			if (item == NULL) {
 				ret = FALSE;
 				break;
@@ -929,6 +1339,8 @@ secret_collection_load_items_sync (SecretCollection *self,
 	if (ret)
 		collection_update_items (self, items);
 
+	if (objects != NULL)
+		g_hash_table_unref (objects);
 	g_hash_table_unref (items);
 	g_variant_unref (paths);
 	return ret;
@@ -1784,15 +2196,19 @@ secret_collection_get_flags (SecretCollection *self)
 GList *
 secret_collection_get_items (SecretCollection *self)
 {
-	GList *l, *items = NULL;
+	GSequenceIter *iter;
+	GList *items = NULL;
 
 	g_return_val_if_fail (SECRET_IS_COLLECTION (self), NULL);
 
 	g_mutex_lock (&self->pv->mutex);
-	if (self->pv->items)
-		items = g_hash_table_get_values (self->pv->items);
-	for (l = items; l != NULL; l = g_list_next (l))
-		g_object_ref (l->data);
+	if (self->pv->items_order) {
+		iter = g_sequence_get_end_iter (self->pv->items_order);
+		while (!g_sequence_iter_is_begin (iter)) {
+			iter = g_sequence_iter_prev (iter);
+			items = g_list_prepend (items, g_object_ref (g_sequence_get (iter)));
+		}
+	}
 	g_mutex_unlock (&self->pv->mutex);
 
 	return items;
@@ -1802,18 +2218,118 @@ SecretItem *
 _secret_collection_find_item_instance (SecretCollection *self,
                                        const gchar *item_path)
 {
+	GSequenceIter *iter = NULL;
 	SecretItem *item = NULL;
 
 	g_mutex_lock (&self->pv->mutex);
 	if (self->pv->items)
-		item = g_hash_table_lookup (self->pv->items, item_path);
-	if (item != NULL)
-		g_object_ref (item);
+		iter = g_hash_table_lookup (self->pv->items, item_path);
+	if (iter != NULL)
+		item = g_object_ref (g_sequence_get (iter));
 	g_mutex_unlock (&self->pv->mutex);
 
 	return item;
 }
 
+static SecretCollection *
+collection_new_for_objects (SecretService *service,
+                            const gchar *collection_path,
+                            GHashTable *objects,
+                            SecretCollectionFlags flags)
+{
+	SecretCollection *self;
+	GDBusProxy *proxy;
+
+	proxy = G_DBUS_PROXY (service);
+
+	self = g_object_new (secret_service_get_collection_gtype (service),
+	                     "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+	                     "g-interface-info", _secret_gen_collection_interface_info (),
+	                     "g-name", g_dbus_proxy_get_name (proxy),
+	                     "g-connection", g_dbus_proxy_get_connection (proxy),
+	                     "g-object-path", collection_path,
+	                     "g-interface-name", SECRET_COLLECTION_INTERFACE,
+	                     "service", service,
+	                     "flags", flags,
+	                     NULL);
+
+	/* Not in the reply, so have the proxy look it up itself */
+	if (!_secret_util_seed_properties (G_DBUS_PROXY (self), objects)) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	/* The items get created from the same reply, see load_items() */
+	if (flags & SECRET_COLLECTION_LOAD_ITEMS)
+		self->pv->objects = collection_objects_for_items (self, objects);
+
+	return self;
+}
+
+/*
+ * Like secret_collection_new_for_dbus_path() but takes the properties of
+ * the collection and its items from @objects, the table returned from
+ * _secret_service_get_managed_objects_finish(). Complete with
+ * secret_collection_new_for_dbus_path_finish().
+ */
+void
+_secret_collection_new_for_objects (SecretService *service,
+                                    const gchar *collection_path,
+                                    GHashTable *objects,
+                                    SecretCollectionFlags flags,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+	SecretCollection *self;
+
+	g_return_if_fail (SECRET_IS_SERVICE (service));
+	g_return_if_fail (collection_path != NULL);
+	g_return_if_fail (objects != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	self = collection_new_for_objects (service, collection_path, objects, flags);
+	if (self == NULL) {
+		secret_collection_new_for_dbus_path (service, collection_path, flags,
+		                                     cancellable, callback, user_data);
+		return;
+	}
+
+	g_async_initable_init_async (G_ASYNC_INITABLE (self), G_PRIORITY_DEFAULT,
+	                             cancellable, callback, user_data);
+	g_object_unref (self);
+}
+
+SecretCollection *
+_secret_collection_new_for_objects_sync (SecretService *service,
+                                         const gchar *collection_path,
+                                         GHashTable *objects,
+                                         SecretCollectionFlags flags,
+                                         GCancellable *cancellable,
+                                         GError **error)
+{
+	SecretCollection *self;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (collection_path != NULL, NULL);
+	g_return_val_if_fail (objects != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	self = collection_new_for_objects (service, collection_path, objects, flags);
+	if (self == NULL)
+		return secret_collection_new_for_dbus_path_sync (service, collection_path, flags,
+		                                                 cancellable, error);
+
+	if (!g_initable_init (G_INITABLE (self), cancellable, error)) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	return self;
+}
+
 /**
  * secret_collection_get_label:
  * @self: a collection
@@ -71,8 +71,22 @@
  * SecretItemFlags:
  * @SECRET_ITEM_NONE: no flags
  * @SECRET_ITEM_LOAD_SECRET: a secret has been (or should be) loaded for #SecretItem
+ * @SECRET_ITEM_LAZY_PROPERTIES: don't retrieve the properties of the #SecretItem
+ *     until they are first used
  *
  * Flags which determine which parts of the #SecretItem proxy are initialized.
+ *
+ * With %SECRET_ITEM_LAZY_PROPERTIES the first call to a property accessor
+ * such as secret_item_get_label() blocks while the properties are retrieved,
+ * together with those of other items of the same #SecretService which are
+ * still waiting for theirs. The retrieval runs a nested main loop in a
+ * private main context, so no other sources of the calling thread are
+ * dispatched in the meantime, but the call still waits on the secret service.
+ *
+ * If the properties cannot be retrieved, for example because the item no
+ * longer exists, this is not retried and the accessors return their defaults:
+ * %NULL for the label, attributes and schema name, %TRUE for the locked
+ * state, and zero for the created and modified times.
  */
 
 /**
@@ -103,6 +117,8 @@ struct _SecretItemPrivate {
 	GMutex mutex;
 	SecretValue *value;
 	gint disposed;
+	gint properties_pending;
+	gint properties_failed;
 };
 
 static GInitableIface *secret_item_initable_parent_iface = NULL;
@@ -177,6 +193,11 @@ item_take_service (SecretItem *self,
 	g_object_add_weak_pointer (G_OBJECT (self->pv->service),
 	                           (gpointer *)&self->pv->service);
 
+	/* Does nothing while still constructing, see secret_item_constructed() */
+	_secret_service_register_proxy (service, G_DBUS_PROXY (self));
+	if (g_atomic_int_get (&self->pv->properties_pending))
+		_secret_service_defer_properties (service, G_DBUS_PROXY (self));
+
 	/* Yes, we expect that the service will stay around */
 	g_object_unref (service);
 }
@@ -258,14 +279,35 @@ secret_item_dispose (GObject *obj)
 	G_OBJECT_CLASS (secret_item_parent_class)->dispose (obj);
 }
 
+static void
+secret_item_constructed (GObject *obj)
+{
+	SecretItem *self = SECRET_ITEM (obj);
+
+	G_OBJECT_CLASS (secret_item_parent_class)->constructed (obj);
+
+	if (self->pv->init_flags & SECRET_ITEM_LAZY_PROPERTIES &&
+	    g_dbus_proxy_get_flags (G_DBUS_PROXY (self)) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+		self->pv->properties_pending = 1;
+
+	/* Signals for our object path are routed to us by the service */
+	if (self->pv->service) {
+		_secret_service_register_proxy (self->pv->service, G_DBUS_PROXY (self));
+		if (self->pv->properties_pending)
+			_secret_service_defer_properties (self->pv->service, G_DBUS_PROXY (self));
+	}
+}
+
 static void
 secret_item_finalize (GObject *obj)
 {
 	SecretItem *self = SECRET_ITEM (obj);
 
-	if (self->pv->service)
+	if (self->pv->service) {
+		_secret_service_unregister_proxy (self->pv->service, G_DBUS_PROXY (self));
 		g_object_remove_weak_pointer (G_OBJECT (self->pv->service),
 		                              (gpointer *)&self->pv->service);
+	}
 
 	if (self->pv->value != NULL)
 		secret_value_unref (self->pv->value);
@@ -322,6 +364,7 @@ secret_item_class_init (SecretItemClass *klass)
 
 	gobject_class->get_property = secret_item_get_property;
 	gobject_class->set_property = secret_item_set_property;
+	gobject_class->constructed = secret_item_constructed;
 	gobject_class->dispose = secret_item_dispose;
 	gobject_class->finalize = secret_item_finalize;
 
@@ -407,6 +450,114 @@ secret_item_class_init (SecretItemClass *klass)
 	g_type_class_add_private (gobject_class, sizeof (SecretItemPrivate));
 }
 
+static gboolean
+item_properties_pending (SecretItem *self)
+{
+	return g_atomic_int_get (&self->pv->properties_pending) != 0;
+}
+
+typedef struct {
+	GMainLoop *loop;
+	gint loading;
+} PropertiesLoad;
+
+typedef struct {
+	PropertiesLoad *load;
+	SecretItem *item;
+} PropertiesCall;
+
+static void
+on_item_load_properties (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	PropertiesCall *call = user_data;
+	GError *error = NULL;
+	GVariantIter *iter;
+	GVariant *retval;
+	GVariant *value;
+	gchar *key;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+
+	/* No change notifications, nobody has seen these properties yet */
+	if (error == NULL) {
+		g_variant_get (retval, "(a{sv})", &iter);
+		while (g_variant_iter_loop (iter, "{sv}", &key, &value))
+			g_dbus_proxy_set_cached_property (G_DBUS_PROXY (call->item), key, value);
+		g_variant_iter_free (iter);
+		g_variant_unref (retval);
+
+	} else {
+		g_atomic_int_set (&call->item->pv->properties_failed, 1);
+		g_error_free (error);
+	}
+
+	/* Not retried, as the item most likely doesn't exist */
+	g_atomic_int_set (&call->item->pv->properties_pending, 0);
+
+	if (--call->load->loading == 0)
+		g_main_loop_quit (call->load->loop);
+
+	g_object_unref (call->item);
+	g_slice_free (PropertiesCall, call);
+}
+
+static gboolean
+item_ensure_properties (SecretItem *self)
+{
+	PropertiesLoad load = { NULL, 0 };
+	PropertiesCall *call;
+	GDBusProxy *proxy;
+	SecretSync *sync;
+	GList *items = NULL;
+	GList *l;
+
+	if (!item_properties_pending (self))
+		return g_atomic_int_get (&self->pv->properties_failed) == 0;
+
+	/* Other items still without properties come along in the same round trip */
+	if (self->pv->service)
+		items = _secret_service_take_deferred (self->pv->service,
+		                                       _secret_util_max_in_flight ());
+	if (!g_list_find (items, self))
+		items = g_list_prepend (items, g_object_ref (self));
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+	load.loop = sync->loop;
+
+	for (l = items; l != NULL; l = g_list_next (l)) {
+		if (!SECRET_IS_ITEM (l->data) || !item_properties_pending (l->data))
+			continue;
+
+		proxy = G_DBUS_PROXY (l->data);
+		call = g_slice_new0 (PropertiesCall);
+		call->load = &load;
+		call->item = g_object_ref (l->data);
+		load.loading++;
+
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy),
+		                        g_dbus_proxy_get_object_path (proxy),
+		                        SECRET_PROPERTIES_INTERFACE, "GetAll",
+		                        g_variant_new ("(s)", g_dbus_proxy_get_interface_name (proxy)),
+		                        G_VARIANT_TYPE ("(a{sv})"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1,
+		                        NULL, on_item_load_properties, call);
+	}
+
+	if (load.loading > 0)
+		g_main_loop_run (sync->loop);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	g_list_free_full (items, g_object_unref);
+
+	return g_atomic_int_get (&self->pv->properties_failed) == 0;
+}
+
 typedef struct {
 	GCancellable *cancellable;
 } InitClosure;
@@ -425,6 +576,17 @@ item_ensure_for_flags_sync (SecretItem *self,
                             GCancellable *cancellable,
                             GError **error)
 {
+	GList *items;
+	gboolean ret;
+
+	/* Without properties we don't know if it's locked, GetSecrets skips it if so */
+	if (flags & SECRET_ITEM_LOAD_SECRET && item_properties_pending (self)) {
+		items = g_list_prepend (NULL, self);
+		ret = secret_item_load_secrets_sync (items, cancellable, error);
+		g_list_free (items);
+		return ret;
+	}
+
 	if (flags & SECRET_ITEM_LOAD_SECRET && !secret_item_get_locked (self)) {
 		if (!secret_item_load_secret_sync (self, cancellable, error))
 			return FALSE;
@@ -450,19 +612,42 @@ on_init_load_secret (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+on_init_load_secrets (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	GError *error = NULL;
+
+	if (!secret_item_load_secrets_finish (result, &error))
+		g_simple_async_result_take_error (async, error);
+
+	g_simple_async_result_complete (async);
+	g_object_unref (async);
+}
+
 static void
 item_ensure_for_flags_async (SecretItem *self,
                              SecretItemFlags flags,
                              GSimpleAsyncResult *async)
 {
 	InitClosure *init = g_simple_async_result_get_op_res_gpointer (async);
+	GList *items;
 
-	if (flags & SECRET_ITEM_LOAD_SECRET && !secret_item_get_locked (self))
+	if (flags & SECRET_ITEM_LOAD_SECRET && item_properties_pending (self)) {
+		items = g_list_prepend (NULL, self);
+		secret_item_load_secrets (items, init->cancellable,
+		                          on_init_load_secrets, g_object_ref (async));
+		g_list_free (items);
+
+	} else if (flags & SECRET_ITEM_LOAD_SECRET && !secret_item_get_locked (self)) {
 		secret_item_load_secret (self, init->cancellable,
 		                         on_init_load_secret, g_object_ref (async));
 
-	else
+	} else {
 		g_simple_async_result_complete (async);
+	}
 }
 
 static gboolean
@@ -478,15 +663,19 @@ secret_item_initable_init (GInitable *initable,
 		return FALSE;
 
 	proxy = G_DBUS_PROXY (initable);
+	self = SECRET_ITEM (initable);
+
+	/* Not by GDBusProxy, which would watch for changes itself */
+	if (!item_properties_pending (self) && !_secret_util_have_cached_properties (proxy))
+		_secret_util_load_properties_sync (proxy, cancellable);
 
-	if (!_secret_util_have_cached_properties (proxy)) {
+	if (!item_properties_pending (self) && !_secret_util_have_cached_properties (proxy)) {
 		g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
 		             "No such secret item at path: %s",
 		             g_dbus_proxy_get_object_path (proxy));
 		return FALSE;
 	}
 
-	self = SECRET_ITEM (initable);
 	if (!self->pv->service) {
 		service = secret_service_get_sync (SECRET_SERVICE_NONE, cancellable, error);
 		if (service == NULL)
@@ -495,7 +684,12 @@ secret_item_initable_init (GInitable *initable,
 			item_take_service (self, service);
 	}
 
-	return item_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error);
+	if (!item_ensure_for_flags_sync (self, self->pv->init_flags, cancellable, error))
+		return FALSE;
+
+	/* Can now be handed out again, see _secret_service_find_item_instance() */
+	_secret_service_set_proxy_reusable (self->pv->service, proxy, TRUE);
+	return TRUE;
 }
 
 static void
@@ -530,6 +724,42 @@ on_init_service (GObject *source,
 	g_object_unref (async);
 }
 
+static void
+item_init_with_properties (SecretItem *self,
+                           GSimpleAsyncResult *res)
+{
+	InitClosure *init = g_simple_async_result_get_op_res_gpointer (res);
+	GDBusProxy *proxy = G_DBUS_PROXY (self);
+
+	if (!item_properties_pending (self) && !_secret_util_have_cached_properties (proxy)) {
+		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                 "No such secret item at path: %s",
+		                                 g_dbus_proxy_get_object_path (proxy));
+		g_simple_async_result_complete (res);
+
+	} else if (self->pv->service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
+		                    on_init_service, g_object_ref (res));
+
+	} else {
+		item_ensure_for_flags_async (self, self->pv->init_flags, res);
+	}
+}
+
+static void
+on_init_properties (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretItem *self = SECRET_ITEM (source);
+
+	_secret_util_load_properties_finish (G_DBUS_PROXY (self), result);
+	item_init_with_properties (self, res);
+
+	g_object_unref (res);
+}
+
 static void
 on_init_base (GObject *source,
               GAsyncResult *result,
@@ -546,18 +776,13 @@ on_init_base (GObject *source,
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 
-	} else if (!_secret_util_have_cached_properties (proxy)) {
-		g_simple_async_result_set_error (res, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
-		                                 "No such secret item at path: %s",
-		                                 g_dbus_proxy_get_object_path (proxy));
-		g_simple_async_result_complete (res);
-
-	} else if (self->pv->service == NULL) {
-		secret_service_get (SECRET_SERVICE_NONE, init->cancellable,
-		                    on_init_service, g_object_ref (res));
+	} else if (!item_properties_pending (self) && !_secret_util_have_cached_properties (proxy)) {
+		/* Not by GDBusProxy, which would watch for changes itself */
+		_secret_util_load_properties (proxy, init->cancellable,
+		                              on_init_properties, g_object_ref (res));
 
 	} else {
-		item_ensure_for_flags_async (self, self->pv->init_flags, res);
+		item_init_with_properties (self, res);
 	}
 
 	g_object_unref (res);
@@ -592,12 +817,15 @@ secret_item_async_initable_init_finish (GAsyncInitable *initable,
                                         GAsyncResult *result,
                                         GError **error)
 {
+	SecretItem *self = SECRET_ITEM (initable);
+
 	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (initable),
 	                      secret_item_async_initable_init_async), FALSE);
 
 	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
 		return FALSE;
 
+	_secret_service_set_proxy_reusable (self->pv->service, G_DBUS_PROXY (self), TRUE);
 	return TRUE;
 }
 
@@ -630,14 +858,65 @@ secret_item_refresh (SecretItem *self)
 	                             NULL, NULL, NULL);
 }
 
-void
-_secret_item_set_cached_secret (SecretItem *self,
-                                SecretValue *value)
+static SecretCache *
+item_get_secret_cache (SecretItem *self)
+{
+	SecretService *service;
+	SecretCache *cache = NULL;
+
+	service = self->pv->service;
+	if (service != NULL)
+		cache = _secret_service_get_cache (service);
+	if (cache != NULL && !_secret_cache_caches_secrets (cache)) {
+		_secret_cache_unref (cache);
+		cache = NULL;
+	}
+
+	return cache;
+}
+
+static guint64
+item_cache_generation (SecretItem *self)
+{
+	SecretCache *cache;
+	guint64 generation = 0;
+
+	/* Read before asking for a secret, see item_set_cached_secret() */
+	cache = item_get_secret_cache (self);
+	if (cache != NULL) {
+		generation = _secret_cache_get_generation (cache);
+		_secret_cache_unref (cache);
+	}
+
+	return generation;
+}
+
+static void
+item_set_cached_secret (SecretItem *self,
+                        SecretValue *value,
+                        guint64 generation)
 {
+	const gchar *path = g_dbus_proxy_get_object_path (G_DBUS_PROXY (self));
 	SecretValue *other = NULL;
 	gboolean updated = FALSE;
+	SecretCache *cache;
 
-	g_return_if_fail (SECRET_IS_ITEM (self));
+	/*
+	 * The service wide cache holds it instead, within its budget. But
+	 * not when invalidated since it was asked for, in which case only
+	 * this item holds on to it, as when not caching at all.
+	 */
+	cache = item_get_secret_cache (self);
+	if (cache != NULL) {
+		if (value == NULL || generation == _secret_cache_get_generation (cache)) {
+			_secret_cache_store_secret (cache, path, value, generation);
+			updated = TRUE;
+			value = NULL;
+		} else {
+			_secret_cache_store_secret (cache, path, NULL, 0);
+		}
+		_secret_cache_unref (cache);
+	}
 
 	if (value != NULL)
 		secret_value_ref (value);
@@ -661,6 +940,123 @@ _secret_item_set_cached_secret (SecretItem *self,
 		g_object_notify (G_OBJECT (self), "flags");
 }
 
+void
+_secret_item_set_cached_secret (SecretItem *self,
+                                SecretValue *value)
+{
+	g_return_if_fail (SECRET_IS_ITEM (self));
+
+	/* Sent to the service by us, so as current as it gets */
+	item_set_cached_secret (self, value, item_cache_generation (self));
+}
+
+static SecretItem *
+item_new_for_objects (SecretService *service,
+                      const gchar *item_path,
+                      GHashTable *objects,
+                      SecretItemFlags flags)
+{
+	SecretItem *self;
+	GDBusProxy *proxy;
+
+	proxy = G_DBUS_PROXY (service);
+
+	/* The properties are all there, nothing to defer */
+	self = g_object_new (secret_service_get_item_gtype (service),
+	                     "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+	                     "g-interface-info", _secret_gen_item_interface_info (),
+	                     "g-name", g_dbus_proxy_get_name (proxy),
+	                     "g-connection", g_dbus_proxy_get_connection (proxy),
+	                     "g-object-path", item_path,
+	                     "g-interface-name", SECRET_ITEM_INTERFACE,
+	                     "service", service,
+	                     "flags", flags & ~SECRET_ITEM_LAZY_PROPERTIES,
+	                     NULL);
+
+	/* Not in the reply, so have the proxy look it up itself */
+	if (!_secret_util_seed_properties (G_DBUS_PROXY (self), objects)) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	return self;
+}
+
+/*
+ * Like secret_item_new_for_dbus_path() but takes the properties of the
+ * item from @objects, the table returned from
+ * _secret_service_get_managed_objects_finish(). Complete with
+ * secret_item_new_for_dbus_path_finish().
+ */
+void
+_secret_item_new_for_objects (SecretService *service,
+                              const gchar *item_path,
+                              GHashTable *objects,
+                              SecretItemFlags flags,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+	SecretItem *self;
+
+	g_return_if_fail (SECRET_IS_SERVICE (service));
+	g_return_if_fail (item_path != NULL);
+	g_return_if_fail (objects != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* A live instance is reused, see secret_item_new_for_dbus_path() */
+	self = _secret_service_find_item_instance (service, item_path);
+	if (self == NULL)
+		self = item_new_for_objects (service, item_path, objects, flags);
+	else
+		g_clear_object (&self);
+
+	if (self == NULL) {
+		secret_item_new_for_dbus_path (service, item_path, flags,
+		                               cancellable, callback, user_data);
+		return;
+	}
+
+	g_async_initable_init_async (G_ASYNC_INITABLE (self), G_PRIORITY_DEFAULT,
+	                             cancellable, callback, user_data);
+	g_object_unref (self);
+}
+
+SecretItem *
+_secret_item_new_for_objects_sync (SecretService *service,
+                                   const gchar *item_path,
+                                   GHashTable *objects,
+                                   SecretItemFlags flags,
+                                   GCancellable *cancellable,
+                                   GError **error)
+{
+	SecretItem *self;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (item_path != NULL, NULL);
+	g_return_val_if_fail (objects != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	self = _secret_service_find_item_instance (service, item_path);
+	if (self == NULL)
+		self = item_new_for_objects (service, item_path, objects, flags);
+	else
+		g_clear_object (&self);
+
+	if (self == NULL)
+		return secret_item_new_for_dbus_path_sync (service, item_path, flags,
+		                                           cancellable, error);
+
+	if (!g_initable_init (G_INITABLE (self), cancellable, error)) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	return self;
+}
+
 typedef struct {
 	GCancellable *cancellable;
 	SecretItem *item;
@@ -933,8 +1329,10 @@ on_item_deleted (GObject *source,
 	SecretItem *self = SECRET_ITEM (g_async_result_get_source_object (user_data));
 	GError *error = NULL;
 
-	if (_secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error))
+	if (_secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error)) {
+		_secret_service_set_proxy_reusable (SECRET_SERVICE (source), G_DBUS_PROXY (self), FALSE);
 		g_simple_async_result_set_op_res_gboolean (res, TRUE);
+	}
 
 	if (error != NULL)
 		g_simple_async_result_take_error (res, error);
@@ -1028,26 +1426,19 @@ secret_item_delete_sync (SecretItem *self,
                          GCancellable *cancellable,
                          GError **error)
 {
-	SecretSync *sync;
-	gboolean ret;
+	const gchar *object_path;
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_item_delete (self, cancellable, _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	ret = secret_item_delete_finish (self, sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	object_path = g_dbus_proxy_get_object_path (G_DBUS_PROXY (self));
+	if (!_secret_service_delete_path_sync (self->pv->service, object_path, TRUE,
+	                                       cancellable, error))
+		return FALSE;
 
-	return ret;
+	_secret_service_set_proxy_reusable (self->pv->service, G_DBUS_PROXY (self), FALSE);
+	return TRUE;
 }
 
 /**
@@ -1066,6 +1457,7 @@ SecretItemFlags
 secret_item_get_flags (SecretItem *self)
 {
 	SecretServiceFlags flags = 0;
+	SecretCache *cache;
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), SECRET_ITEM_NONE);
 
@@ -1076,6 +1468,15 @@ secret_item_get_flags (SecretItem *self)
 
 	g_mutex_unlock (&self->pv->mutex);
 
+	if (!(flags & SECRET_ITEM_LOAD_SECRET)) {
+		cache = item_get_secret_cache (self);
+		if (cache != NULL) {
+			if (_secret_cache_contains_secret (cache, g_dbus_proxy_get_object_path (G_DBUS_PROXY (self))))
+				flags |= SECRET_ITEM_LOAD_SECRET;
+			_secret_cache_unref (cache);
+		}
+	}
+
 	return flags;
 
 }
@@ -1105,6 +1506,10 @@ secret_item_get_service (SecretItem *self)
  *
  * To load the secret call the secret_item_load_secret() method.
  *
+ * If a secret cache policy was set with secret_service_set_secret_cache_policy()
+ * the secret is held by the service's cache, and this returns %NULL once it
+ * has been evicted or has expired.
+ *
  * Returns: (transfer full) (allow-none): the secret value which should be
  *          released with secret_value_unref(), or %NULL
  */
@@ -1112,6 +1517,7 @@ SecretValue *
 secret_item_get_secret (SecretItem *self)
 {
 	SecretValue *value = NULL;
+	SecretCache *cache;
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
@@ -1122,12 +1528,22 @@ secret_item_get_secret (SecretItem *self)
 
 	g_mutex_unlock (&self->pv->mutex);
 
+	if (value == NULL) {
+		cache = item_get_secret_cache (self);
+		if (cache != NULL) {
+			value = _secret_cache_lookup_secret (cache, g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)),
+			                                     NULL);
+			_secret_cache_unref (cache);
+		}
+	}
+
 	return value;
 }
 
 
 typedef struct {
 	GCancellable *cancellable;
+	guint64 generation;
 } LoadClosure;
 
 static void
@@ -1145,6 +1561,7 @@ on_item_load_secret (GObject *source,
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
 	SecretItem *self = SECRET_ITEM (g_async_result_get_source_object (user_data));
+	LoadClosure *load = g_simple_async_result_get_op_res_gpointer (res);
 	SecretSession *session;
 	GError *error = NULL;
 	SecretValue *value;
@@ -1164,7 +1581,7 @@ on_item_load_secret (GObject *source,
 			g_set_error (&error, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
 			             _("Received invalid secret from the secret storage"));
 		} else {
-			_secret_item_set_cached_secret (self, value);
+			item_set_cached_secret (self, value, load->generation);
 			secret_value_unref (value);
 		}
 	}
@@ -1197,6 +1614,7 @@ on_load_ensure_session (GObject *source,
 	} else {
 		session_path = secret_service_get_session_dbus_path (self->pv->service);
 		g_assert (session_path != NULL && session_path[0] != '\0');
+		load->generation = item_cache_generation (self);
 		g_dbus_proxy_call (G_DBUS_PROXY (self), "GetSecret",
 		                   g_variant_new ("(o)", session_path),
 		                   G_DBUS_CALL_FLAGS_NONE, -1, load->cancellable,
@@ -1326,6 +1744,7 @@ typedef struct {
 	GCancellable *cancellable;
 	GVariant *in;
 	GHashTable *items;
+	guint64 generation;
 } LoadsClosure;
 
 static void
@@ -1365,7 +1784,7 @@ on_get_secrets_complete (GObject *source,
 		while (g_hash_table_iter_next (&iter, (gpointer *)&path, (gpointer *)&value)) {
 			item = g_hash_table_lookup (loads->items, path);
 			if (item != NULL)
-				_secret_item_set_cached_secret (item, value);
+				item_set_cached_secret (item, value, loads->generation);
 		}
 
 		g_hash_table_unref (with_paths);
@@ -1388,6 +1807,7 @@ on_loads_secrets_session (GObject *source,
 	LoadsClosure *loads = g_simple_async_result_get_op_res_gpointer (async);
 	GError *error = NULL;
 	const gchar *session;
+	SecretCache *cache;
 
 	secret_service_ensure_session_finish (SECRET_SERVICE (source), result, &error);
 	if (error != NULL) {
@@ -1396,6 +1816,11 @@ on_loads_secrets_session (GObject *source,
 
 	} else {
 		session = secret_service_get_session_dbus_path (SECRET_SERVICE (source));
+		cache = _secret_service_get_cache (SECRET_SERVICE (source));
+		if (cache != NULL) {
+			loads->generation = _secret_cache_get_generation (cache);
+			_secret_cache_unref (cache);
+		}
 		g_dbus_proxy_call (G_DBUS_PROXY (source), "GetSecrets",
 		                   g_variant_new ("(@aoo)", loads->in, session),
 		                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
@@ -1445,7 +1870,8 @@ secret_item_load_secrets (GList *items,
 
 	paths = g_ptr_array_new ();
 	for (l = items; l != NULL; l = g_list_next (l)) {
-		if (secret_item_get_locked (l->data))
+		/* Locked items are left out of the reply anyway */
+		if (!item_properties_pending (l->data) && secret_item_get_locked (l->data))
 			continue;
 
 		if (loads->service == NULL) {
@@ -1755,6 +2181,8 @@ secret_item_get_schema_name (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
+	if (!item_ensure_properties (self))
+		return NULL;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Attributes");
 	g_return_val_if_fail (variant != NULL, NULL);
 
@@ -1789,6 +2217,8 @@ secret_item_get_attributes (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
+	if (!item_ensure_properties (self))
+		return NULL;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Attributes");
 	g_return_val_if_fail (variant != NULL, NULL);
 
@@ -1920,6 +2350,8 @@ secret_item_get_label (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), NULL);
 
+	if (!item_ensure_properties (self))
+		return NULL;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Label");
 	g_return_val_if_fail (variant != NULL, NULL);
 
@@ -2026,6 +2458,8 @@ secret_item_get_locked (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), TRUE);
 
+	if (!item_ensure_properties (self))
+		return TRUE;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Locked");
 	g_return_val_if_fail (variant != NULL, TRUE);
 
@@ -2052,6 +2486,8 @@ secret_item_get_created (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), TRUE);
 
+	if (!item_ensure_properties (self))
+		return 0;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Created");
 	g_return_val_if_fail (variant != NULL, 0);
 
@@ -2078,6 +2514,8 @@ secret_item_get_modified (SecretItem *self)
 
 	g_return_val_if_fail (SECRET_IS_ITEM (self), TRUE);
 
+	if (!item_ensure_properties (self))
+		return 0;
 	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Modified");
 	g_return_val_if_fail (variant != NULL, 0);
 
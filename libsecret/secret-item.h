@@ -30,7 +30,8 @@ G_BEGIN_DECLS
 
 typedef enum {
 	SECRET_ITEM_NONE,
-	SECRET_ITEM_LOAD_SECRET = 1 << 1
+	SECRET_ITEM_LOAD_SECRET = 1 << 1,
+	SECRET_ITEM_LAZY_PROPERTIES = 1 << 2
 } SecretItemFlags;
 
 typedef enum {
@@ -26,6 +26,8 @@
 
 #include <glib/gi18n-lib.h>
 
+#include <string.h>
+
 /**
  * SecretSearchFlags:
  * @SECRET_SEARCH_NONE: no flags
@@ -36,6 +38,46 @@
  * Various flags to be used with secret_service_search() and secret_service_search_sync().
  */
 
+typedef struct {
+	SecretService *service;
+	const SecretSchema *schema;
+	GHashTable *attributes;
+	const gchar *collection;
+	const gchar *label;
+	SecretValue *value;
+	GCancellable *cancellable;
+} ServiceSync;
+
+static void
+service_store_sync_begin (gpointer data,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+	ServiceSync *args = data;
+	secret_service_store (args->service, args->schema, args->attributes, args->collection,
+	                      args->label, args->value, args->cancellable, callback, user_data);
+}
+
+static void
+service_lookup_sync_begin (gpointer data,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+	ServiceSync *args = data;
+	secret_service_lookup (args->service, args->schema, args->attributes,
+	                       args->cancellable, callback, user_data);
+}
+
+static void
+service_clear_sync_begin (gpointer data,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+	ServiceSync *args = data;
+	secret_service_clear (args->service, args->schema, args->attributes,
+	                      args->cancellable, callback, user_data);
+}
+
 typedef struct {
 	SecretService *service;
 	GCancellable *cancellable;
@@ -43,6 +85,7 @@ typedef struct {
 	gchar **unlocked;
 	gchar **locked;
 	guint loading;
+	GQueue pending;
 	SecretSearchFlags flags;
 	GVariant *attributes;
 } SearchClosure;
@@ -57,6 +100,7 @@ search_closure_free (gpointer data)
 	g_variant_unref (closure->attributes);
 	g_strfreev (closure->unlocked);
 	g_strfreev (closure->locked);
+	g_queue_clear (&closure->pending);
 	g_slice_free (SearchClosure, closure);
 }
 
@@ -152,6 +196,29 @@ secret_search_unlock_load_or_complete (GSimpleAsyncResult *async,
 	}
 }
 
+static void
+on_search_loaded (GObject *source,
+                  GAsyncResult *result,
+                  gpointer user_data);
+
+static void
+search_load_pending (GSimpleAsyncResult *res,
+                     SearchClosure *closure)
+{
+	guint max_in_flight = _secret_util_max_in_flight ();
+	const gchar *path;
+
+	while (closure->loading < max_in_flight) {
+		path = g_queue_pop_head (&closure->pending);
+		if (path == NULL)
+			break;
+		secret_item_new_for_dbus_path (closure->service, path, SECRET_ITEM_NONE,
+		                               closure->cancellable, on_search_loaded,
+		                               g_object_ref (res));
+		closure->loading++;
+	}
+}
+
 static void
 on_search_loaded (GObject *source,
                   GAsyncResult *result,
@@ -165,12 +232,18 @@ on_search_loaded (GObject *source,
 	closure->loading--;
 
 	item = secret_item_new_for_dbus_path_finish (result, &error);
-	if (error != NULL)
+	if (error != NULL) {
 		g_simple_async_result_take_error (res, error);
 
+		/* No point in loading the rest */
+		g_queue_clear (&closure->pending);
+	}
+
 	if (item != NULL)
 		search_closure_take_item (closure, item);
 
+	search_load_pending (res, closure);
+
 	/* We're done loading, lets go to the next step */
 	if (closure->loading == 0)
 		secret_search_unlock_load_or_complete (res, closure);
@@ -186,14 +259,12 @@ search_load_item_async (SecretService *self,
 {
 	SecretItem *item;
 
+	/* Items not yet around are loaded by search_load_pending() */
 	item = _secret_service_find_item_instance (self, path);
-	if (item == NULL) {
-		secret_item_new_for_dbus_path (self, path, SECRET_ITEM_NONE, closure->cancellable,
-		                               on_search_loaded, g_object_ref (res));
-		closure->loading++;
-	} else {
+	if (item == NULL)
+		g_queue_push_tail (&closure->pending, (gpointer)path);
+	else
 		search_closure_take_item (closure, item);
-	}
 }
 
 static void
@@ -221,6 +292,7 @@ on_search_paths (GObject *source,
 			search_load_item_async (self, res, closure, closure->unlocked[i]);
 		for (i = 0; count < want && closure->locked[i] != NULL; i++, count++)
 			search_load_item_async (self, res, closure, closure->locked[i]);
+		search_load_pending (res, closure);
 
 		/* No items loading, complete operation now */
 		if (closure->loading == 0)
@@ -372,6 +444,86 @@ secret_service_search_finish (SecretService *service,
 	return items;
 }
 
+typedef struct {
+	SecretService *service;
+	GCancellable *cancellable;
+	GMainLoop *loop;
+	GHashTable *objects;
+	GQueue pending;
+	guint loading;
+} LoadItemsSync;
+
+typedef struct {
+	LoadItemsSync *load;
+	const gchar *path;
+} LoadItemsCall;
+
+static void
+on_load_items_sync (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data);
+
+static void
+load_items_sync_pending (LoadItemsSync *load)
+{
+	guint max_in_flight = _secret_util_max_in_flight ();
+	GDBusProxy *proxy = G_DBUS_PROXY (load->service);
+	LoadItemsCall *call;
+	const gchar *path;
+
+	while (load->loading < max_in_flight) {
+		path = g_queue_pop_head (&load->pending);
+		if (path == NULL)
+			break;
+		call = g_slice_new (LoadItemsCall);
+		call->load = load;
+		call->path = path;
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy), path,
+		                        SECRET_PROPERTIES_INTERFACE, "GetAll",
+		                        g_variant_new ("(s)", SECRET_ITEM_INTERFACE),
+		                        G_VARIANT_TYPE ("(a{sv})"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1,
+		                        load->cancellable, on_load_items_sync, call);
+		load->loading++;
+	}
+}
+
+static void
+on_load_items_sync (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	LoadItemsCall *call = user_data;
+	LoadItemsSync *load = call->load;
+	GVariantBuilder builder;
+	GVariant *properties;
+	GVariant *retval;
+
+	load->loading--;
+
+	/* Errors are left for the item's own constructor to report */
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, NULL);
+	if (retval != NULL) {
+		properties = g_variant_get_child_value (retval, 0);
+
+		/* Laid out like GetManagedObjects, for _secret_item_new_for_objects_sync() */
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+		g_variant_builder_add (&builder, "{s@a{sv}}", SECRET_ITEM_INTERFACE, properties);
+		g_hash_table_insert (load->objects, g_strdup (call->path),
+		                     g_variant_ref_sink (g_variant_builder_end (&builder)));
+
+		g_variant_unref (properties);
+		g_variant_unref (retval);
+	}
+
+	g_slice_free (LoadItemsCall, call);
+	load_items_sync_pending (load);
+
+	if (load->loading == 0)
+		g_main_loop_quit (load->loop);
+}
+
 static gboolean
 service_load_items_sync (SecretService *service,
                          GCancellable *cancellable,
@@ -381,24 +533,57 @@ service_load_items_sync (SecretService *service,
                          gint *have,
                          GError **error)
 {
+	LoadItemsSync load = { service, cancellable, NULL, NULL, G_QUEUE_INIT, 0 };
+	SecretSync *sync;
 	SecretItem *item;
+	gboolean ret = TRUE;
+	gint count;
 	guint i;
 
-	for (i = 0; *have < want && paths[i] != NULL; i++) {
+	load.objects = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                      (GDestroyNotify)g_variant_unref);
+
+	for (i = 0, count = *have; count < want && paths[i] != NULL; i++, count++) {
 		item = _secret_service_find_item_instance (service, paths[i]);
 		if (item == NULL)
-			item = secret_item_new_for_dbus_path_sync (service, paths[i], SECRET_ITEM_NONE,
-			                                           cancellable, error);
-		if (item == NULL) {
-			return FALSE;
+			g_queue_push_tail (&load.pending, paths[i]);
+		else
+			g_object_unref (item);
+	}
 
-		} else {
-			*items = g_list_prepend (*items, item);
-			(*have)++;
+	/*
+	 * Rather than having each item proxy load its properties in turn, keep
+	 * a bounded number of GetAll calls in flight at once, and wait for them
+	 * all to be done. The proxies themselves are created afterwards, so that
+	 * they and their signals belong to the caller's main context rather than
+	 * this private one.
+	 */
+	if (!g_queue_is_empty (&load.pending)) {
+		sync = _secret_sync_new ();
+		g_main_context_push_thread_default (sync->context);
+
+		load.loop = sync->loop;
+		load_items_sync_pending (&load);
+		g_main_loop_run (sync->loop);
+
+		g_main_context_pop_thread_default (sync->context);
+		_secret_sync_free (sync);
+	}
+
+	for (i = 0; *have < want && paths[i] != NULL; i++) {
+		item = _secret_item_new_for_objects_sync (service, paths[i], load.objects,
+		                                          SECRET_ITEM_NONE, cancellable, error);
+		if (item == NULL) {
+			ret = FALSE;
+			break;
 		}
+
+		*items = g_list_prepend (*items, item);
+		(*have)++;
 	}
 
-	return TRUE;
+	g_hash_table_unref (load.objects);
+	return ret;
 }
 
 /**
@@ -549,19 +734,40 @@ _secret_service_decode_get_secrets_all (SecretService *self,
 	GVariantIter *iter;
 	GVariant *variant;
 	GHashTable *values;
-	SecretValue *value;
+	GPtrArray *encoded;
+	GPtrArray *paths;
+	SecretValue **decoded;
 	gchar *path;
+	guint i;
 
 	session = _secret_service_get_session (self);
 	values = g_hash_table_new_full (g_str_hash, g_str_equal,
 	                                g_free, secret_value_unref);
+
+	paths = g_ptr_array_new_with_free_func (g_free);
+	encoded = g_ptr_array_new_with_free_func ((GDestroyNotify)g_variant_unref);
 	g_variant_get (out, "(a{o(oayays)})", &iter);
-	while (g_variant_iter_loop (iter, "{o@(oayays)}", &path, &variant)) {
-		value = _secret_session_decode_secret (session, variant);
-		if (value && path)
-			g_hash_table_insert (values, g_strdup (path), value);
+	while (g_variant_iter_next (iter, "{o@(oayays)}", &path, &variant)) {
+		g_ptr_array_add (paths, path);
+		g_ptr_array_add (encoded, variant);
 	}
 	g_variant_iter_free (iter);
+
+	/* Large replies are decoded in parallel, results come back in order */
+	decoded = g_new0 (SecretValue *, encoded->len);
+	_secret_session_decode_secrets (session, (GVariant **)encoded->pdata, decoded,
+	                                encoded->len, g_variant_get_size (out));
+
+	for (i = 0; i < paths->len; i++) {
+		if (decoded[i] && paths->pdata[i])
+			g_hash_table_insert (values, g_strdup (paths->pdata[i]), decoded[i]);
+		else if (decoded[i])
+			secret_value_unref (decoded[i]);
+	}
+
+	g_free (decoded);
+	g_ptr_array_unref (encoded);
+	g_ptr_array_unref (paths);
 	return values;
 }
 
@@ -1257,6 +1463,7 @@ secret_service_store_sync (SecretService *service,
                            GCancellable *cancellable,
                            GError **error)
 {
+	ServiceSync args;
 	SecretSync *sync;
 	gboolean ret;
 
@@ -1271,179 +1478,787 @@ secret_service_store_sync (SecretService *service,
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_store (service, schema, attributes, collection,
-	                      label, value, cancellable, _secret_sync_on_result, sync);
+	args.service = service;
+	args.schema = schema;
+	args.attributes = attributes;
+	args.collection = collection;
+	args.label = label;
+	args.value = value;
+	args.cancellable = cancellable;
 
-	g_main_loop_run (sync->loop);
+	sync = _secret_sync_run (service_store_sync_begin, &args);
 
 	ret = secret_service_store_finish (service, sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
 	return ret;
 }
 
 typedef struct {
-	GVariant *attributes;
-	SecretValue *value;
 	GCancellable *cancellable;
-} LookupClosure;
+	SecretService *service;
+	gchar *collection_path;
+	GPtrArray *properties;
+	GPtrArray *values;
+	GPtrArray *errors;
+	guint next;
+	guint storing;
+} StoreManyClosure;
+
+typedef struct {
+	GSimpleAsyncResult *res;
+	guint index;
+} StoreManyCall;
 
 static void
-lookup_closure_free (gpointer data)
+store_many_error_free (gpointer data)
 {
-	LookupClosure *closure = data;
-	g_variant_unref (closure->attributes);
-	if (closure->value)
-		secret_value_unref (closure->value);
+	if (data != NULL)
+		g_error_free (data);
+}
+
+static void
+store_many_closure_free (gpointer data)
+{
+	StoreManyClosure *closure = data;
 	g_clear_object (&closure->cancellable);
-	g_slice_free (LookupClosure, closure);
+	g_clear_object (&closure->service);
+	g_free (closure->collection_path);
+	g_ptr_array_unref (closure->properties);
+	g_ptr_array_unref (closure->values);
+	g_ptr_array_unref (closure->errors);
+	g_slice_free (StoreManyClosure, closure);
 }
 
 static void
-on_lookup_get_secret (GObject *source,
+store_many_next (GSimpleAsyncResult *res);
+
+static void
+on_store_many_create (GObject *source,
                       GAsyncResult *result,
                       gpointer user_data)
+{
+	StoreManyCall *call = user_data;
+	GSimpleAsyncResult *res = call->res;
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	closure->storing--;
+
+	_secret_service_create_item_dbus_path_finish_raw (result, &error);
+	closure->errors->pdata[call->index] = error;
+
+	store_many_next (res);
+
+	if (closure->storing == 0)
+		g_simple_async_result_complete (res);
+
+	g_object_unref (res);
+	g_slice_free (StoreManyCall, call);
+}
+
+static void
+store_many_next (GSimpleAsyncResult *res)
+{
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	guint max_in_flight = _secret_util_max_in_flight ();
+	StoreManyCall *call;
+
+	/* Keep a window of CreateItem calls in flight, each one on its own */
+	while (closure->storing < max_in_flight && closure->next < closure->values->len) {
+		call = g_slice_new (StoreManyCall);
+		call->res = g_object_ref (res);
+		call->index = closure->next++;
+
+		secret_service_create_item_dbus_path (closure->service, closure->collection_path,
+		                                      closure->properties->pdata[call->index],
+		                                      closure->values->pdata[call->index],
+		                                      SECRET_ITEM_CREATE_REPLACE, closure->cancellable,
+		                                      on_store_many_create, call);
+		closure->storing++;
+	}
+}
+
+static void
+on_store_many_session (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
 
-	closure->value = secret_service_get_secret_for_dbus_path_finish (self, result, &error);
-	if (error != NULL)
+	secret_service_ensure_session_finish (closure->service, result, &error);
+	if (error != NULL) {
 		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	} else {
+		store_many_next (res);
+	}
 
-	g_simple_async_result_complete (res);
 	g_object_unref (res);
 }
 
 static void
-on_lookup_unlocked (GObject *source,
-                    GAsyncResult *result,
-                    gpointer user_data)
+on_store_many_unlock (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
-	gchar **unlocked = NULL;
 
-	secret_service_unlock_dbus_paths_finish (SECRET_SERVICE (source),
-	                                         result, &unlocked, &error);
-	if (error != NULL) {
+	secret_service_unlock_dbus_paths_finish (closure->service, result, NULL, &error);
+	if (error == NULL) {
+		secret_service_ensure_session (closure->service, closure->cancellable,
+		                               on_store_many_session, g_object_ref (res));
+	} else {
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
+	}
 
-	} else if (unlocked && unlocked[0]) {
-		secret_service_get_secret_for_dbus_path (self, unlocked[0],
-		                                         closure->cancellable,
-		                                         on_lookup_get_secret,
-		                                         g_object_ref (res));
+	g_object_unref (res);
+}
+
+static void
+store_many_unlock (GSimpleAsyncResult *res)
+{
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	const gchar *paths[2] = { closure->collection_path, NULL };
+
+	/* Unlock once up front, rather than having each CreateItem fail */
+	secret_service_unlock_dbus_paths (closure->service, paths, closure->cancellable,
+	                                  on_store_many_unlock, g_object_ref (res));
+}
+
+static void
+on_store_many_keyring (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	gchar *path;
 
+	path = secret_service_create_collection_dbus_path_finish (closure->service, result, &error);
+	if (error == NULL) {
+		g_free (closure->collection_path);
+		closure->collection_path = path;
+		store_many_unlock (res);
 	} else {
+		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 	}
 
-	g_strfreev (unlocked);
 	g_object_unref (res);
 }
 
 static void
-on_lookup_searched (GObject *source,
-                    GAsyncResult *result,
-                    gpointer user_data)
+on_store_many_alias (GObject *source,
+                     GAsyncResult *result,
+                     gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	SecretService *self = SECRET_SERVICE (source);
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GHashTable *properties;
 	GError *error = NULL;
-	gchar **unlocked = NULL;
-	gchar **locked = NULL;
+	gchar *path;
 
-	secret_service_search_for_dbus_paths_finish (self, result, &unlocked, &locked, &error);
+	path = secret_service_read_alias_dbus_path_finish (closure->service, result, &error);
 	if (error != NULL) {
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
 
-	} else if (unlocked && unlocked[0]) {
-		secret_service_get_secret_for_dbus_path (self, unlocked[0],
-		                                         closure->cancellable,
-		                                         on_lookup_get_secret,
-		                                         g_object_ref (res));
+	} else if (path != NULL) {
+		g_free (closure->collection_path);
+		closure->collection_path = path;
+		store_many_unlock (res);
 
-	} else if (locked && locked[0]) {
-		const gchar *paths[] = { locked[0], NULL };
-		secret_service_unlock_dbus_paths (self, paths,
-		                                  closure->cancellable,
-		                                  on_lookup_unlocked,
-		                                  g_object_ref (res));
+	/* If the collection is the default alias, we should try and create it */
+	} else if (g_str_equal (closure->collection_path, SECRET_ALIAS_PREFIX "default")) {
+		properties = _secret_collection_properties_new (_("Default keyring"));
+		secret_service_create_collection_dbus_path (closure->service, properties, "default",
+		                                            SECRET_COLLECTION_CREATE_NONE, closure->cancellable,
+		                                            on_store_many_keyring, g_object_ref (res));
+		g_hash_table_unref (properties);
 
 	} else {
+		g_simple_async_result_set_error (res, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT,
+		                                 "No such secret collection at path: %s",
+		                                 closure->collection_path);
 		g_simple_async_result_complete (res);
 	}
 
-	g_strfreev (unlocked);
-	g_strfreev (locked);
 	g_object_unref (res);
 }
 
 static void
-on_lookup_service (GObject *source,
-                   GAsyncResult *result,
-                   gpointer user_data)
+store_many_begin (GSimpleAsyncResult *res)
 {
-	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
-	LookupClosure *lookup = g_simple_async_result_get_op_res_gpointer (async);
-	SecretService *service;
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	/* Resolve the collection once, rather than for every item */
+	if (g_str_has_prefix (closure->collection_path, SECRET_ALIAS_PREFIX)) {
+		secret_service_read_alias_dbus_path (closure->service,
+		                                     closure->collection_path + strlen (SECRET_ALIAS_PREFIX),
+		                                     closure->cancellable, on_store_many_alias,
+		                                     g_object_ref (res));
+	} else {
+		store_many_unlock (res);
+	}
+}
+
+static void
+on_store_many_service (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	StoreManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
 
-	service = secret_service_get_finish (result, &error);
+	closure->service = secret_service_get_finish (result, &error);
 	if (error == NULL) {
-		_secret_service_search_for_paths_variant (service, lookup->attributes,
-		                                          lookup->cancellable,
-		                                          on_lookup_searched, g_object_ref (async));
-		g_object_unref (service);
-
+		store_many_begin (res);
 	} else {
-		g_simple_async_result_take_error (async, error);
-		g_simple_async_result_complete (async);
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
 	}
 
-	g_object_unref (async);
+	g_object_unref (res);
 }
 
 /**
- * secret_service_lookup:
+ * secret_service_store_many:
  * @service: (allow-none): the secret service
- * @schema: (allow-none): the schema for the attributes
- * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @schema: (allow-none): the schema to use to check attributes
+ * @attributes: (array length=n_items): the attribute keys and values for each item
+ * @labels: (array length=n_items): the label for each item
+ * @values: (array length=n_items): the secret value for each item
+ * @n_items: the number of items to store
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the collection where to store the secrets
  * @cancellable: optional cancellation object
  * @callback: called when the operation completes
  * @user_data: data to be passed to the callback
  *
- * Lookup a secret value in the secret service.
+ * Store many secret values in the secret service.
  *
- * The @attributes should be a set of key and value string pairs.
+ * This is like calling secret_service_store() for each item, but the
+ * collection is only looked up and unlocked once, and several items
+ * are stored at the same time.
+ *
+ * Each of the @attributes should be a set of key and value string pairs.
+ * If they match a secret item already stored in the collection, then the
+ * item will be updated with the new values.
  *
  * If @service is NULL, then secret_service_get() will be called to get
  * the default #SecretService proxy.
  *
+ * If @collection is not specified, then the default collection will be
+ * used. Use #SECRET_COLLECTION_SESSION to store the passwords in the session
+ * collection, which doesn't get stored across login sessions.
+ *
  * This method will return immediately and complete asynchronously.
  */
 void
-secret_service_lookup (SecretService *service,
-                       const SecretSchema *schema,
-                       GHashTable *attributes,
-                       GCancellable *cancellable,
-                       GAsyncReadyCallback callback,
-                       gpointer user_data)
+secret_service_store_many (SecretService *service,
+                           const SecretSchema *schema,
+                           GHashTable **attributes,
+                           const gchar **labels,
+                           SecretValue **values,
+                           guint n_items,
+                           const gchar *collection,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
 {
-	const gchar *schema_name = NULL;
+	GSimpleAsyncResult *res;
+	StoreManyClosure *closure;
+	const gchar *schema_name;
+	GHashTable *properties;
+	GVariant *propval;
+	guint i;
+
+	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
+	g_return_if_fail (n_items == 0 || (attributes != NULL && labels != NULL && values != NULL));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	for (i = 0; i < n_items; i++) {
+		g_return_if_fail (attributes[i] != NULL);
+		g_return_if_fail (labels[i] != NULL);
+		g_return_if_fail (values[i] != NULL);
+
+		/* Warnings raised already */
+		if (schema != NULL && !_secret_attributes_validate (schema, attributes[i], G_STRFUNC, FALSE))
+			return;
+	}
+
+	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
+	                                 secret_service_store_many);
+	closure = g_slice_new0 (StoreManyClosure);
+	closure->collection_path = _secret_util_collection_to_path (collection);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->properties = g_ptr_array_new_with_free_func ((GDestroyNotify)g_hash_table_unref);
+	closure->values = g_ptr_array_new_with_free_func (secret_value_unref);
+	closure->errors = g_ptr_array_new_with_free_func (store_many_error_free);
+
+	/* Always store the schema name in the attributes */
+	schema_name = (schema == NULL) ? NULL : schema->name;
+
+	for (i = 0; i < n_items; i++) {
+		properties = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+		                                    (GDestroyNotify)g_variant_unref);
+
+		propval = g_variant_new_string (labels[i]);
+		g_hash_table_insert (properties,
+		                     SECRET_ITEM_INTERFACE ".Label",
+		                     g_variant_ref_sink (propval));
+
+		propval = _secret_attributes_to_variant (attributes[i], schema_name);
+		g_hash_table_insert (properties,
+		                     SECRET_ITEM_INTERFACE ".Attributes",
+		                     g_variant_ref_sink (propval));
+
+		g_ptr_array_add (closure->properties, properties);
+		g_ptr_array_add (closure->values, secret_value_ref (values[i]));
+		g_ptr_array_add (closure->errors, NULL);
+	}
+
+	g_simple_async_result_set_op_res_gpointer (res, closure, store_many_closure_free);
+
+	if (n_items == 0) {
+		g_simple_async_result_complete_in_idle (res);
+
+	} else if (service == NULL) {
+		secret_service_get (SECRET_SERVICE_OPEN_SESSION, cancellable,
+		                    on_store_many_service, g_object_ref (res));
+	} else {
+		closure->service = g_object_ref (service);
+		store_many_begin (res);
+	}
+
+	g_object_unref (res);
+}
+
+/**
+ * secret_service_store_many_finish:
+ * @service: (allow-none): the secret service
+ * @result: the asynchronous result passed to the callback
+ * @errors: (out) (allow-none) (transfer full) (element-type GLib.Error):
+ *          location to place an array with the failure of each item, or
+ *          %NULL for each item that was stored
+ * @error: location to place an error on failure
+ *
+ * Finish asynchronous operation to store many secret values in the secret
+ * service.
+ *
+ * If some of the items could not be stored, then %FALSE is returned and
+ * @error is set to the first failure. The outcome for every item, in the
+ * same order as they were passed in, is placed in @errors.
+ *
+ * If the collection could not be found or unlocked, then @errors is set to
+ * %NULL.
+ *
+ * Returns: whether all the items were stored or not
+ */
+gboolean
+secret_service_store_many_finish (SecretService *service,
+                                  GAsyncResult *result,
+                                  GPtrArray **errors,
+                                  GError **error)
+{
+	GSimpleAsyncResult *res;
+	StoreManyClosure *closure;
+	gboolean ret = TRUE;
+	guint i;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                                                      secret_service_store_many), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (errors)
+		*errors = NULL;
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return FALSE;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	for (i = 0; ret && i < closure->errors->len; i++) {
+		if (closure->errors->pdata[i] != NULL) {
+			g_propagate_error (error, g_error_copy (closure->errors->pdata[i]));
+			ret = FALSE;
+		}
+	}
+
+	if (errors)
+		*errors = g_ptr_array_ref (closure->errors);
+
+	return ret;
+}
+
+/**
+ * secret_service_store_many_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema to use to check attributes
+ * @attributes: (array length=n_items): the attribute keys and values for each item
+ * @labels: (array length=n_items): the label for each item
+ * @values: (array length=n_items): the secret value for each item
+ * @n_items: the number of items to store
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the collection where to store the secrets
+ * @cancellable: optional cancellation object
+ * @errors: (out) (allow-none) (transfer full) (element-type GLib.Error):
+ *          location to place an array with the failure of each item, or
+ *          %NULL for each item that was stored
+ * @error: location to place an error on failure
+ *
+ * Store many secret values in the secret service.
+ *
+ * This is like calling secret_service_store_sync() for each item, but the
+ * collection is only looked up and unlocked once, and several items
+ * are stored at the same time.
+ *
+ * If some of the items could not be stored, then %FALSE is returned and
+ * @error is set to the first failure. The outcome for every item, in the
+ * same order as they were passed in, is placed in @errors.
+ *
+ * If @service is NULL, then secret_service_get_sync() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: whether all the items were stored or not
+ */
+gboolean
+secret_service_store_many_sync (SecretService *service,
+                                const SecretSchema *schema,
+                                GHashTable **attributes,
+                                const gchar **labels,
+                                SecretValue **values,
+                                guint n_items,
+                                const gchar *collection,
+                                GCancellable *cancellable,
+                                GPtrArray **errors,
+                                GError **error)
+{
+	SecretSync *sync;
+	gboolean ret;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (n_items == 0 || (attributes != NULL && labels != NULL && values != NULL), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_service_store_many (service, schema, attributes, labels, values, n_items,
+	                           collection, cancellable, _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	ret = secret_service_store_many_finish (service, sync->result, errors, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return ret;
+}
+
+typedef struct {
+	SecretService *service;
+	GVariant *attributes;
+	SecretValue *value;
+	GCancellable *cancellable;
+	guint64 generation;
+} LookupClosure;
+
+static void
+lookup_closure_free (gpointer data)
+{
+	LookupClosure *closure = data;
+	g_clear_object (&closure->service);
+	g_variant_unref (closure->attributes);
+	if (closure->value)
+		secret_value_unref (closure->value);
+	g_clear_object (&closure->cancellable);
+	g_slice_free (LookupClosure, closure);
+}
+
+static void
+on_lookup_get_secret (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+
+	closure->value = secret_service_get_secret_for_dbus_path_finish (self, result, &error);
+	if (error != NULL)
+		g_simple_async_result_take_error (res, error);
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_unlocked (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+
+	secret_service_unlock_dbus_paths_finish (SECRET_SERVICE (source),
+	                                         result, &unlocked, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (unlocked && unlocked[0]) {
+		secret_service_get_secret_for_dbus_path (self, unlocked[0],
+		                                         closure->cancellable,
+		                                         on_lookup_get_secret,
+		                                         g_object_ref (res));
+
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (unlocked);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_searched (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+	gchar **locked = NULL;
+
+	secret_service_search_for_dbus_paths_finish (self, result, &unlocked, &locked, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (unlocked && unlocked[0]) {
+		secret_service_get_secret_for_dbus_path (self, unlocked[0],
+		                                         closure->cancellable,
+		                                         on_lookup_get_secret,
+		                                         g_object_ref (res));
+
+	} else if (locked && locked[0]) {
+		const gchar *paths[] = { locked[0], NULL };
+		secret_service_unlock_dbus_paths (self, paths,
+		                                  closure->cancellable,
+		                                  on_lookup_unlocked,
+		                                  g_object_ref (res));
+
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (unlocked);
+	g_strfreev (locked);
+	g_object_unref (res);
+}
+
+static void
+on_lookup_secret (GObject *source,
+                  GAsyncResult *result,
+                  gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = closure->service;
+	GError *error = NULL;
+	SecretCache *cache;
+	GVariantIter *iter;
+	GVariant *retval;
+	GVariant *variant;
+	gchar **locked;
+	const gchar *path;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+
+	/* Advertised but not actually there, or not as expected, so do it the long way */
+	if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD) ||
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+		g_clear_error (&error);
+		_secret_service_search_for_paths_variant (self, closure->attributes,
+		                                          closure->cancellable,
+		                                          on_lookup_searched, g_object_ref (res));
+
+	} else if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else {
+		g_variant_get (retval, "(a{o(oayays)}^ao)", &iter, &locked);
+		if (g_variant_iter_next (iter, "{&o@(oayays)}", &path, &variant)) {
+			closure->value = _secret_session_decode_secret (_secret_service_get_session (self),
+			                                                variant);
+			cache = _secret_service_get_cache (self);
+			if (cache && closure->value) {
+				_secret_cache_store_secret (cache, path, closure->value,
+				                            closure->generation);
+			}
+			if (cache)
+				_secret_cache_unref (cache);
+			g_variant_unref (variant);
+		}
+		g_variant_iter_free (iter);
+
+		/* Only locked items matched, so unlock the first as usual */
+		if (closure->value == NULL && locked[0] != NULL) {
+			const gchar *paths[] = { locked[0], NULL };
+			secret_service_unlock_dbus_paths (self, paths,
+			                                  closure->cancellable,
+			                                  on_lookup_unlocked,
+			                                  g_object_ref (res));
+		} else {
+			g_simple_async_result_complete (res);
+		}
+
+		g_strfreev (locked);
+		g_variant_unref (retval);
+	}
+
+	g_object_unref (res);
+}
+
+static void
+on_lookup_session (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	GError *error = NULL;
+	const gchar *session;
+	SecretCache *cache;
+
+	secret_service_ensure_session_finish (self, result, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else {
+		/* Anything invalidated from here on isn't cached, see on_lookup_secret() */
+		cache = _secret_service_get_cache (self);
+		if (cache) {
+			closure->generation = _secret_cache_get_generation (cache);
+			_secret_cache_unref (cache);
+		}
+
+		/* Not in the introspection data, so the reply type is checked here */
+		session = secret_service_get_session_dbus_path (self);
+		g_clear_object (&closure->service);
+		closure->service = g_object_ref (self);
+		g_dbus_connection_call (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+		                        g_dbus_proxy_get_name (G_DBUS_PROXY (self)),
+		                        g_dbus_proxy_get_object_path (G_DBUS_PROXY (self)),
+		                        SECRET_SERVICE_INTERFACE, "LookupSecret",
+		                        g_variant_new ("(@a{ss}o)", closure->attributes, session),
+		                        G_VARIANT_TYPE ("(a{o(oayays)}ao)"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1, closure->cancellable,
+		                        on_lookup_secret, g_object_ref (res));
+	}
+
+	g_object_unref (res);
+}
+
+static void
+lookup_begin (SecretService *service,
+              GSimpleAsyncResult *res)
+{
+	LookupClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretCache *cache;
+
+	/*
+	 * When the service supports it, search and retrieve the first secret in
+	 * a single call, rather than a SearchItems followed by a GetSecrets.
+	 * But when searches are cached, go through the cache instead.
+	 */
+	cache = _secret_service_get_cache (service);
+	if ((cache == NULL || !_secret_cache_caches_searches (cache)) &&
+	    _secret_service_has_capability (service, SECRET_CAPABILITY_LOOKUP_SECRET)) {
+		secret_service_ensure_session (service, closure->cancellable,
+		                               on_lookup_session, g_object_ref (res));
+	} else {
+		_secret_service_search_for_paths_variant (service, closure->attributes,
+		                                          closure->cancellable,
+		                                          on_lookup_searched, g_object_ref (res));
+	}
+
+	if (cache)
+		_secret_cache_unref (cache);
+}
+
+static void
+on_lookup_service (GObject *source,
+                   GAsyncResult *result,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *async = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *service;
+	GError *error = NULL;
+
+	service = secret_service_get_finish (result, &error);
+	if (error == NULL) {
+		lookup_begin (service, async);
+		g_object_unref (service);
+
+	} else {
+		g_simple_async_result_take_error (async, error);
+		g_simple_async_result_complete (async);
+	}
+
+	g_object_unref (async);
+}
+
+/**
+ * secret_service_lookup:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Lookup a secret value in the secret service.
+ *
+ * The @attributes should be a set of key and value string pairs.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_service_lookup (SecretService *service,
+                       const SecretSchema *schema,
+                       GHashTable *attributes,
+                       GCancellable *cancellable,
+                       GAsyncReadyCallback callback,
+                       gpointer user_data)
+{
+	const gchar *schema_name = NULL;
 	GSimpleAsyncResult *res;
 	LookupClosure *closure;
 
@@ -1470,9 +2285,7 @@ secret_service_lookup (SecretService *service,
 		secret_service_get (SECRET_SERVICE_OPEN_SESSION, cancellable,
 		                    on_lookup_service, g_object_ref (res));
 	} else {
-		_secret_service_search_for_paths_variant (service, closure->attributes,
-		                                          closure->cancellable,
-		                                          on_lookup_searched, g_object_ref (res));
+		lookup_begin (service, res);
 	}
 
 	g_object_unref (res);
@@ -1543,6 +2356,7 @@ secret_service_lookup_sync (SecretService *service,
                             GCancellable *cancellable,
                             GError **error)
 {
+	ServiceSync args;
 	SecretSync *sync;
 	SecretValue *value;
 
@@ -1554,30 +2368,48 @@ secret_service_lookup_sync (SecretService *service,
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return NULL;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_lookup (service, schema, attributes, cancellable,
-	                       _secret_sync_on_result, sync);
+	args.service = service;
+	args.schema = schema;
+	args.attributes = attributes;
+	args.cancellable = cancellable;
 
-	g_main_loop_run (sync->loop);
+	sync = _secret_sync_run (service_lookup_sync_begin, &args);
 
 	value = secret_service_lookup_finish (service, sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
 	return value;
 }
 
+/* The number of items to delete in one call, when the service supports it */
+#define DELETE_BATCH_SIZE 128
+
 typedef struct {
 	GCancellable *cancellable;
 	SecretService *service;
 	GVariant *attributes;
+	guint max_in_flight;
+	SecretClearProgressFunc progress;
+	gpointer progress_data;
+	GDestroyNotify progress_destroy;
+	gchar **paths;
+	guint total;
+	guint next;
+	guint batch;
+	GQueue retry;
+	gboolean failed;
+	gboolean cancelled;
 	gint deleted;
 	gint deleting;
 } DeleteClosure;
 
+typedef struct {
+	GSimpleAsyncResult *res;
+	guint start;
+	guint count;
+} DeleteCall;
+
 static void
 delete_closure_free (gpointer data)
 {
@@ -1586,31 +2418,135 @@ delete_closure_free (gpointer data)
 		g_object_unref (closure->service);
 	g_variant_unref (closure->attributes);
 	g_clear_object (&closure->cancellable);
+	if (closure->progress_destroy)
+		(closure->progress_destroy) (closure->progress_data);
+	g_queue_clear (&closure->retry);
+	g_strfreev (closure->paths);
 	g_slice_free (DeleteClosure, closure);
 }
 
 static void
-on_delete_password_complete (GObject *source,
-                             GAsyncResult *result,
-                             gpointer user_data)
+delete_next (GSimpleAsyncResult *res);
+
+static void
+delete_call_done (DeleteCall *call,
+                  GError *error)
 {
-	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	GSimpleAsyncResult *res = call->res;
 	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
-	GError *error = NULL;
-	gboolean deleted;
 
 	closure->deleting--;
 
-	deleted = _secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error);
-	if (error != NULL)
-		g_simple_async_result_take_error (res, error);
-	if (deleted)
-		closure->deleted++;
+	if (error != NULL) {
+		/* Stop scheduling more deletes, but let the others finish */
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			closure->cancelled = TRUE;
+		if (!closure->failed)
+			g_simple_async_result_take_error (res, error);
+		else
+			g_error_free (error);
+		closure->failed = TRUE;
+	}
+
+	if (closure->progress)
+		(closure->progress) (closure->deleted, closure->total, closure->progress_data);
+
+	delete_next (res);
 
 	if (closure->deleting <= 0)
 		g_simple_async_result_complete (res);
 
 	g_object_unref (res);
+	g_slice_free (DeleteCall, call);
+}
+
+static void
+on_delete_password_complete (GObject *source,
+                             GAsyncResult *result,
+                             gpointer user_data)
+{
+	DeleteCall *call = user_data;
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (call->res);
+	GError *error = NULL;
+
+	if (_secret_service_delete_path_finish (SECRET_SERVICE (source), result, &error))
+		closure->deleted++;
+
+	delete_call_done (call, error);
+}
+
+static void
+on_delete_batch_complete (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	DeleteCall *call = user_data;
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (call->res);
+	GError *error = NULL;
+	gint deleted;
+	guint i;
+
+	deleted = _secret_service_delete_paths_finish (SECRET_SERVICE (source), result, &error);
+
+	/* Advertised but not actually there, so delete these one by one */
+	if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		g_clear_error (&error);
+		closure->batch = 1;
+		for (i = 0; i < call->count; i++)
+			g_queue_push_tail (&closure->retry, closure->paths[call->start + i]);
+
+	} else if (deleted > 0) {
+		closure->deleted += deleted;
+	}
+
+	delete_call_done (call, error);
+}
+
+static void
+delete_next (GSimpleAsyncResult *res)
+{
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	const gchar *path;
+	DeleteCall *call;
+	gchar *saved;
+
+	while (!closure->cancelled && closure->deleting < closure->max_in_flight) {
+		call = g_slice_new0 (DeleteCall);
+		call->res = g_object_ref (res);
+
+		if (!g_queue_is_empty (&closure->retry)) {
+			path = g_queue_pop_head (&closure->retry);
+			call->count = 1;
+
+		} else if (closure->next < closure->total) {
+			call->start = closure->next;
+			call->count = MIN (closure->batch, closure->total - closure->next);
+			closure->next += call->count;
+			path = closure->paths[call->start];
+
+		} else {
+			g_object_unref (call->res);
+			g_slice_free (DeleteCall, call);
+			break;
+		}
+
+		if (call->count > 1) {
+			/* Temporarily terminate the array after this batch */
+			saved = closure->paths[call->start + call->count];
+			closure->paths[call->start + call->count] = NULL;
+			_secret_service_delete_paths (closure->service,
+			                              (const gchar **)closure->paths + call->start,
+			                              closure->cancellable,
+			                              on_delete_batch_complete, call);
+			closure->paths[call->start + call->count] = saved;
+		} else {
+			_secret_service_delete_path (closure->service, path, TRUE,
+			                             closure->cancellable,
+			                             on_delete_password_complete, call);
+		}
+
+		closure->deleting++;
+	}
 }
 
 static void
@@ -1621,18 +2557,17 @@ on_delete_searched (GObject *source,
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
 	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	GError *error = NULL;
-	gchar **unlocked = NULL;
-	gint i;
 
-	secret_service_search_for_dbus_paths_finish (SECRET_SERVICE (source), result, &unlocked, NULL, &error);
+	secret_service_search_for_dbus_paths_finish (SECRET_SERVICE (source), result,
+	                                             &closure->paths, NULL, &error);
 	if (error == NULL) {
-		for (i = 0; unlocked[i] != NULL; i++) {
-			_secret_service_delete_path (closure->service, unlocked[i], TRUE,
-			                             closure->cancellable,
-			                             on_delete_password_complete,
-			                             g_object_ref (res));
-			closure->deleting++;
-		}
+		closure->total = g_strv_length (closure->paths);
+		closure->batch = 1;
+		if (_secret_service_has_capability (closure->service, SECRET_CAPABILITY_DELETE_ITEMS))
+			closure->batch = DELETE_BATCH_SIZE;
+
+		/* Only keep a limited number of deletes in flight at once */
+		delete_next (res);
 
 		if (closure->deleting == 0)
 			g_simple_async_result_complete (res);
@@ -1641,7 +2576,6 @@ on_delete_searched (GObject *source,
 		g_simple_async_result_complete (res);
 	}
 
-	g_strfreev (unlocked);
 	g_object_unref (res);
 }
 
@@ -1668,6 +2602,63 @@ on_delete_service (GObject *source,
 	g_object_unref (async);
 }
 
+/**
+ * SecretClearProgressFunc:
+ * @cleared: the number of items removed so far
+ * @total: the number of matching items to remove
+ * @user_data: data passed to secret_service_clear_full()
+ *
+ * Called as items are removed by secret_service_clear_full().
+ */
+
+static void
+clear_begin (SecretService *service,
+             const SecretSchema *schema,
+             GHashTable *attributes,
+             guint max_in_flight,
+             SecretClearProgressFunc progress,
+             gpointer progress_data,
+             GDestroyNotify progress_destroy,
+             GCancellable *cancellable,
+             GAsyncReadyCallback callback,
+             gpointer user_data)
+{
+	const gchar *schema_name = NULL;
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
+
+	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
+		schema_name = schema->name;
+
+	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
+	                                 secret_service_clear);
+	closure = g_slice_new0 (DeleteClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->attributes = _secret_attributes_to_variant (attributes, schema_name);
+	g_variant_ref_sink (closure->attributes);
+	closure->max_in_flight = max_in_flight ? max_in_flight : _secret_util_max_in_flight ();
+	closure->progress = progress;
+	closure->progress_data = progress_data;
+	closure->progress_destroy = progress_destroy;
+	g_queue_init (&closure->retry);
+	g_simple_async_result_set_op_res_gpointer (res, closure, delete_closure_free);
+
+	/* A double check to make sure we don't delete everything, should have been checked earlier */
+	g_assert (g_variant_n_children (closure->attributes) > 0);
+
+	if (service == NULL) {
+		secret_service_get (SECRET_SERVICE_NONE, cancellable,
+		                    on_delete_service, g_object_ref (res));
+	} else {
+		closure->service = g_object_ref (service);
+		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
+		                                          closure->cancellable,
+		                                          on_delete_searched, g_object_ref (res));
+	}
+
+	g_object_unref (res);
+}
+
 /**
  * secret_service_clear:
  * @service: (allow-none): the secret service
@@ -1694,10 +2685,6 @@ secret_service_clear (SecretService *service,
                       GAsyncReadyCallback callback,
                       gpointer user_data)
 {
-	const gchar *schema_name = NULL;
-	GSimpleAsyncResult *res;
-	DeleteClosure *closure;
-
 	g_return_if_fail (service == NULL || SECRET_SERVICE (service));
 	g_return_if_fail (attributes != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
@@ -1706,31 +2693,8 @@ secret_service_clear (SecretService *service,
 	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return;
 
-	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
-		schema_name = schema->name;
-
-	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
-	                                 secret_service_clear);
-	closure = g_slice_new0 (DeleteClosure);
-	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
-	closure->attributes = _secret_attributes_to_variant (attributes, schema_name);
-	g_variant_ref_sink (closure->attributes);
-	g_simple_async_result_set_op_res_gpointer (res, closure, delete_closure_free);
-
-	/* A double check to make sure we don't delete everything, should have been checked earlier */
-	g_assert (g_variant_n_children (closure->attributes) > 0);
-
-	if (service == NULL) {
-		secret_service_get (SECRET_SERVICE_NONE, cancellable,
-		                    on_delete_service, g_object_ref (res));
-	} else {
-		closure->service = g_object_ref (service);
-		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
-		                                          closure->cancellable,
-		                                          on_delete_searched, g_object_ref (res));
-	}
-
-	g_object_unref (res);
+	clear_begin (service, schema, attributes, 0, NULL, NULL, NULL,
+	             cancellable, callback, user_data);
 }
 
 /**
@@ -1791,11 +2755,167 @@ secret_service_clear_sync (SecretService *service,
                            GHashTable *attributes,
                            GCancellable *cancellable,
                            GError **error)
+{
+	ServiceSync args;
+	SecretSync *sync;
+	gboolean result;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return FALSE;
+
+	args.service = service;
+	args.schema = schema;
+	args.attributes = attributes;
+	args.cancellable = cancellable;
+
+	sync = _secret_sync_run (service_clear_sync_begin, &args);
+
+	result = secret_service_clear_finish (service, sync->result, error);
+
+	_secret_sync_free (sync);
+
+	return result;
+}
+
+/**
+ * secret_service_clear_full:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @max_in_flight: the most delete calls to have in flight at once, or zero
+ *                 for the default
+ * @progress: (allow-none) (scope notified) (closure progress_data): called
+ *            as items are removed
+ * @progress_data: data to pass to @progress
+ * @progress_destroy: (allow-none): called to free @progress_data
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Remove unlocked items which match the attributes from the secret service,
+ * for clearing a large number of items.
+ *
+ * The @attributes should be a set of key and value string pairs.
+ *
+ * No more than @max_in_flight delete calls are made at once. When the
+ * service supports removing several items in one call, then the items are
+ * removed in batches. @progress is called each time a call completes.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_service_clear_full (SecretService *service,
+                           const SecretSchema *schema,
+                           GHashTable *attributes,
+                           guint max_in_flight,
+                           SecretClearProgressFunc progress,
+                           gpointer progress_data,
+                           GDestroyNotify progress_destroy,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+	g_return_if_fail (service == NULL || SECRET_SERVICE (service));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return;
+
+	clear_begin (service, schema, attributes, max_in_flight,
+	             progress, progress_data, progress_destroy,
+	             cancellable, callback, user_data);
+}
+
+/**
+ * secret_service_clear_full_finish:
+ * @service: (allow-none): the secret service
+ * @result: the asynchronous result passed to the callback
+ * @cleared: (out) (allow-none): location to place the number of items removed
+ * @error: location to place an error on failure
+ *
+ * Finish asynchronous operation to remove items from the secret
+ * service.
+ *
+ * The number of items removed is placed in @cleared, even when the operation
+ * failed part of the way through.
+ *
+ * Returns: whether all the matching items were removed without error
+ */
+gboolean
+secret_service_clear_full_finish (SecretService *service,
+                                  GAsyncResult *result,
+                                  guint *cleared,
+                                  GError **error)
+{
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                      secret_service_clear), FALSE);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	if (cleared)
+		*cleared = closure->deleted;
+
+	if (_secret_util_propagate_error (res, error))
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * secret_service_clear_full_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): the attribute keys and values
+ * @max_in_flight: the most delete calls to have in flight at once, or zero
+ *                 for the default
+ * @progress: (allow-none) (scope call) (closure progress_data): called as
+ *            items are removed
+ * @progress_data: data to pass to @progress
+ * @cancellable: optional cancellation object
+ * @cleared: (out) (allow-none): location to place the number of items removed
+ * @error: location to place an error on failure
+ *
+ * Remove unlocked items which match the attributes from the secret service,
+ * for clearing a large number of items.
+ *
+ * See secret_service_clear_full() for details.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: whether all the matching items were removed without error
+ */
+gboolean
+secret_service_clear_full_sync (SecretService *service,
+                                const SecretSchema *schema,
+                                GHashTable *attributes,
+                                guint max_in_flight,
+                                SecretClearProgressFunc progress,
+                                gpointer progress_data,
+                                GCancellable *cancellable,
+                                guint *cleared,
+                                GError **error)
 {
 	SecretSync *sync;
 	gboolean result;
 
 	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (attributes != NULL, FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
@@ -1806,12 +2926,13 @@ secret_service_clear_sync (SecretService *service,
 	sync = _secret_sync_new ();
 	g_main_context_push_thread_default (sync->context);
 
-	secret_service_clear (service, schema, attributes, cancellable,
-	                      _secret_sync_on_result, sync);
+	secret_service_clear_full (service, schema, attributes, max_in_flight,
+	                           progress, progress_data, NULL, cancellable,
+	                           _secret_sync_on_result, sync);
 
 	g_main_loop_run (sync->loop);
 
-	result = secret_service_clear_finish (service, sync->result, error);
+	result = secret_service_clear_full_finish (service, sync->result, cleared, error);
 
 	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
@@ -16,6 +16,7 @@
 
 #include "secret-attributes.h"
 #include "secret-password.h"
+#include "secret-paths.h"
 #include "secret-private.h"
 #include "secret-value.h"
 
@@ -42,6 +43,46 @@
  * Stability: Stable
  */
 
+typedef struct {
+	const SecretSchema *schema;
+	GHashTable *attributes;
+	const gchar *collection;
+	const gchar *label;
+	const gchar *password;
+	GCancellable *cancellable;
+} PasswordSync;
+
+static void
+password_store_sync_begin (gpointer data,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+	PasswordSync *args = data;
+	secret_password_storev (args->schema, args->attributes, args->collection,
+	                        args->label, args->password, args->cancellable,
+	                        callback, user_data);
+}
+
+static void
+password_lookup_sync_begin (gpointer data,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
+{
+	PasswordSync *args = data;
+	secret_password_lookupv (args->schema, args->attributes, args->cancellable,
+	                         callback, user_data);
+}
+
+static void
+password_clear_sync_begin (gpointer data,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+	PasswordSync *args = data;
+	secret_password_clearv (args->schema, args->attributes, args->cancellable,
+	                        callback, user_data);
+}
+
 /**
  * secret_password_store: (skip)
  * @schema: the schema for attributes
@@ -270,6 +311,7 @@ secret_password_storev_sync (const SecretSchema *schema,
                              GCancellable *cancellable,
                              GError **error)
 {
+	PasswordSync args;
 	SecretSync *sync;
 	gboolean ret;
 
@@ -284,22 +326,189 @@ secret_password_storev_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, FALSE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_storev (schema, attributes, collection, label, password,
-	                        cancellable, _secret_sync_on_result, sync);
+	args.schema = schema;
+	args.attributes = attributes;
+	args.collection = collection;
+	args.label = label;
+	args.password = password;
+	args.cancellable = cancellable;
 
-	g_main_loop_run (sync->loop);
+	sync = _secret_sync_run (password_store_sync_begin, &args);
 
 	ret = secret_password_store_finish (sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
 	return ret;
 }
 
+static SecretValue **
+store_many_password_values (const gchar **passwords,
+                            guint n_items)
+{
+	SecretValue **values;
+	guint i;
+
+	values = g_new0 (SecretValue *, n_items);
+	for (i = 0; i < n_items; i++)
+		values[i] = secret_value_new (passwords[i], -1, "text/plain");
+	return values;
+}
+
+static void
+store_many_password_values_free (SecretValue **values,
+                                 guint n_items)
+{
+	guint i;
+
+	for (i = 0; i < n_items; i++)
+		secret_value_unref (values[i]);
+	g_free (values);
+}
+
+/**
+ * secret_password_store_many:
+ * @schema: the schema for attributes
+ * @attributes: (array length=n_items): the attribute keys and values for each password
+ * @labels: (array length=n_items): the label for each password
+ * @passwords: (array length=n_items): the null-terminated passwords to store
+ * @n_items: the number of passwords to store
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the collection where to store the secrets
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Store many passwords in the secret service.
+ *
+ * This is much faster than calling secret_password_store() for each of
+ * the passwords. See secret_service_store_many() for details.
+ *
+ * If @collection is %NULL, then the default collection will be
+ * used. Use #SECRET_COLLECTION_SESSION to store the passwords in the session
+ * collection, which doesn't get stored across login sessions.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_password_store_many (const SecretSchema *schema,
+                            GHashTable **attributes,
+                            const gchar **labels,
+                            const gchar **passwords,
+                            guint n_items,
+                            const gchar *collection,
+                            GCancellable *cancellable,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
+{
+	SecretValue **values;
+	guint i;
+
+	g_return_if_fail (schema != NULL);
+	g_return_if_fail (n_items == 0 || (attributes != NULL && labels != NULL && passwords != NULL));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	for (i = 0; i < n_items; i++) {
+		g_return_if_fail (passwords[i] != NULL);
+
+		/* Warnings raised already */
+		if (!_secret_attributes_validate (schema, attributes[i], G_STRFUNC, FALSE))
+			return;
+	}
+
+	values = store_many_password_values (passwords, n_items);
+
+	secret_service_store_many (NULL, schema, attributes, labels, values, n_items,
+	                           collection, cancellable, callback, user_data);
+
+	store_many_password_values_free (values, n_items);
+}
+
+/**
+ * secret_password_store_many_finish:
+ * @result: the asynchronous result passed to the callback
+ * @errors: (out) (allow-none) (transfer full) (element-type GLib.Error):
+ *          location to place an array with the failure of each password, or
+ *          %NULL for each password that was stored
+ * @error: location to place an error on failure
+ *
+ * Finish asynchronous operation to store many passwords in the secret service.
+ *
+ * If some of the passwords could not be stored, then %FALSE is returned and
+ * @error is set to the first failure. The outcome for every password is
+ * placed in @errors.
+ *
+ * Returns: whether all the passwords were stored or not
+ */
+gboolean
+secret_password_store_many_finish (GAsyncResult *result,
+                                   GPtrArray **errors,
+                                   GError **error)
+{
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return secret_service_store_many_finish (NULL, result, errors, error);
+}
+
+/**
+ * secret_password_store_many_sync:
+ * @schema: the schema for attributes
+ * @attributes: (array length=n_items): the attribute keys and values for each password
+ * @labels: (array length=n_items): the label for each password
+ * @passwords: (array length=n_items): the null-terminated passwords to store
+ * @n_items: the number of passwords to store
+ * @collection: (allow-none): a collection alias, or D-Bus object path of the collection where to store the secrets
+ * @cancellable: optional cancellation object
+ * @errors: (out) (allow-none) (transfer full) (element-type GLib.Error):
+ *          location to place an array with the failure of each password, or
+ *          %NULL for each password that was stored
+ * @error: location to place an error on failure
+ *
+ * Store many passwords in the secret service.
+ *
+ * This is much faster than calling secret_password_store_sync() for each
+ * of the passwords. See secret_service_store_many_sync() for details.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: whether all the passwords were stored or not
+ */
+gboolean
+secret_password_store_many_sync (const SecretSchema *schema,
+                                 GHashTable **attributes,
+                                 const gchar **labels,
+                                 const gchar **passwords,
+                                 guint n_items,
+                                 const gchar *collection,
+                                 GCancellable *cancellable,
+                                 GPtrArray **errors,
+                                 GError **error)
+{
+	SecretValue **values;
+	gboolean ret;
+	guint i;
+
+	g_return_val_if_fail (schema != NULL, FALSE);
+	g_return_val_if_fail (n_items == 0 || (attributes != NULL && labels != NULL && passwords != NULL), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = 0; i < n_items; i++) {
+		g_return_val_if_fail (passwords[i] != NULL, FALSE);
+
+		/* Warnings raised already */
+		if (!_secret_attributes_validate (schema, attributes[i], G_STRFUNC, FALSE))
+			return FALSE;
+	}
+
+	values = store_many_password_values (passwords, n_items);
+
+	ret = secret_service_store_many_sync (NULL, schema, attributes, labels, values, n_items,
+	                                      collection, cancellable, errors, error);
+
+	store_many_password_values_free (values, n_items);
+	return ret;
+}
+
 /**
  * secret_password_lookup: (skip)
  * @schema: the schema for the attributes
@@ -560,6 +769,7 @@ secret_password_lookupv_nonpageable_sync (const SecretSchema *schema,
                                           GCancellable *cancellable,
                                           GError **error)
 {
+	PasswordSync args;
 	SecretSync *sync;
 	gchar *password;
 
@@ -572,17 +782,14 @@ secret_password_lookupv_nonpageable_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_lookupv (schema, attributes, cancellable,
-	                         _secret_sync_on_result, sync);
+	args.schema = schema;
+	args.attributes = attributes;
+	args.cancellable = cancellable;
 
-	g_main_loop_run (sync->loop);
+	sync = _secret_sync_run (password_lookup_sync_begin, &args);
 
 	password = secret_password_lookup_nonpageable_finish (sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
 	return password;
@@ -613,6 +820,7 @@ secret_password_lookupv_sync (const SecretSchema *schema,
                               GCancellable *cancellable,
                               GError **error)
 {
+	PasswordSync args;
 	SecretSync *sync;
 	gchar *string;
 
@@ -625,20 +833,573 @@ secret_password_lookupv_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
+	args.schema = schema;
+	args.attributes = attributes;
+	args.cancellable = cancellable;
+
+	sync = _secret_sync_run (password_lookup_sync_begin, &args);
+
+	string = secret_password_lookup_finish (sync->result, error);
+
+	_secret_sync_free (sync);
+
+	return string;
+}
+
+typedef struct {
+	GCancellable *cancellable;
+	SecretService *service;
+	SecretCache *cache;
+	GPtrArray *attributes;
+	gchar **paths;
+	SecretValue **values;
+	GHashTable *locked;
+	guint64 generation;
+	guint next;
+	guint searching;
+	gboolean failed;
+} LookupManyClosure;
+
+typedef struct {
+	GSimpleAsyncResult *res;
+	guint index;
+} LookupManyCall;
+
+static void
+lookup_many_closure_free (gpointer data)
+{
+	LookupManyClosure *closure = data;
+	guint i;
+
+	for (i = 0; i < closure->attributes->len; i++) {
+		g_free (closure->paths[i]);
+		if (closure->values[i])
+			secret_value_unref (closure->values[i]);
+	}
+	g_free (closure->paths);
+	g_free (closure->values);
+	g_ptr_array_unref (closure->attributes);
+	g_hash_table_unref (closure->locked);
+	if (closure->cache)
+		_secret_cache_unref (closure->cache);
+	g_clear_object (&closure->service);
+	g_clear_object (&closure->cancellable);
+	g_slice_free (LookupManyClosure, closure);
+}
+
+static void
+on_lookup_many_secrets (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	GHashTable *secrets;
+	SecretValue *value;
+	guint i;
+
+	secrets = secret_service_get_secrets_for_dbus_paths_finish (closure->service,
+	                                                            result, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+
+	} else {
+		for (i = 0; i < closure->attributes->len; i++) {
+			if (closure->values[i] != NULL || closure->paths[i] == NULL)
+				continue;
+			value = g_hash_table_lookup (secrets, closure->paths[i]);
+			if (value == NULL)
+				continue;
+			closure->values[i] = secret_value_ref (value);
+			if (closure->cache)
+				_secret_cache_store_secret (closure->cache, closure->paths[i],
+				                            value, closure->generation);
+		}
+
+		g_hash_table_unref (secrets);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+static void
+lookup_many_load_secrets (GSimpleAsyncResult *res)
+{
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GHashTable *wanted;
+	GPtrArray *paths;
+	guint i;
+
+	wanted = g_hash_table_new (g_str_hash, g_str_equal);
+	paths = g_ptr_array_new ();
+
+	/* Secrets already in the cache don't need to go over the bus at all */
+	if (closure->cache)
+		closure->generation = _secret_cache_get_generation (closure->cache);
+	for (i = 0; i < closure->attributes->len; i++) {
+		if (closure->paths[i] == NULL)
+			continue;
+		if (closure->cache)
+			closure->values[i] = _secret_cache_lookup_secret (closure->cache,
+			                                                  closure->paths[i],
+			                                                  NULL);
+		if (closure->values[i] == NULL &&
+		    !g_hash_table_lookup (wanted, closure->paths[i])) {
+			g_hash_table_add (wanted, closure->paths[i]);
+			g_ptr_array_add (paths, closure->paths[i]);
+		}
+	}
+
+	/* All the remaining secrets are retrieved in a single GetSecrets call */
+	if (paths->len > 0) {
+		g_ptr_array_add (paths, NULL);
+		secret_service_get_secrets_for_dbus_paths (closure->service,
+		                                           (const gchar **)paths->pdata,
+		                                           closure->cancellable,
+		                                           on_lookup_many_secrets,
+		                                           g_object_ref (res));
+	} else {
+		g_simple_async_result_complete (res);
+	}
+
+	g_ptr_array_free (paths, TRUE);
+	g_hash_table_unref (wanted);
+}
+
+static void
+on_lookup_many_unlocked (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	/* Items that stay locked are simply left out of the GetSecrets results */
+	secret_service_unlock_dbus_paths_finish (closure->service, result, NULL, NULL);
+
+	lookup_many_load_secrets (res);
+	g_object_unref (res);
+}
+
+static void
+lookup_many_unlock (GSimpleAsyncResult *res)
+{
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GHashTableIter iter;
+	GPtrArray *paths;
+	gpointer path;
+
+	if (g_hash_table_size (closure->locked) == 0) {
+		lookup_many_load_secrets (res);
+		return;
+	}
+
+	paths = g_ptr_array_new ();
+	g_hash_table_iter_init (&iter, closure->locked);
+	while (g_hash_table_iter_next (&iter, &path, NULL))
+		g_ptr_array_add (paths, path);
+	g_ptr_array_add (paths, NULL);
+
+	secret_service_unlock_dbus_paths (closure->service,
+	                                  (const gchar **)paths->pdata,
+	                                  closure->cancellable,
+	                                  on_lookup_many_unlocked,
+	                                  g_object_ref (res));
+
+	g_ptr_array_free (paths, TRUE);
+}
+
+static void
+lookup_many_search_next (GSimpleAsyncResult *res);
+
+static void
+on_lookup_many_searched (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	LookupManyCall *call = user_data;
+	GSimpleAsyncResult *res = call->res;
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+	gchar **locked = NULL;
+
+	closure->searching--;
+
+	secret_service_search_for_dbus_paths_finish (closure->service, result,
+	                                             &unlocked, &locked, &error);
+	if (error != NULL) {
+		if (!closure->failed)
+			g_simple_async_result_take_error (res, error);
+		else
+			g_error_free (error);
+
+		/* No point in searching for the rest */
+		closure->failed = TRUE;
+		closure->next = closure->attributes->len;
+
+	} else if (unlocked[0] != NULL) {
+		closure->paths[call->index] = g_strdup (unlocked[0]);
+
+	} else if (locked[0] != NULL) {
+		closure->paths[call->index] = g_strdup (locked[0]);
+		g_hash_table_add (closure->locked, g_strdup (locked[0]));
+	}
+
+	lookup_many_search_next (res);
+
+	if (closure->searching == 0) {
+		if (closure->failed)
+			g_simple_async_result_complete (res);
+		else
+			lookup_many_unlock (res);
+	}
+
+	g_strfreev (unlocked);
+	g_strfreev (locked);
+	g_object_unref (res);
+	g_slice_free (LookupManyCall, call);
+}
+
+static void
+lookup_many_search_next (GSimpleAsyncResult *res)
+{
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	guint max_in_flight = _secret_util_max_in_flight ();
+	LookupManyCall *call;
+
+	/* Pipeline the searches, rather than waiting for each in turn */
+	while (closure->searching < max_in_flight && closure->next < closure->attributes->len) {
+		call = g_slice_new (LookupManyCall);
+		call->res = g_object_ref (res);
+		call->index = closure->next++;
+
+		_secret_service_search_for_paths_variant (closure->service,
+		                                          closure->attributes->pdata[call->index],
+		                                          closure->cancellable,
+		                                          on_lookup_many_searched, call);
+		closure->searching++;
+	}
+}
+
+static void
+on_lookup_many_service (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	LookupManyClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	closure->service = secret_service_get_finish (result, &error);
+	if (error != NULL) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	} else if (closure->attributes->len == 0) {
+		g_simple_async_result_complete (res);
+
+	} else {
+		closure->cache = _secret_service_get_cache (closure->service);
+		lookup_many_search_next (res);
+	}
+
+	g_object_unref (res);
+}
+
+static void
+lookup_many_begin (GPtrArray *attributes,
+                   GCancellable *cancellable,
+                   GAsyncReadyCallback callback,
+                   gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	LookupManyClosure *closure;
+
+	res = g_simple_async_result_new (NULL, callback, user_data,
+	                                 secret_password_lookup_many);
+	closure = g_slice_new0 (LookupManyClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->attributes = attributes;
+	closure->paths = g_new0 (gchar *, attributes->len);
+	closure->values = g_new0 (SecretValue *, attributes->len);
+	closure->locked = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_simple_async_result_set_op_res_gpointer (res, closure, lookup_many_closure_free);
+
+	secret_service_get (SECRET_SERVICE_OPEN_SESSION, cancellable,
+	                    on_lookup_many_service, g_object_ref (res));
+
+	g_object_unref (res);
+}
+
+static GVariant *
+lookup_many_attributes_to_variant (const SecretSchema *schema,
+                                   GHashTable *attributes)
+{
+	const gchar *schema_name = NULL;
+
+	if (!(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
+		schema_name = schema->name;
+
+	return g_variant_ref_sink (_secret_attributes_to_variant (attributes, schema_name));
+}
+
+/**
+ * secret_password_lookup_many: (skip)
+ * @schema: the schema for the attributes
+ * @attributes: (array length=n_attributes): an array of attribute tables,
+ *              one for each password to lookup
+ * @n_attributes: the number of attribute tables
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Lookup several passwords in the secret service at once.
+ *
+ * Each of the @attributes should be a set of key and value string pairs.
+ * The searches for all of them are sent without waiting for each other,
+ * and the passwords of the matching items are then retrieved together.
+ * This is much faster than calling secret_password_lookup() many times.
+ *
+ * The results are in the same order as @attributes. Where no password was
+ * found, the result is %NULL.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_password_lookup_many (const SecretSchema *schema,
+                             GHashTable **attributes,
+                             guint n_attributes,
+                             GCancellable *cancellable,
+                             GAsyncReadyCallback callback,
+                             gpointer user_data)
+{
+	GPtrArray *variants;
+	guint i;
+
+	g_return_if_fail (schema != NULL);
+	g_return_if_fail (attributes != NULL || n_attributes == 0);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	for (i = 0; i < n_attributes; i++) {
+		if (!_secret_attributes_validate (schema, attributes[i], G_STRFUNC, TRUE))
+			return;
+	}
+
+	variants = g_ptr_array_new_with_free_func ((GDestroyNotify)g_variant_unref);
+	for (i = 0; i < n_attributes; i++)
+		g_ptr_array_add (variants, lookup_many_attributes_to_variant (schema, attributes[i]));
+
+	lookup_many_begin (variants, cancellable, callback, user_data);
+}
+
+/**
+ * secret_password_lookup_manyv: (rename-to secret_password_lookup_many)
+ * @schema: the schema for the attributes
+ * @attributes: (element-type GLib.HashTable(utf8,utf8)): a list of attribute tables,
+ *              one for each password to lookup
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Lookup several passwords in the secret service at once.
+ *
+ * Each of the @attributes should be a set of key and value string pairs.
+ * The searches for all of them are sent without waiting for each other,
+ * and the passwords of the matching items are then retrieved together.
+ *
+ * The results are in the same order as @attributes. Where no password was
+ * found, the result is %NULL.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_password_lookup_manyv (const SecretSchema *schema,
+                              GList *attributes,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+	GPtrArray *variants;
+	GList *l;
+
+	g_return_if_fail (schema != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	for (l = attributes; l != NULL; l = g_list_next (l)) {
+		if (!_secret_attributes_validate (schema, l->data, G_STRFUNC, TRUE))
+			return;
+	}
+
+	variants = g_ptr_array_new_with_free_func ((GDestroyNotify)g_variant_unref);
+	for (l = attributes; l != NULL; l = g_list_next (l))
+		g_ptr_array_add (variants, lookup_many_attributes_to_variant (schema, l->data));
+
+	lookup_many_begin (variants, cancellable, callback, user_data);
+}
+
+/**
+ * secret_password_lookup_many_finish:
+ * @result: the asynchronous result passed to the callback
+ * @error: location to place an error on failure
+ *
+ * Finish an asynchronous operation to lookup several passwords in the
+ * secret service.
+ *
+ * Returns: (transfer full) (element-type utf8): an array of passwords in
+ *          the same order as the attributes looked up, with %NULL where no
+ *          password was found; release with g_ptr_array_unref() when done
+ */
+GPtrArray *
+secret_password_lookup_many_finish (GAsyncResult *result,
+                                    GError **error)
+{
+	GSimpleAsyncResult *res;
+	LookupManyClosure *closure;
+	GPtrArray *passwords;
+	guint i;
+
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, NULL,
+	                      secret_password_lookup_many), NULL);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return NULL;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	passwords = g_ptr_array_new_with_free_func ((GDestroyNotify)secret_password_free);
+	for (i = 0; i < closure->attributes->len; i++) {
+		if (closure->values[i] == NULL) {
+			g_ptr_array_add (passwords, NULL);
+		} else {
+			g_ptr_array_add (passwords, _secret_value_unref_to_string (closure->values[i]));
+			closure->values[i] = NULL;
+		}
+	}
+
+	return passwords;
+}
+
+/**
+ * secret_password_lookup_many_sync: (skip)
+ * @schema: the schema for the attributes
+ * @attributes: (array length=n_attributes): an array of attribute tables,
+ *              one for each password to lookup
+ * @n_attributes: the number of attribute tables
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Lookup several passwords in the secret service at once.
+ *
+ * Each of the @attributes should be a set of key and value string pairs.
+ * The results are in the same order as @attributes. Where no password was
+ * found, the result is %NULL.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: (transfer full) (element-type utf8): an array of passwords in
+ *          the same order as @attributes; release with g_ptr_array_unref()
+ *          when done
+ */
+GPtrArray *
+secret_password_lookup_many_sync (const SecretSchema *schema,
+                                  GHashTable **attributes,
+                                  guint n_attributes,
+                                  GCancellable *cancellable,
+                                  GError **error)
+{
+	SecretSync *sync;
+	GPtrArray *passwords;
+	guint i;
+
+	g_return_val_if_fail (schema != NULL, NULL);
+	g_return_val_if_fail (attributes != NULL || n_attributes == 0, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Warnings raised already */
+	for (i = 0; i < n_attributes; i++) {
+		if (!_secret_attributes_validate (schema, attributes[i], G_STRFUNC, TRUE))
+			return NULL;
+	}
+
 	sync = _secret_sync_new ();
 	g_main_context_push_thread_default (sync->context);
 
-	secret_password_lookupv (schema, attributes, cancellable,
-	                         _secret_sync_on_result, sync);
+	secret_password_lookup_many (schema, attributes, n_attributes, cancellable,
+	                             _secret_sync_on_result, sync);
 
 	g_main_loop_run (sync->loop);
 
-	string = secret_password_lookup_finish (sync->result, error);
+	passwords = secret_password_lookup_many_finish (sync->result, error);
 
 	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
-	return string;
+	return passwords;
+}
+
+/**
+ * secret_password_lookup_manyv_sync: (rename-to secret_password_lookup_many_sync)
+ * @schema: the schema for the attributes
+ * @attributes: (element-type GLib.HashTable(utf8,utf8)): a list of attribute tables,
+ *              one for each password to lookup
+ * @cancellable: optional cancellation object
+ * @error: location to place an error on failure
+ *
+ * Lookup several passwords in the secret service at once.
+ *
+ * Each of the @attributes should be a set of key and value string pairs.
+ * The results are in the same order as @attributes. Where no password was
+ * found, the result is %NULL.
+ *
+ * This method may block indefinitely and should not be used in user interface
+ * threads.
+ *
+ * Returns: (transfer full) (element-type utf8): an array of passwords in
+ *          the same order as @attributes; release with g_ptr_array_unref()
+ *          when done
+ */
+GPtrArray *
+secret_password_lookup_manyv_sync (const SecretSchema *schema,
+                                   GList *attributes,
+                                   GCancellable *cancellable,
+                                   GError **error)
+{
+	SecretSync *sync;
+	GPtrArray *passwords;
+	GList *l;
+
+	g_return_val_if_fail (schema != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Warnings raised already */
+	for (l = attributes; l != NULL; l = g_list_next (l)) {
+		if (!_secret_attributes_validate (schema, l->data, G_STRFUNC, TRUE))
+			return NULL;
+	}
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_password_lookup_manyv (schema, attributes, cancellable,
+	                              _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	passwords = secret_password_lookup_many_finish (sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return passwords;
 }
 
 /**
@@ -816,6 +1577,7 @@ secret_password_clearv_sync (const SecretSchema *schema,
                              GCancellable *cancellable,
                              GError **error)
 {
+	PasswordSync args;
 	SecretSync *sync;
 	gboolean result;
 
@@ -828,17 +1590,14 @@ secret_password_clearv_sync (const SecretSchema *schema,
 	if (!_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
 		return FALSE;
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_password_clearv (schema, attributes, cancellable,
-	                        _secret_sync_on_result, sync);
+	args.schema = schema;
+	args.attributes = attributes;
+	args.cancellable = cancellable;
 
-	g_main_loop_run (sync->loop);
+	sync = _secret_sync_run (password_clear_sync_begin, &args);
 
 	result = secret_password_clear_finish (sync->result, error);
 
-	g_main_context_pop_thread_default (sync->context);
 	_secret_sync_free (sync);
 
 	return result;
@@ -63,6 +63,30 @@ gboolean    secret_password_storev_sync                (const SecretSchema *sche
                                                         GCancellable *cancellable,
                                                         GError **error);
 
+void        secret_password_store_many                 (const SecretSchema *schema,
+                                                        GHashTable **attributes,
+                                                        const gchar **labels,
+                                                        const gchar **passwords,
+                                                        guint n_items,
+                                                        const gchar *collection,
+                                                        GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback,
+                                                        gpointer user_data);
+
+gboolean    secret_password_store_many_finish          (GAsyncResult *result,
+                                                        GPtrArray **errors,
+                                                        GError **error);
+
+gboolean    secret_password_store_many_sync            (const SecretSchema *schema,
+                                                        GHashTable **attributes,
+                                                        const gchar **labels,
+                                                        const gchar **passwords,
+                                                        guint n_items,
+                                                        const gchar *collection,
+                                                        GCancellable *cancellable,
+                                                        GPtrArray **errors,
+                                                        GError **error);
+
 void        secret_password_lookup                     (const SecretSchema *schema,
                                                         GCancellable *cancellable,
                                                         GAsyncReadyCallback callback,
@@ -101,6 +125,33 @@ gchar *     secret_password_lookupv_nonpageable_sync   (const SecretSchema *sche
                                                         GCancellable *cancellable,
                                                         GError **error);
 
+void        secret_password_lookup_many                (const SecretSchema *schema,
+                                                        GHashTable **attributes,
+                                                        guint n_attributes,
+                                                        GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback,
+                                                        gpointer user_data);
+
+void        secret_password_lookup_manyv               (const SecretSchema *schema,
+                                                        GList *attributes,
+                                                        GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback,
+                                                        gpointer user_data);
+
+GPtrArray * secret_password_lookup_many_finish         (GAsyncResult *result,
+                                                        GError **error);
+
+GPtrArray * secret_password_lookup_many_sync           (const SecretSchema *schema,
+                                                        GHashTable **attributes,
+                                                        guint n_attributes,
+                                                        GCancellable *cancellable,
+                                                        GError **error);
+
+GPtrArray * secret_password_lookup_manyv_sync          (const SecretSchema *schema,
+                                                        GList *attributes,
+                                                        GCancellable *cancellable,
+                                                        GError **error);
+
 void        secret_password_clear                      (const SecretSchema *schema,
                                                         GCancellable *cancellable,
                                                         GAsyncReadyCallback callback,
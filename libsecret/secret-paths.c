@@ -75,7 +75,8 @@ secret_collection_new_for_dbus_path (SecretService *service,
 
 	g_async_initable_new_async (secret_service_get_collection_gtype (service),
 	                            G_PRIORITY_DEFAULT, cancellable, callback, user_data,
-	                            "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                            "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                            "g-interface-info", _secret_gen_collection_interface_info (),
 	                            "g-name", g_dbus_proxy_get_name (proxy),
 	                            "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -157,7 +158,8 @@ secret_collection_new_for_dbus_path_sync (SecretService *service,
 
 	return g_initable_new (secret_service_get_collection_gtype (service),
 	                       cancellable, error,
-	                       "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                       "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                  G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                       "g-interface-info", _secret_gen_collection_interface_info (),
 	                       "g-name", g_dbus_proxy_get_name (proxy),
 	                       "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -168,6 +170,30 @@ secret_collection_new_for_dbus_path_sync (SecretService *service,
 	                       NULL);
 }
 
+static SecretItem *
+item_find_instance (SecretService *service,
+                    const gchar *item_path,
+                    SecretItemFlags flags)
+{
+	SecretItem *item;
+
+	if (service == NULL)
+		return NULL;
+
+	item = _secret_service_find_item_instance (service, item_path);
+	if (item == NULL)
+		return NULL;
+
+	/* Reused only if it already has what the caller asked for */
+	if ((flags & SECRET_ITEM_LOAD_SECRET) &&
+	    !(secret_item_get_flags (item) & SECRET_ITEM_LOAD_SECRET)) {
+		g_object_unref (item);
+		return NULL;
+	}
+
+	return item;
+}
+
 /**
  * secret_item_new_for_dbus_path: (skip)
  * @service: (allow-none): a secret service object
@@ -182,6 +208,14 @@ secret_collection_new_for_dbus_path_sync (SecretService *service,
  * If @service is NULL, then secret_service_get() will be called to get
  * the default #SecretService proxy.
  *
+ * If @service already has a live proxy for this item, for instance one
+ * returned from an earlier search, then that same #SecretItem is returned
+ * rather than a new one.
+ *
+ * If %SECRET_ITEM_LAZY_PROPERTIES is set in @flags, the item's properties
+ * are not retrieved until they are first used, and whether the item exists
+ * is not checked.
+ *
  * This method will return immediately and complete asynchronously.
  *
  * Stability: Unstable
@@ -194,17 +228,30 @@ secret_item_new_for_dbus_path (SecretService *service,
                                GAsyncReadyCallback callback,
                                gpointer user_data)
 {
+	GSimpleAsyncResult *res;
 	GDBusProxy *proxy;
+	SecretItem *item;
 
 	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
 	g_return_if_fail (item_path != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
+	item = item_find_instance (service, item_path, flags);
+	if (item != NULL) {
+		res = g_simple_async_result_new (G_OBJECT (item), callback, user_data,
+		                                 secret_item_new_for_dbus_path);
+		g_simple_async_result_complete_in_idle (res);
+		g_object_unref (item);
+		g_object_unref (res);
+		return;
+	}
+
 	proxy = G_DBUS_PROXY (service);
 
 	g_async_initable_new_async (secret_service_get_item_gtype (service),
 	                            G_PRIORITY_DEFAULT, cancellable, callback, user_data,
-	                            "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                            "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                            "g-interface-info", _secret_gen_item_interface_info (),
 	                            "g-name", g_dbus_proxy_get_name (proxy),
 	                            "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -236,6 +283,11 @@ secret_item_new_for_dbus_path_finish (GAsyncResult *result,
 	GObject *source_object;
 
 	source_object = g_async_result_get_source_object (result);
+
+	/* An existing item was handed out */
+	if (g_simple_async_result_is_valid (result, source_object, secret_item_new_for_dbus_path))
+		return SECRET_ITEM (source_object);
+
 	object = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object),
 	                                      result, error);
 	g_object_unref (source_object);
@@ -259,6 +311,14 @@ secret_item_new_for_dbus_path_finish (GAsyncResult *result,
  * If @service is NULL, then secret_service_get_sync() will be called to get
  * the default #SecretService proxy.
  *
+ * If @service already has a live proxy for this item, for instance one
+ * returned from an earlier search, then that same #SecretItem is returned
+ * rather than a new one.
+ *
+ * If %SECRET_ITEM_LAZY_PROPERTIES is set in @flags, the item's properties
+ * are not retrieved until they are first used, and whether the item exists
+ * is not checked.
+ *
  * This method may block indefinitely and should not be used in user interface
  * threads.
  *
@@ -275,17 +335,23 @@ secret_item_new_for_dbus_path_sync (SecretService *service,
                                     GError **error)
 {
 	GDBusProxy *proxy;
+	SecretItem *item;
 
 	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
 	g_return_val_if_fail (item_path != NULL, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
+	item = item_find_instance (service, item_path, flags);
+	if (item != NULL)
+		return item;
+
 	proxy = G_DBUS_PROXY (service);
 
 	return g_initable_new (secret_service_get_item_gtype (service),
 	                       cancellable, error,
-	                       "g-flags", G_DBUS_CALL_FLAGS_NONE,
+	                       "g-flags", G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS |
+	                                  G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                       "g-interface-info", _secret_gen_item_interface_info (),
 	                       "g-name", g_dbus_proxy_get_name (proxy),
 	                       "g-connection", g_dbus_proxy_get_connection (proxy),
@@ -513,6 +579,45 @@ secret_service_search_for_dbus_paths (SecretService *self,
 	                                          cancellable, callback, user_data);
 }
 
+typedef struct {
+	SecretCache *cache;
+	GVariant *attributes;
+	guint64 generation;
+	GVariant *response;
+} SearchPathsClosure;
+
+static void
+search_paths_closure_free (gpointer data)
+{
+	SearchPathsClosure *closure = data;
+	if (closure->cache)
+		_secret_cache_unref (closure->cache);
+	g_variant_unref (closure->attributes);
+	if (closure->response)
+		g_variant_unref (closure->response);
+	g_slice_free (SearchPathsClosure, closure);
+}
+
+static void
+on_search_paths_complete (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SearchPathsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	closure->response = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), result, &error);
+	if (error != NULL)
+		g_simple_async_result_take_error (res, error);
+	else if (closure->cache)
+		_secret_cache_store_search (closure->cache, closure->attributes,
+		                            closure->response, closure->generation);
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
 void
 _secret_service_search_for_paths_variant (SecretService *self,
                                           GVariant *attributes,
@@ -521,6 +626,7 @@ _secret_service_search_for_paths_variant (SecretService *self,
                                           gpointer user_data)
 {
 	GSimpleAsyncResult *res;
+	SearchPathsClosure *closure;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (attributes != NULL);
@@ -528,11 +634,21 @@ _secret_service_search_for_paths_variant (SecretService *self,
 
 	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
 	                                 secret_service_search_for_dbus_paths);
+	closure = g_slice_new0 (SearchPathsClosure);
+	closure->attributes = g_variant_ref_sink (attributes);
+	closure->cache = _secret_service_get_cache (self);
+	g_simple_async_result_set_op_res_gpointer (res, closure, search_paths_closure_free);
 
-	g_dbus_proxy_call (G_DBUS_PROXY (self), "SearchItems",
-	                   g_variant_new ("(@a{ss})", attributes),
-	                   G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
-	                   on_search_items_complete, g_object_ref (res));
+	if (closure->cache && _secret_cache_lookup_search (closure->cache, closure->attributes,
+	                                                   &closure->response, &closure->generation)) {
+		g_simple_async_result_complete_in_idle (res);
+
+	} else {
+		g_dbus_proxy_call (G_DBUS_PROXY (self), "SearchItems",
+		                   g_variant_new ("(@a{ss})", closure->attributes),
+		                   G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
+		                   on_search_paths_complete, g_object_ref (res));
+	}
 
 	g_object_unref (res);
 }
@@ -571,7 +687,7 @@ secret_service_search_for_dbus_paths_finish (SecretService *self,
                                              gchar ***locked,
                                              GError **error)
 {
-	GVariant *response;
+	SearchPathsClosure *closure;
 	GSimpleAsyncResult *res;
 	gchar **dummy = NULL;
 
@@ -588,8 +704,8 @@ secret_service_search_for_dbus_paths_finish (SecretService *self,
 			unlocked = &dummy;
 		else if (!locked)
 			locked = &dummy;
-		response = g_simple_async_result_get_op_res_gpointer (res);
-		g_variant_get (response, "(^ao^ao)", unlocked, locked);
+		closure = g_simple_async_result_get_op_res_gpointer (res);
+		g_variant_get (closure->response, "(^ao^ao)", unlocked, locked);
 	}
 
 	g_strfreev (dummy);
@@ -639,7 +755,10 @@ secret_service_search_for_dbus_paths_sync (SecretService *self,
 {
 	const gchar *schema_name = NULL;
 	gchar **dummy = NULL;
-	GVariant *response;
+	GVariant *attrs;
+	GVariant *response = NULL;
+	SecretCache *cache;
+	guint64 generation = 0;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (attributes != NULL, FALSE);
@@ -653,10 +772,20 @@ secret_service_search_for_dbus_paths_sync (SecretService *self,
 	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
 		schema_name = schema->name;
 
-	response = g_dbus_proxy_call_sync (G_DBUS_PROXY (self), "SearchItems",
-	                                   g_variant_new ("(@a{ss})",
-	                                                  _secret_attributes_to_variant (attributes, schema_name)),
-	                                   G_DBUS_CALL_FLAGS_NONE, -1, cancellable, error);
+	attrs = g_variant_ref_sink (_secret_attributes_to_variant (attributes, schema_name));
+	cache = _secret_service_get_cache (self);
+
+	if (cache == NULL || !_secret_cache_lookup_search (cache, attrs, &response, &generation)) {
+		response = g_dbus_proxy_call_sync (G_DBUS_PROXY (self), "SearchItems",
+		                                   g_variant_new ("(@a{ss})", attrs),
+		                                   G_DBUS_CALL_FLAGS_NONE, -1, cancellable, error);
+		if (response != NULL && cache != NULL)
+			_secret_cache_store_search (cache, attrs, response, generation);
+	}
+
+	if (cache)
+		_secret_cache_unref (cache);
+	g_variant_unref (attrs);
 
 	if (response != NULL) {
 		if (unlocked || locked) {
@@ -680,6 +809,9 @@ typedef struct {
 	GVariant *in;
 	GVariant *out;
 	GHashTable *items;
+	SecretCache *cache;
+	guint64 generation;
+	SecretValue *value;
 } GetClosure;
 
 static void
@@ -690,6 +822,10 @@ get_closure_free (gpointer data)
 		g_variant_unref (closure->in);
 	if (closure->out)
 		g_variant_unref (closure->out);
+	if (closure->cache)
+		_secret_cache_unref (closure->cache);
+	if (closure->value)
+		secret_value_unref (closure->value);
 	g_clear_object (&closure->cancellable);
 	g_slice_free (GetClosure, closure);
 }
@@ -776,11 +912,21 @@ secret_service_get_secret_for_dbus_path (SecretService *self,
 	closure = g_slice_new0 (GetClosure);
 	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
 	closure->in = g_variant_ref_sink (g_variant_new_objv (&item_path, 1));
+	closure->cache = _secret_service_get_cache (self);
 	g_simple_async_result_set_op_res_gpointer (res, closure, get_closure_free);
 
-	secret_service_ensure_session (self, cancellable,
-	                               on_get_secrets_session,
-	                               g_object_ref (res));
+	if (closure->cache)
+		closure->value = _secret_cache_lookup_secret (closure->cache, item_path,
+		                                              &closure->generation);
+
+	if (closure->value) {
+		g_simple_async_result_complete_in_idle (res);
+
+	} else {
+		secret_service_ensure_session (self, cancellable,
+		                               on_get_secrets_session,
+		                               g_object_ref (res));
+	}
 
 	g_object_unref (res);
 }
@@ -808,6 +954,8 @@ secret_service_get_secret_for_dbus_path_finish (SecretService *self,
 {
 	GSimpleAsyncResult *res;
 	GetClosure *closure;
+	const gchar *item_path;
+	SecretValue *value;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
@@ -819,7 +967,16 @@ secret_service_get_secret_for_dbus_path_finish (SecretService *self,
 		return NULL;
 
 	closure = g_simple_async_result_get_op_res_gpointer (res);
-	return _secret_service_decode_get_secrets_first (self, closure->out);
+	if (closure->value)
+		return secret_value_ref (closure->value);
+
+	value = _secret_service_decode_get_secrets_first (self, closure->out);
+	if (value && closure->cache) {
+		g_variant_get_child (closure->in, 0, "&o", &item_path);
+		_secret_cache_store_secret (closure->cache, item_path, value, closure->generation);
+	}
+
+	return value;
 }
 
 /**
@@ -851,26 +1008,40 @@ secret_service_get_secret_for_dbus_path_sync (SecretService *self,
                                               GCancellable *cancellable,
                                               GError **error)
 {
-	SecretSync *sync;
-	SecretValue *value;
+	SecretValue *value = NULL;
+	guint64 generation = 0;
+	SecretCache *cache;
+	GVariant *retval;
 
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (item_path != NULL, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_get_secret_for_dbus_path (self, item_path, cancellable,
-	                                         _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
+	cache = _secret_service_get_cache (self);
+	if (cache)
+		value = _secret_cache_lookup_secret (cache, item_path, &generation);
+
+	/* Once there's a session this is a single call, and needs no main loop */
+	if (value == NULL && (secret_service_get_session_dbus_path (self) != NULL ||
+	                      secret_service_ensure_session_sync (self, cancellable, error))) {
+		retval = g_dbus_proxy_call_sync (G_DBUS_PROXY (self), "GetSecrets",
+		                                 g_variant_new ("(@aoo)", g_variant_new_objv (&item_path, 1),
+		                                                secret_service_get_session_dbus_path (self)),
+		                                 G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+		                                 cancellable, error);
+		if (retval != NULL) {
+			value = _secret_service_decode_get_secrets_first (self, retval);
+			if (value && cache)
+				_secret_cache_store_secret (cache, item_path, value, generation);
+			g_variant_unref (retval);
+		} else {
+			_secret_util_strip_remote_error (error);
+		}
+	}
 
-	value = secret_service_get_secret_for_dbus_path_finish (self, sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
+	if (cache)
+		_secret_cache_unref (cache);
 
 	return value;
 }
@@ -1415,7 +1586,7 @@ secret_service_unlock_dbus_paths_finish (SecretService *self,
 typedef struct {
 	GCancellable *cancellable;
 	SecretPrompt *prompt;
-	gboolean deleted;
+	gint deleted;
 } DeleteClosure;
 
 static void
@@ -1542,6 +1713,168 @@ _secret_service_delete_path_finish (SecretService *self,
 	return closure->deleted;
 }
 
+gboolean
+_secret_service_delete_path_sync (SecretService *self,
+                                  const gchar *object_path,
+                                  gboolean is_an_item,
+                                  GCancellable *cancellable,
+                                  GError **error)
+{
+	const gchar *prompt_path;
+	SecretPrompt *prompt;
+	GError *local = NULL;
+	GVariant *retval;
+	GVariant *result;
+	gboolean ret;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (object_path != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+
+	/* Call directly, only a prompt needs a main loop */
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+	                                      g_dbus_proxy_get_name (G_DBUS_PROXY (self)), object_path,
+	                                      is_an_item ? SECRET_ITEM_INTERFACE : SECRET_COLLECTION_INTERFACE,
+	                                      "Delete", g_variant_new ("()"), G_VARIANT_TYPE ("(o)"),
+	                                      G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+	                                      cancellable, error);
+	if (retval == NULL) {
+		_secret_util_strip_remote_error (error);
+		return FALSE;
+	}
+
+	g_variant_get (retval, "(&o)", &prompt_path);
+
+	if (_secret_util_empty_path (prompt_path)) {
+		ret = TRUE;
+
+	} else {
+		prompt = _secret_prompt_instance (self, prompt_path);
+		result = secret_service_prompt_sync (self, prompt, cancellable, NULL, &local);
+		ret = (local == NULL);
+		if (local != NULL)
+			g_propagate_error (error, local);
+		if (result != NULL)
+			g_variant_unref (result);
+		g_object_unref (prompt);
+	}
+
+	g_variant_unref (retval);
+	return ret;
+}
+
+static void
+on_delete_paths_prompted (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = secret_service_prompt_finish (SECRET_SERVICE (source), result, &error);
+	if (error != NULL)
+		g_simple_async_result_take_error (res, error);
+	if (retval != NULL) {
+		closure->deleted += g_variant_n_children (retval);
+		g_variant_unref (retval);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (res);
+}
+
+static void
+on_delete_paths_complete (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	DeleteClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = SECRET_SERVICE (source);
+	const gchar *prompt_path;
+	GVariant *deleted;
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_proxy_call_finish (G_DBUS_PROXY (self), result, &error);
+	if (error == NULL) {
+		g_variant_get (retval, "(@ao&o)", &deleted, &prompt_path);
+		closure->deleted = g_variant_n_children (deleted);
+
+		if (_secret_util_empty_path (prompt_path)) {
+			g_simple_async_result_complete (res);
+
+		} else {
+			closure->prompt = _secret_prompt_instance (self, prompt_path);
+			secret_service_prompt (self, closure->prompt, G_VARIANT_TYPE ("ao"),
+			                       closure->cancellable,
+			                       on_delete_paths_prompted,
+			                       g_object_ref (res));
+		}
+
+		g_variant_unref (deleted);
+		g_variant_unref (retval);
+
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_object_unref (res);
+}
+
+void
+_secret_service_delete_paths (SecretService *self,
+                              const gchar **item_paths,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (item_paths != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 _secret_service_delete_paths);
+	closure = g_slice_new0 (DeleteClosure);
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	g_simple_async_result_set_op_res_gpointer (res, closure, delete_closure_free);
+
+	/* An extension, only used when advertised in the Capabilities property */
+	g_dbus_proxy_call (G_DBUS_PROXY (self), "DeleteItems",
+	                   g_variant_new ("(^ao)", item_paths),
+	                   G_DBUS_CALL_FLAGS_NO_AUTO_START, -1,
+	                   cancellable, on_delete_paths_complete, g_object_ref (res));
+
+	g_object_unref (res);
+}
+
+gint
+_secret_service_delete_paths_finish (SecretService *self,
+                                     GAsyncResult *result,
+                                     GError **error)
+{
+	GSimpleAsyncResult *res;
+	DeleteClosure *closure;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), -1);
+	g_return_val_if_fail (error == NULL || *error == NULL, -1);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      _secret_service_delete_paths), -1);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return -1;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	return closure->deleted;
+}
+
 /**
  * secret_service_delete_item_dbus_path: (skip)
  * @self: the secret service
@@ -1624,28 +1957,12 @@ secret_service_delete_item_dbus_path_sync (SecretService *self,
                                            GCancellable *cancellable,
                                            GError **error)
 {
-	SecretSync *sync;
-	gboolean result;
-
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (item_path != NULL, FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	sync = _secret_sync_new ();
-	g_main_context_push_thread_default (sync->context);
-
-	secret_service_delete_item_dbus_path (self, item_path, cancellable,
-	                                      _secret_sync_on_result, sync);
-
-	g_main_loop_run (sync->loop);
-
-	result = secret_service_delete_item_dbus_path_finish (self, sync->result, error);
-
-	g_main_context_pop_thread_default (sync->context);
-	_secret_sync_free (sync);
-
-	return result;
+	return _secret_service_delete_path_sync (self, item_path, TRUE, cancellable, error);
 }
 
 typedef struct {
@@ -1939,6 +2256,20 @@ item_closure_free (gpointer data)
 	g_slice_free (ItemClosure, closure);
 }
 
+static void
+create_item_forget_secret (SecretService *self,
+                           const gchar *item_path)
+{
+	SecretCache *cache;
+
+	/* An existing item may have been replaced */
+	cache = _secret_service_get_cache (self);
+	if (cache != NULL) {
+		_secret_cache_store_secret (cache, item_path, NULL, 0);
+		_secret_cache_unref (cache);
+	}
+}
+
 static void
 on_create_item_prompt (GObject *source,
                        GAsyncResult *result,
@@ -1954,6 +2285,7 @@ on_create_item_prompt (GObject *source,
 		g_simple_async_result_take_error (res, error);
 	if (value != NULL) {
 		closure->item_path = g_variant_dup_string (value, NULL);
+		create_item_forget_secret (SECRET_SERVICE (source), closure->item_path);
 		g_variant_unref (value);
 	}
 
@@ -1985,6 +2317,7 @@ on_create_item_called (GObject *source,
 
 		} else {
 			closure->item_path = g_strdup (item_path);
+			create_item_forget_secret (self, closure->item_path);
 			g_simple_async_result_complete (res);
 		}
 
@@ -1999,37 +2332,44 @@ on_create_item_called (GObject *source,
 	g_object_unref (res);
 }
 
+static void
+create_item_call (SecretService *self,
+                  GSimpleAsyncResult *res,
+                  SecretSession *session)
+{
+	ItemClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GVariant *params;
+	GDBusProxy *proxy;
+
+	params = g_variant_new ("(@a{sv}@(oayays)b)",
+	                        closure->properties,
+	                        _secret_session_encode_secret (session, closure->value),
+	                        closure->replace);
+
+	proxy = G_DBUS_PROXY (self);
+	g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+	                        g_dbus_proxy_get_name (proxy),
+	                        closure->collection_path,
+	                        SECRET_COLLECTION_INTERFACE,
+	                        "CreateItem", params, G_VARIANT_TYPE ("(oo)"),
+	                        G_DBUS_CALL_FLAGS_NONE, -1,
+	                        closure->cancellable,
+	                        on_create_item_called,
+	                        g_object_ref (res));
+}
+
 static void
 on_create_item_session (GObject *source,
                         GAsyncResult *result,
                         gpointer user_data)
 {
 	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-	ItemClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
 	SecretService *self = SECRET_SERVICE (source);
-	SecretSession *session;
-	GVariant *params;
 	GError *error = NULL;
-	GDBusProxy *proxy;
 
 	secret_service_ensure_session_finish (self, result, &error);
 	if (error == NULL) {
-		session = _secret_service_get_session (self);
-		params = g_variant_new ("(@a{sv}@(oayays)b)",
-		                        closure->properties,
-		                        _secret_session_encode_secret (session, closure->value),
-		                        closure->replace);
-
-		proxy = G_DBUS_PROXY (self);
-		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
-		                        g_dbus_proxy_get_name (proxy),
-		                        closure->collection_path,
-		                        SECRET_COLLECTION_INTERFACE,
-		                        "CreateItem", params, G_VARIANT_TYPE ("(oo)"),
-		                        G_DBUS_CALL_FLAGS_NONE, -1,
-		                        closure->cancellable,
-		                        on_create_item_called,
-		                        g_object_ref (res));
+		create_item_call (self, res, _secret_service_get_session (self));
 	} else {
 		g_simple_async_result_take_error (res, error);
 		g_simple_async_result_complete (res);
@@ -2084,6 +2424,7 @@ secret_service_create_item_dbus_path (SecretService *self,
 {
 	GSimpleAsyncResult *res;
 	ItemClosure *closure;
+	SecretSession *session;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (collection_path != NULL && g_variant_is_object_path (collection_path));
@@ -2102,9 +2443,15 @@ secret_service_create_item_dbus_path (SecretService *self,
 	closure->collection_path = g_strdup (collection_path);
 	g_simple_async_result_set_op_res_gpointer (res, closure, item_closure_free);
 
-	secret_service_ensure_session (self, cancellable,
-	                               on_create_item_session,
-	                               g_object_ref (res));
+	/* Encode with an already open session, without a round trip through the main loop */
+	session = _secret_service_get_session (self);
+	if (session != NULL) {
+		create_item_call (self, res, session);
+	} else {
+		secret_service_ensure_session (self, cancellable,
+		                               on_create_item_session,
+		                               g_object_ref (res));
+	}
 
 	g_object_unref (res);
 }
@@ -23,14 +23,25 @@
 
 G_BEGIN_DECLS
 
+typedef void (* SecretSyncFunc) (gpointer data,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data);
+
 typedef struct {
 	GAsyncResult *result;
 	GMainContext *context;
 	GMainLoop *loop;
+	gboolean io;
+	SecretSyncFunc func;
+	gpointer data;
+	GMutex mutex;
+	GCond cond;
 } SecretSync;
 
 typedef struct _SecretSession SecretSession;
 
+typedef struct _SecretCache SecretCache;
+
 #define              SECRET_ALIAS_PREFIX                      "/org/freedesktop/secrets/aliases/"
 
 #define              SECRET_SERVICE_PATH                      "/org/freedesktop/secrets"
@@ -52,10 +63,19 @@ typedef struct _SecretSession SecretSession;
 
 #define              SECRET_PROPERTIES_INTERFACE              "org.freedesktop.DBus.Properties"
 
+/* Optional extensions a service may list in its Capabilities property */
+#define              SECRET_CAPABILITY_LOOKUP_SECRET          "lookup-secret"
+#define              SECRET_CAPABILITY_DELETE_ITEMS           "delete-items"
+
 SecretSync *         _secret_sync_new                         (void);
 
 void                 _secret_sync_free                        (gpointer data);
 
+SecretSync *         _secret_sync_run                         (SecretSyncFunc func,
+                                                               gpointer data);
+
+void                 _secret_sync_set_io_thread               (gboolean enabled);
+
 void                 _secret_sync_on_result                   (GObject *source,
                                                                GAsyncResult *result,
                                                                gpointer user_data);
@@ -104,6 +124,20 @@ gboolean             _secret_util_get_properties_finish       (GDBusProxy *proxy
                                                                GAsyncResult *result,
                                                                GError **error);
 
+void                 _secret_util_load_properties             (GDBusProxy *proxy,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+void                 _secret_util_load_properties_finish      (GDBusProxy *proxy,
+                                                               GAsyncResult *result);
+
+void                 _secret_util_load_properties_sync        (GDBusProxy *proxy,
+                                                               GCancellable *cancellable);
+
+gboolean             _secret_util_seed_properties             (GDBusProxy *proxy,
+                                                               GHashTable *objects);
+
 void                 _secret_util_set_property                (GDBusProxy *proxy,
                                                                const gchar *property,
                                                                GVariant *value,
@@ -125,11 +159,62 @@ gboolean             _secret_util_set_property_sync           (GDBusProxy *proxy
 
 gboolean             _secret_util_have_cached_properties      (GDBusProxy *proxy);
 
+guint                _secret_util_max_in_flight               (void);
+
+void                 _secret_util_set_max_in_flight           (guint max_in_flight);
+
 SecretSession *      _secret_service_get_session              (SecretService *self);
 
+SecretCache *        _secret_service_get_cache                (SecretService *self);
+
 void                 _secret_service_take_session             (SecretService *self,
                                                                SecretSession *session);
 
+void                 _secret_service_get_session_stats        (SecretService *self,
+                                                               guint *opened,
+                                                               guint *coalesced);
+
+void                 _secret_service_register_proxy           (SecretService *self,
+                                                               GDBusProxy *proxy);
+
+void                 _secret_service_unregister_proxy         (SecretService *self,
+                                                               GDBusProxy *proxy);
+
+void                 _secret_service_set_proxy_reusable       (SecretService *self,
+                                                               GDBusProxy *proxy,
+                                                               gboolean reusable);
+
+GDBusProxy *         _secret_service_find_proxy               (SecretService *self,
+                                                               const gchar *object_path,
+                                                               GType type);
+
+void                 _secret_service_defer_properties         (SecretService *self,
+                                                               GDBusProxy *proxy);
+
+GList *              _secret_service_take_deferred            (SecretService *self,
+                                                               guint max);
+
+void                 _secret_service_get_dispatch_stats       (SecretService *self,
+                                                               guint *registered,
+                                                               guint *subscriptions,
+                                                               guint64 *dispatched);
+
+void                 _secret_service_get_managed_objects      (SecretService *self,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+GHashTable *         _secret_service_get_managed_objects_finish (SecretService *self,
+                                                                 GAsyncResult *result,
+                                                                 GError **error);
+
+GHashTable *         _secret_service_get_managed_objects_sync (SecretService *self,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
+gboolean             _secret_service_has_capability           (SecretService *self,
+                                                               const gchar *capability);
+
 void                 _secret_service_delete_path              (SecretService *self,
                                                                const gchar *object_path,
                                                                gboolean is_an_item,
@@ -141,6 +226,22 @@ gboolean             _secret_service_delete_path_finish       (SecretService *se
                                                                GAsyncResult *result,
                                                                GError **error);
 
+gboolean             _secret_service_delete_path_sync         (SecretService *self,
+                                                               const gchar *object_path,
+                                                               gboolean is_an_item,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
+void                 _secret_service_delete_paths             (SecretService *self,
+                                                               const gchar **item_paths,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+gint                 _secret_service_delete_paths_finish      (SecretService *self,
+                                                               GAsyncResult *result,
+                                                               GError **error);
+
 void                 _secret_service_search_for_paths_variant (SecretService *self,
                                                                GVariant *attributes,
                                                                GCancellable *cancellable,
@@ -179,16 +280,94 @@ GHashTable *         _secret_collection_properties_new        (const gchar *labe
 SecretItem *         _secret_collection_find_item_instance    (SecretCollection *self,
                                                                const gchar *item_path);
 
+void                 _secret_collection_new_for_objects       (SecretService *service,
+                                                               const gchar *collection_path,
+                                                               GHashTable *objects,
+                                                               SecretCollectionFlags flags,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+SecretCollection *   _secret_collection_new_for_objects_sync  (SecretService *service,
+                                                               const gchar *collection_path,
+                                                               GHashTable *objects,
+                                                               SecretCollectionFlags flags,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
 gchar *              _secret_value_unref_to_password          (SecretValue *value);
 
 gchar *              _secret_value_unref_to_string            (SecretValue *value);
 
+SecretCache *        _secret_cache_new                        (const gchar *bus_name);
+
+SecretCache *        _secret_cache_ref                        (SecretCache *cache);
+
+void                 _secret_cache_unref                      (gpointer cache);
+
+void                 _secret_cache_enable_searches            (SecretCache *cache);
+
+gboolean             _secret_cache_caches_searches            (SecretCache *cache);
+
+gboolean             _secret_cache_lookup_search              (SecretCache *cache,
+                                                               GVariant *attributes,
+                                                               GVariant **reply,
+                                                               guint64 *generation);
+
+void                 _secret_cache_store_search               (SecretCache *cache,
+                                                               GVariant *attributes,
+                                                               GVariant *reply,
+                                                               guint64 generation);
+
+void                 _secret_cache_get_search_stats           (SecretCache *cache,
+                                                               guint64 *hits,
+                                                               guint64 *misses,
+                                                               guint64 *invalidations);
+
+void                 _secret_cache_set_secret_policy          (SecretCache *cache,
+                                                               gssize max_bytes,
+                                                               guint max_age);
+
+gboolean             _secret_cache_caches_secrets             (SecretCache *cache);
+
+guint64              _secret_cache_get_generation             (SecretCache *cache);
+
+SecretValue *        _secret_cache_lookup_secret              (SecretCache *cache,
+                                                               const gchar *path,
+                                                               guint64 *generation);
+
+gboolean             _secret_cache_contains_secret            (SecretCache *cache,
+                                                               const gchar *path);
+
+void                 _secret_cache_store_secret               (SecretCache *cache,
+                                                               const gchar *path,
+                                                               SecretValue *value,
+                                                               guint64 generation);
+
+void                 _secret_cache_get_secret_stats           (SecretCache *cache,
+                                                               guint64 *hits,
+                                                               guint64 *misses,
+                                                               guint64 *evictions,
+                                                               gsize *bytes);
+
+void                 _secret_cache_process_message            (SecretCache *cache,
+                                                               GDBusMessage *message);
+
 void                 _secret_session_free                     (gpointer data);
 
 const gchar *        _secret_session_get_algorithms           (SecretSession *session);
 
 const gchar *        _secret_session_get_path                 (SecretSession *session);
 
+void                 _secret_session_pregenerate              (void);
+
+void                 _secret_session_set_pregenerate          (gboolean enabled);
+
+void                 _secret_session_get_pregenerate_stats    (guint *taken,
+                                                               guint *missed,
+                                                               gboolean *pending,
+                                                               gboolean *ready);
+
 void                 _secret_session_open                     (SecretService *service,
                                                                GCancellable *cancellable,
                                                                GAsyncReadyCallback callback,
@@ -203,9 +382,30 @@ GVariant *           _secret_session_encode_secret            (SecretSession *se
 SecretValue *        _secret_session_decode_secret            (SecretSession *session,
                                                                GVariant *encoded);
 
+void                 _secret_session_decode_secrets           (SecretSession *session,
+                                                               GVariant **encoded,
+                                                               SecretValue **decoded,
+                                                               gsize count,
+                                                               gsize n_total);
+
 void                 _secret_item_set_cached_secret           (SecretItem *self,
                                                                SecretValue *value);
 
+void                 _secret_item_new_for_objects             (SecretService *service,
+                                                               const gchar *item_path,
+                                                               GHashTable *objects,
+                                                               SecretItemFlags flags,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+SecretItem *         _secret_item_new_for_objects_sync        (SecretService *service,
+                                                               const gchar *item_path,
+                                                               GHashTable *objects,
+                                                               SecretItemFlags flags,
+                                                               GCancellable *cancellable,
+                                                               GError **error);
+
 const SecretSchema * _secret_schema_ref_if_nonstatic          (const SecretSchema *schema);
 
 void                 _secret_schema_unref_if_nonstatic        (const SecretSchema *schema);
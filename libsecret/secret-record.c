@@ -0,0 +1,1242 @@
+/* libsecret - GLib wrapper for Secret Service
+ *
+ * Copyright 2012 Red Hat Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the licence or (at
+ * your option) any later version.
+ *
+ * See the included COPYING file for more information.
+ */
+
+#include "config.h"
+
+#include "secret-attributes.h"
+#include "secret-collection.h"
+#include "secret-paths.h"
+#include "secret-private.h"
+#include "secret-record.h"
+#include "secret-service.h"
+#include "secret-types.h"
+#include "secret-value.h"
+
+/**
+ * SECTION:secret-record
+ * @title: SecretRecord
+ * @short_description: a lightweight search result
+ *
+ * A #SecretRecord is a snapshot of a secret item, as returned by
+ * secret_service_search_records(). It contains the item's D-Bus path,
+ * label, attributes, dates and locked state, and optionally its secret.
+ *
+ * Unlike #SecretItem, a #SecretRecord is not a D-Bus proxy. It does not
+ * track changes to the item, and it cannot be used to modify the item.
+ * Creating one needs no more than a Properties.GetAll call per item, which
+ * makes it suitable for callers that look through many items.
+ *
+ * #SecretRecord is reference counted and immutable.
+ *
+ * Stability: Unstable
+ */
+
+/**
+ * SecretRecord:
+ *
+ * A snapshot of a secret item returned from a search.
+ */
+
+struct _SecretRecord {
+	gint refs;
+	gchar *path;
+	gchar *label;
+	GVariant *attributes;
+	guint64 created;
+	guint64 modified;
+	gboolean locked;
+	SecretValue *secret;
+};
+
+GType
+secret_record_get_type (void)
+{
+	static gsize initialized = 0;
+	static GType type = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		type = g_boxed_type_register_static ("SecretRecord",
+		                                     (GBoxedCopyFunc)secret_record_ref,
+		                                     (GBoxedFreeFunc)secret_record_unref);
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return type;
+}
+
+static SecretRecord *
+record_new (const gchar *path,
+            GVariant *properties,
+            SecretValue *secret)
+{
+	SecretRecord *record;
+
+	record = g_slice_new0 (SecretRecord);
+	record->refs = 1;
+	record->path = g_strdup (path);
+
+	g_variant_lookup (properties, "Label", "s", &record->label);
+	g_variant_lookup (properties, "Created", "t", &record->created);
+	g_variant_lookup (properties, "Modified", "t", &record->modified);
+	g_variant_lookup (properties, "Locked", "b", &record->locked);
+	record->attributes = g_variant_lookup_value (properties, "Attributes",
+	                                             G_VARIANT_TYPE ("a{ss}"));
+
+	if (secret != NULL)
+		record->secret = secret_value_ref (secret);
+
+	return record;
+}
+
+/**
+ * secret_record_get_dbus_path:
+ * @record: the record
+ *
+ * Get the D-Bus object path of the item this record describes.
+ *
+ * Returns: the object path
+ */
+const gchar *
+secret_record_get_dbus_path (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, NULL);
+	return record->path;
+}
+
+/**
+ * secret_record_get_label:
+ * @record: the record
+ *
+ * Get the label of the item.
+ *
+ * Returns: (allow-none): the label
+ */
+const gchar *
+secret_record_get_label (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, NULL);
+	return record->label;
+}
+
+/**
+ * secret_record_get_attributes:
+ * @record: the record
+ *
+ * Get the attributes of the item.
+ *
+ * Returns: (transfer full) (element-type utf8 utf8): a new hash table
+ *          of the attributes, released with g_hash_table_unref()
+ */
+GHashTable *
+secret_record_get_attributes (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, NULL);
+
+	if (record->attributes == NULL)
+		return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	return _secret_attributes_for_variant (record->attributes);
+}
+
+/**
+ * secret_record_get_schema_name:
+ * @record: the record
+ *
+ * Get the name of the schema that the item was stored with. This is also
+ * available at the <literal>xdg:schema</literal> attribute.
+ *
+ * Returns: (transfer full) (allow-none): the schema name
+ */
+gchar *
+secret_record_get_schema_name (SecretRecord *record)
+{
+	gchar *schema_name = NULL;
+
+	g_return_val_if_fail (record != NULL, NULL);
+
+	if (record->attributes != NULL)
+		g_variant_lookup (record->attributes, "xdg:schema", "s", &schema_name);
+
+	return schema_name;
+}
+
+/**
+ * secret_record_get_created:
+ * @record: the record
+ *
+ * Get the date and time (in seconds since the UNIX epoch) that the item
+ * was created.
+ *
+ * Returns: the creation date
+ */
+guint64
+secret_record_get_created (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, 0);
+	return record->created;
+}
+
+/**
+ * secret_record_get_modified:
+ * @record: the record
+ *
+ * Get the date and time (in seconds since the UNIX epoch) that the item
+ * was last modified.
+ *
+ * Returns: the modified date
+ */
+guint64
+secret_record_get_modified (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, 0);
+	return record->modified;
+}
+
+/**
+ * secret_record_get_locked:
+ * @record: the record
+ *
+ * Get whether the item was locked when the record was made.
+ *
+ * Returns: whether the item was locked
+ */
+gboolean
+secret_record_get_locked (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, FALSE);
+	return record->locked;
+}
+
+/**
+ * secret_record_get_secret:
+ * @record: the record
+ *
+ * Get the secret value of the item. This is only available if
+ * %SECRET_SEARCH_LOAD_SECRETS was used, and the item was unlocked.
+ *
+ * Returns: (transfer none) (allow-none): the secret value
+ */
+SecretValue *
+secret_record_get_secret (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, NULL);
+	return record->secret;
+}
+
+/**
+ * secret_record_ref:
+ * @record: record to reference
+ *
+ * Add another reference to the #SecretRecord.
+ *
+ * Returns: (transfer full): the record
+ */
+SecretRecord *
+secret_record_ref (SecretRecord *record)
+{
+	g_return_val_if_fail (record != NULL, NULL);
+	g_atomic_int_inc (&record->refs);
+	return record;
+}
+
+/**
+ * secret_record_unref:
+ * @record: (type Secret.Record): record to unreference
+ *
+ * Unreference a #SecretRecord. When the last reference is gone, then
+ * the record will be freed.
+ */
+void
+secret_record_unref (gpointer record)
+{
+	SecretRecord *rec = record;
+
+	g_return_if_fail (record != NULL);
+
+	if (g_atomic_int_dec_and_test (&rec->refs)) {
+		g_free (rec->path);
+		g_free (rec->label);
+		if (rec->attributes)
+			g_variant_unref (rec->attributes);
+		if (rec->secret)
+			secret_value_unref (rec->secret);
+		g_slice_free (SecretRecord, rec);
+	}
+}
+
+typedef struct {
+	SecretService *service;
+	GCancellable *cancellable;
+	GVariant *attributes;
+	SecretSearchFlags flags;
+	GPtrArray *paths;
+	GVariant **properties;
+	guint next;
+	guint loading;
+	gboolean failed;
+	GHashTable *secrets;
+	GPtrArray *records;
+	guint limit;
+	SecretRecordFunc func;
+	gpointer func_data;
+	GDestroyNotify func_destroy;
+	gboolean stopped;
+	guint emitted;
+} RecordsClosure;
+
+typedef struct {
+	GSimpleAsyncResult *res;
+	guint index;
+	GVariant *properties;
+} RecordsCall;
+
+static void
+records_closure_free (gpointer data)
+{
+	RecordsClosure *closure = data;
+	guint i;
+
+	g_clear_object (&closure->service);
+	g_clear_object (&closure->cancellable);
+	g_variant_unref (closure->attributes);
+	if (closure->properties) {
+		for (i = 0; i < closure->paths->len; i++) {
+			if (closure->properties[i])
+				g_variant_unref (closure->properties[i]);
+		}
+		g_free (closure->properties);
+	}
+	if (closure->paths)
+		g_ptr_array_unref (closure->paths);
+	if (closure->secrets)
+		g_hash_table_unref (closure->secrets);
+	if (closure->records)
+		g_ptr_array_unref (closure->records);
+	if (closure->func_destroy)
+		(closure->func_destroy) (closure->func_data);
+	g_slice_free (RecordsClosure, closure);
+}
+
+static void
+records_complete (GSimpleAsyncResult *res)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretValue *secret;
+	const gchar *path;
+	guint i;
+
+	closure->records = g_ptr_array_new_with_free_func (secret_record_unref);
+	for (i = 0; i < closure->paths->len; i++) {
+		path = closure->paths->pdata[i];
+		secret = closure->secrets ? g_hash_table_lookup (closure->secrets, path) : NULL;
+		g_ptr_array_add (closure->records,
+		                 record_new (path, closure->properties[i], secret));
+	}
+
+	g_simple_async_result_complete (res);
+}
+
+static void
+on_records_secrets (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	/* Note that we ignore any failure to load secrets, like searching does */
+	closure->secrets = secret_service_get_secrets_for_dbus_paths_finish (closure->service,
+	                                                                     result, NULL);
+
+	records_complete (res);
+	g_object_unref (res);
+}
+
+static void
+records_load_secrets (GSimpleAsyncResult *res)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GPtrArray *unlocked;
+	gboolean locked;
+	guint i;
+
+	unlocked = g_ptr_array_new ();
+	if (closure->flags & SECRET_SEARCH_LOAD_SECRETS) {
+		for (i = 0; i < closure->paths->len; i++) {
+			locked = TRUE;
+			g_variant_lookup (closure->properties[i], "Locked", "b", &locked);
+			if (!locked)
+				g_ptr_array_add (unlocked, closure->paths->pdata[i]);
+		}
+	}
+
+	/* All the secrets in one GetSecrets call */
+	if (unlocked->len > 0) {
+		g_ptr_array_add (unlocked, NULL);
+		secret_service_get_secrets_for_dbus_paths (closure->service,
+		                                           (const gchar **)unlocked->pdata,
+		                                           closure->cancellable,
+		                                           on_records_secrets,
+		                                           g_object_ref (res));
+	} else {
+		records_complete (res);
+	}
+
+	g_ptr_array_free (unlocked, TRUE);
+}
+
+static void
+records_load_next (GSimpleAsyncResult *res);
+
+static void
+records_emit (RecordsClosure *closure,
+              guint index,
+              GVariant *properties,
+              SecretValue *secret)
+{
+	SecretRecord *record;
+
+	if (closure->stopped)
+		return;
+
+	record = record_new (closure->paths->pdata[index], properties, secret);
+	closure->emitted++;
+
+	if (!(closure->func) (record, closure->func_data))
+		closure->stopped = TRUE;
+	if (closure->limit > 0 && closure->emitted >= closure->limit)
+		closure->stopped = TRUE;
+
+	/* Don't start loading anything else */
+	if (closure->stopped)
+		closure->next = closure->paths->len;
+
+	secret_record_unref (record);
+}
+
+static void
+records_call_done (RecordsCall *call)
+{
+	GSimpleAsyncResult *res = call->res;
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	closure->loading--;
+	records_load_next (res);
+
+	if (closure->loading == 0) {
+		if (closure->failed || closure->func)
+			g_simple_async_result_complete (res);
+		else
+			records_load_secrets (res);
+	}
+
+	if (call->properties)
+		g_variant_unref (call->properties);
+	g_object_unref (res);
+	g_slice_free (RecordsCall, call);
+}
+
+static void
+on_records_stream_secret (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	RecordsCall *call = user_data;
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (call->res);
+	SecretValue *secret;
+
+	/* Note that we ignore any failure to load secrets, like searching does */
+	secret = secret_service_get_secret_for_dbus_path_finish (closure->service,
+	                                                         result, NULL);
+
+	records_emit (closure, call->index, call->properties, secret);
+	if (secret)
+		secret_value_unref (secret);
+
+	records_call_done (call);
+}
+
+static void
+on_records_properties (GObject *source,
+                       GAsyncResult *result,
+                       gpointer user_data)
+{
+	RecordsCall *call = user_data;
+	GSimpleAsyncResult *res = call->res;
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	GVariant *retval;
+	gboolean locked;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (error != NULL) {
+		if (!closure->failed) {
+			_secret_util_strip_remote_error (&error);
+			g_simple_async_result_take_error (res, error);
+		} else {
+			g_error_free (error);
+		}
+
+		/* No point in loading the rest */
+		closure->failed = TRUE;
+		closure->next = closure->paths->len;
+
+	} else if (closure->func) {
+		call->properties = g_variant_get_child_value (retval, 0);
+		g_variant_unref (retval);
+
+		locked = TRUE;
+		g_variant_lookup (call->properties, "Locked", "b", &locked);
+
+		/* Each record goes out as soon as it's complete */
+		if (!closure->stopped && !locked &&
+		    (closure->flags & SECRET_SEARCH_LOAD_SECRETS)) {
+			secret_service_get_secret_for_dbus_path (closure->service,
+			                                         closure->paths->pdata[call->index],
+			                                         closure->cancellable,
+			                                         on_records_stream_secret, call);
+			return;
+		}
+
+		records_emit (closure, call->index, call->properties, NULL);
+
+	} else {
+		closure->properties[call->index] = g_variant_get_child_value (retval, 0);
+		g_variant_unref (retval);
+	}
+
+	records_call_done (call);
+}
+
+static void
+records_load_next (GSimpleAsyncResult *res)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	guint max_in_flight = _secret_util_max_in_flight ();
+	GDBusProxy *proxy = G_DBUS_PROXY (closure->service);
+	RecordsCall *call;
+
+	/* Fetch the properties directly, without creating a proxy for each item */
+	while (closure->loading < max_in_flight && closure->next < closure->paths->len) {
+		call = g_slice_new0 (RecordsCall);
+		call->res = g_object_ref (res);
+		call->index = closure->next++;
+
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy),
+		                        closure->paths->pdata[call->index],
+		                        SECRET_PROPERTIES_INTERFACE, "GetAll",
+		                        g_variant_new ("(s)", SECRET_ITEM_INTERFACE),
+		                        G_VARIANT_TYPE ("(a{sv})"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1,
+		                        closure->cancellable,
+		                        on_records_properties, call);
+		closure->loading++;
+	}
+}
+
+static void
+records_load_properties (GSimpleAsyncResult *res)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	closure->properties = g_new0 (GVariant *, closure->paths->len);
+
+	if (closure->paths->len == 0)
+		records_complete (res);
+	else
+		records_load_next (res);
+}
+
+static void
+on_records_unlocked (GObject *source,
+                     GAsyncResult *result,
+                     gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+
+	/* Note that we ignore any unlock failure */
+	secret_service_unlock_dbus_paths_finish (closure->service, result, NULL, NULL);
+
+	records_load_properties (res);
+	g_object_unref (res);
+}
+
+static void
+records_take_paths (GSimpleAsyncResult *res,
+                    gchar **unlocked,
+                    gchar **locked)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GPtrArray *to_unlock;
+	guint want = 1;
+	guint i;
+
+	if (closure->flags & SECRET_SEARCH_ALL)
+		want = G_MAXUINT;
+	if (closure->limit > 0)
+		want = MIN (want, closure->limit);
+
+	closure->paths = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; closure->paths->len < want && unlocked[i] != NULL; i++)
+		g_ptr_array_add (closure->paths, g_strdup (unlocked[i]));
+
+	to_unlock = g_ptr_array_new ();
+	for (i = 0; closure->paths->len < want && locked[i] != NULL; i++) {
+		g_ptr_array_add (closure->paths, g_strdup (locked[i]));
+		g_ptr_array_add (to_unlock, locked[i]);
+	}
+
+	if ((closure->flags & SECRET_SEARCH_UNLOCK) && to_unlock->len > 0) {
+		g_ptr_array_add (to_unlock, NULL);
+		secret_service_unlock_dbus_paths (closure->service,
+		                                  (const gchar **)to_unlock->pdata,
+		                                  closure->cancellable,
+		                                  on_records_unlocked,
+		                                  g_object_ref (res));
+	} else {
+		records_load_properties (res);
+	}
+
+	g_ptr_array_free (to_unlock, TRUE);
+}
+
+static void
+on_records_paths (GObject *source,
+                  GAsyncResult *result,
+                  gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+	gchar **unlocked = NULL;
+	gchar **locked = NULL;
+
+	secret_service_search_for_dbus_paths_finish (closure->service, result,
+	                                             &unlocked, &locked, &error);
+	if (error == NULL) {
+		records_take_paths (res, unlocked, locked);
+
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (unlocked);
+	g_strfreev (locked);
+	g_object_unref (res);
+}
+
+static void
+on_records_collection_paths (GObject *source,
+                             GAsyncResult *result,
+                             gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretCollection *collection = SECRET_COLLECTION (source);
+	GError *error = NULL;
+	gchar *none[] = { NULL };
+	gchar **paths;
+
+	paths = secret_collection_search_for_dbus_paths_finish (collection, result, &error);
+	if (error == NULL) {
+		/* The items in a collection are locked along with it */
+		if (secret_collection_get_locked (collection))
+			records_take_paths (res, none, paths);
+		else
+			records_take_paths (res, paths, none);
+
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_strfreev (paths);
+	g_object_unref (res);
+}
+
+static void
+on_records_service (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	GError *error = NULL;
+
+	closure->service = secret_service_get_finish (result, &error);
+	if (error == NULL) {
+		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
+		                                          closure->cancellable, on_records_paths,
+		                                          g_object_ref (res));
+
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	g_object_unref (res);
+}
+
+static void
+records_begin (GSimpleAsyncResult *res,
+               SecretService *service,
+               SecretCollection *collection,
+               const SecretSchema *schema,
+               GHashTable *attributes,
+               SecretSearchFlags flags,
+               GCancellable *cancellable)
+{
+	RecordsClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	const gchar *schema_name = NULL;
+
+	if (closure == NULL) {
+		closure = g_slice_new0 (RecordsClosure);
+		g_simple_async_result_set_op_res_gpointer (res, closure, records_closure_free);
+	}
+
+	if (schema != NULL && !(schema->flags & SECRET_SCHEMA_DONT_MATCH_NAME))
+		schema_name = schema->name;
+
+	closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	closure->flags = flags;
+	closure->attributes = _secret_attributes_to_variant (attributes, schema_name);
+	g_variant_ref_sink (closure->attributes);
+
+	/* Only the items in the collection, with its SearchItems method */
+	if (collection) {
+		closure->service = g_object_ref (secret_collection_get_service (collection));
+		secret_collection_search_for_dbus_paths (collection, schema, attributes,
+		                                         closure->cancellable,
+		                                         on_records_collection_paths,
+		                                         g_object_ref (res));
+
+	} else if (service) {
+		closure->service = g_object_ref (service);
+		_secret_service_search_for_paths_variant (closure->service, closure->attributes,
+		                                          closure->cancellable, on_records_paths,
+		                                          g_object_ref (res));
+
+	} else {
+		secret_service_get (SECRET_SERVICE_NONE, cancellable,
+		                    on_records_service, g_object_ref (res));
+	}
+}
+
+/**
+ * secret_service_search_records:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to pass to the callback
+ *
+ * Search for items matching the @attributes, and return a #SecretRecord
+ * for each of them. This is like secret_service_search(), but no
+ * #SecretItem proxies are created, which is much cheaper when there are
+ * many results.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * The @flags have the same meaning as for secret_service_search(). With
+ * %SECRET_SEARCH_LOAD_SECRETS, the secrets of all the unlocked items are
+ * retrieved in a single call.
+ *
+ * This function returns immediately and completes asynchronously.
+ *
+ * Stability: Unstable
+ */
+void
+secret_service_search_records (SecretService *service,
+                               const SecretSchema *schema,
+                               GHashTable *attributes,
+                               SecretSearchFlags flags,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+
+	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return;
+
+	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
+	                                 secret_service_search_records);
+	records_begin (res, service, NULL, schema, attributes, flags, cancellable);
+	g_object_unref (res);
+}
+
+/**
+ * secret_service_search_records_finish:
+ * @service: (allow-none): the secret service
+ * @result: asynchronous result passed to callback
+ * @error: location to place error on failure
+ *
+ * Complete asynchronous operation to search for item records.
+ *
+ * Stability: Unstable
+ *
+ * Returns: (transfer full) (element-type Secret.Record): an array of
+ *          records for the items that matched the search, unlocked
+ *          items first, released with g_ptr_array_unref()
+ */
+GPtrArray *
+secret_service_search_records_finish (SecretService *service,
+                                      GAsyncResult *result,
+                                      GError **error)
+{
+	GSimpleAsyncResult *res;
+	RecordsClosure *closure;
+	GPtrArray *records;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                      secret_service_search_records), NULL);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return NULL;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	records = closure->records;
+	closure->records = NULL;
+	return records;
+}
+
+/**
+ * secret_service_search_records_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @cancellable: optional cancellation object
+ * @error: location to place error on failure
+ *
+ * Search for items matching the @attributes, and return a #SecretRecord
+ * for each of them. This is like secret_service_search_sync(), but no
+ * #SecretItem proxies are created, which is much cheaper when there are
+ * many results.
+ *
+ * If @service is NULL, then secret_service_get_sync() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This function may block indefinetely. Use the asynchronous version
+ * in user interface threads.
+ *
+ * Stability: Unstable
+ *
+ * Returns: (transfer full) (element-type Secret.Record): an array of
+ *          records for the items that matched the search, unlocked
+ *          items first, released with g_ptr_array_unref()
+ */
+GPtrArray *
+secret_service_search_records_sync (SecretService *service,
+                                    const SecretSchema *schema,
+                                    GHashTable *attributes,
+                                    SecretSearchFlags flags,
+                                    GCancellable *cancellable,
+                                    GError **error)
+{
+	SecretSync *sync;
+	GPtrArray *records;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (attributes != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return NULL;
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_service_search_records (service, schema, attributes, flags, cancellable,
+	                               _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	records = secret_service_search_records_finish (service, sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return records;
+}
+
+/**
+ * SecretRecordFunc:
+ * @record: the record for a matching item
+ * @user_data: data passed to the streaming search
+ *
+ * Called by secret_service_search_records_stream() or
+ * secret_collection_search_records_stream() for each record as soon as
+ * it has been loaded. The @record is only valid for the duration
+ * of the call, use secret_record_ref() to keep it.
+ *
+ * Returns: %FALSE to stop the search, %TRUE to continue
+ */
+
+/**
+ * secret_service_search_records_stream:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @limit: the maximum number of records to emit, or zero for no limit
+ * @func: (scope notified) (closure func_data): called for each record
+ * @func_data: data to pass to @func
+ * @func_destroy: (allow-none): called to free @func_data
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to pass to the callback
+ *
+ * Search for items matching the @attributes, and call @func with a
+ * #SecretRecord for each of them as soon as it has been loaded. This is
+ * like secret_service_search_records(), but the caller does not have to
+ * wait for all the results before seeing the first one.
+ *
+ * Records are emitted in the order they finish loading, which is not
+ * necessarily the order the service returned them in. With
+ * %SECRET_SEARCH_LOAD_SECRETS each unlocked record is emitted once its
+ * secret has been retrieved.
+ *
+ * No more records are loaded once @limit records have been emitted, or
+ * once @func returns %FALSE. Note that @limit only has an effect together
+ * with %SECRET_SEARCH_ALL.
+ *
+ * If @service is NULL, then secret_service_get() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This function returns immediately and completes asynchronously.
+ *
+ * Stability: Unstable
+ */
+void
+secret_service_search_records_stream (SecretService *service,
+                                      const SecretSchema *schema,
+                                      GHashTable *attributes,
+                                      SecretSearchFlags flags,
+                                      guint limit,
+                                      SecretRecordFunc func,
+                                      gpointer func_data,
+                                      GDestroyNotify func_destroy,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	RecordsClosure *closure;
+
+	g_return_if_fail (service == NULL || SECRET_IS_SERVICE (service));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (func != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return;
+
+	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
+	                                 secret_service_search_records_stream);
+	closure = g_slice_new0 (RecordsClosure);
+	closure->limit = limit;
+	closure->func = func;
+	closure->func_data = func_data;
+	closure->func_destroy = func_destroy;
+	g_simple_async_result_set_op_res_gpointer (res, closure, records_closure_free);
+
+	records_begin (res, service, NULL, schema, attributes, flags, cancellable);
+	g_object_unref (res);
+}
+
+/**
+ * secret_service_search_records_stream_finish:
+ * @service: (allow-none): the secret service
+ * @result: asynchronous result passed to callback
+ * @error: location to place error on failure
+ *
+ * Complete asynchronous operation to stream item records.
+ *
+ * Stability: Unstable
+ *
+ * Returns: the number of records passed to the callback, or zero if
+ *          there was an error
+ */
+guint
+secret_service_search_records_stream_finish (SecretService *service,
+                                             GAsyncResult *result,
+                                             GError **error)
+{
+	GSimpleAsyncResult *res;
+	RecordsClosure *closure;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service),
+	                      secret_service_search_records_stream), 0);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return 0;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	return closure->emitted;
+}
+
+/**
+ * secret_service_search_records_stream_sync:
+ * @service: (allow-none): the secret service
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @limit: the maximum number of records to emit, or zero for no limit
+ * @func: (scope call) (closure func_data): called for each record
+ * @func_data: data to pass to @func
+ * @cancellable: optional cancellation object
+ * @error: location to place error on failure
+ *
+ * Search for items matching the @attributes, and call @func with a
+ * #SecretRecord for each of them as soon as it has been loaded. See
+ * secret_service_search_records_stream() for details.
+ *
+ * @func is called in the calling thread, before this function returns.
+ *
+ * If @service is NULL, then secret_service_get_sync() will be called to get
+ * the default #SecretService proxy.
+ *
+ * This function may block indefinetely. Use the asynchronous version
+ * in user interface threads.
+ *
+ * Stability: Unstable
+ *
+ * Returns: the number of records passed to @func, or zero if there was
+ *          an error
+ */
+guint
+secret_service_search_records_stream_sync (SecretService *service,
+                                           const SecretSchema *schema,
+                                           GHashTable *attributes,
+                                           SecretSearchFlags flags,
+                                           guint limit,
+                                           SecretRecordFunc func,
+                                           gpointer func_data,
+                                           GCancellable *cancellable,
+                                           GError **error)
+{
+	SecretSync *sync;
+	guint emitted;
+
+	g_return_val_if_fail (service == NULL || SECRET_IS_SERVICE (service), 0);
+	g_return_val_if_fail (attributes != NULL, 0);
+	g_return_val_if_fail (func != NULL, 0);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return 0;
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_service_search_records_stream (service, schema, attributes, flags, limit,
+	                                      func, func_data, NULL, cancellable,
+	                                      _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	emitted = secret_service_search_records_stream_finish (service, sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return emitted;
+}
+
+/**
+ * secret_collection_search_records_stream:
+ * @collection: the secret collection
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @limit: the maximum number of records to emit, or zero for no limit
+ * @func: (scope notified) (closure func_data): called for each record
+ * @func_data: data to pass to @func
+ * @func_destroy: (allow-none): called to free @func_data
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to pass to the callback
+ *
+ * Search for items in @collection matching the @attributes, and call @func
+ * with a #SecretRecord for each of them as soon as it has been loaded. Only
+ * the specified collection is searched. This is like
+ * secret_collection_search(), but no #SecretItem proxies are created, and
+ * the caller does not have to wait for all the results before seeing the
+ * first one.
+ *
+ * See secret_service_search_records_stream() for how @flags and @limit
+ * are handled.
+ *
+ * This function returns immediately and completes asynchronously.
+ *
+ * Stability: Unstable
+ */
+void
+secret_collection_search_records_stream (SecretCollection *collection,
+                                         const SecretSchema *schema,
+                                         GHashTable *attributes,
+                                         SecretSearchFlags flags,
+                                         guint limit,
+                                         SecretRecordFunc func,
+                                         gpointer func_data,
+                                         GDestroyNotify func_destroy,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	RecordsClosure *closure;
+
+	g_return_if_fail (SECRET_IS_COLLECTION (collection));
+	g_return_if_fail (attributes != NULL);
+	g_return_if_fail (func != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return;
+
+	res = g_simple_async_result_new (G_OBJECT (collection), callback, user_data,
+	                                 secret_collection_search_records_stream);
+	closure = g_slice_new0 (RecordsClosure);
+	closure->limit = limit;
+	closure->func = func;
+	closure->func_data = func_data;
+	closure->func_destroy = func_destroy;
+	g_simple_async_result_set_op_res_gpointer (res, closure, records_closure_free);
+
+	records_begin (res, NULL, collection, schema, attributes, flags, cancellable);
+	g_object_unref (res);
+}
+
+/**
+ * secret_collection_search_records_stream_finish:
+ * @collection: the secret collection
+ * @result: asynchronous result passed to callback
+ * @error: location to place error on failure
+ *
+ * Complete asynchronous operation to stream item records from a collection.
+ *
+ * Stability: Unstable
+ *
+ * Returns: the number of records passed to the callback, or zero if
+ *          there was an error
+ */
+guint
+secret_collection_search_records_stream_finish (SecretCollection *collection,
+                                                GAsyncResult *result,
+                                                GError **error)
+{
+	GSimpleAsyncResult *res;
+	RecordsClosure *closure;
+
+	g_return_val_if_fail (SECRET_IS_COLLECTION (collection), 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (collection),
+	                      secret_collection_search_records_stream), 0);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return 0;
+
+	closure = g_simple_async_result_get_op_res_gpointer (res);
+	return closure->emitted;
+}
+
+/**
+ * secret_collection_search_records_stream_sync:
+ * @collection: the secret collection
+ * @schema: (allow-none): the schema for the attributes
+ * @attributes: (element-type utf8 utf8): search for items matching these attributes
+ * @flags: search option flags
+ * @limit: the maximum number of records to emit, or zero for no limit
+ * @func: (scope call) (closure func_data): called for each record
+ * @func_data: data to pass to @func
+ * @cancellable: optional cancellation object
+ * @error: location to place error on failure
+ *
+ * Search for items in @collection matching the @attributes, and call @func
+ * with a #SecretRecord for each of them as soon as it has been loaded. See
+ * secret_collection_search_records_stream() for details.
+ *
+ * @func is called in the calling thread, before this function returns.
+ *
+ * This function may block indefinetely. Use the asynchronous version
+ * in user interface threads.
+ *
+ * Stability: Unstable
+ *
+ * Returns: the number of records passed to @func, or zero if there was
+ *          an error
+ */
+guint
+secret_collection_search_records_stream_sync (SecretCollection *collection,
+                                              const SecretSchema *schema,
+                                              GHashTable *attributes,
+                                              SecretSearchFlags flags,
+                                              guint limit,
+                                              SecretRecordFunc func,
+                                              gpointer func_data,
+                                              GCancellable *cancellable,
+                                              GError **error)
+{
+	SecretSync *sync;
+	guint emitted;
+
+	g_return_val_if_fail (SECRET_IS_COLLECTION (collection), 0);
+	g_return_val_if_fail (attributes != NULL, 0);
+	g_return_val_if_fail (func != NULL, 0);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+
+	/* Warnings raised already */
+	if (schema != NULL && !_secret_attributes_validate (schema, attributes, G_STRFUNC, TRUE))
+		return 0;
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	secret_collection_search_records_stream (collection, schema, attributes, flags, limit,
+	                                         func, func_data, NULL, cancellable,
+	                                         _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	emitted = secret_collection_search_records_stream_finish (collection, sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return emitted;
+}
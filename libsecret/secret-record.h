@@ -0,0 +1,132 @@
+/* libsecret - GLib wrapper for Secret Service
+ *
+ * Copyright 2012 Red Hat Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the licence or (at
+ * your option) any later version.
+ *
+ * See the included COPYING file for more information.
+ */
+
+#if !defined (__SECRET_INSIDE_HEADER__) && !defined (SECRET_COMPILATION)
+#error "Only <libsecret/secret.h> can be included directly."
+#endif
+
+#ifndef __SECRET_RECORD_H__
+#define __SECRET_RECORD_H__
+
+#include <gio/gio.h>
+
+#include "secret-collection.h"
+#include "secret-schema.h"
+#include "secret-service.h"
+#include "secret-types.h"
+#include "secret-value.h"
+
+G_BEGIN_DECLS
+
+typedef struct _SecretRecord  SecretRecord;
+
+typedef gboolean    (* SecretRecordFunc)                        (SecretRecord *record,
+                                                                 gpointer user_data);
+
+#define             SECRET_TYPE_RECORD                          (secret_record_get_type ())
+
+GType               secret_record_get_type                      (void) G_GNUC_CONST;
+
+const gchar *       secret_record_get_dbus_path                 (SecretRecord *record);
+
+const gchar *       secret_record_get_label                     (SecretRecord *record);
+
+GHashTable *        secret_record_get_attributes                (SecretRecord *record);
+
+gchar *             secret_record_get_schema_name               (SecretRecord *record);
+
+guint64             secret_record_get_created                   (SecretRecord *record);
+
+guint64             secret_record_get_modified                  (SecretRecord *record);
+
+gboolean            secret_record_get_locked                    (SecretRecord *record);
+
+SecretValue *       secret_record_get_secret                    (SecretRecord *record);
+
+SecretRecord *      secret_record_ref                           (SecretRecord *record);
+
+void                secret_record_unref                         (gpointer record);
+
+void                secret_service_search_records               (SecretService *service,
+                                                                 const SecretSchema *schema,
+                                                                 GHashTable *attributes,
+                                                                 SecretSearchFlags flags,
+                                                                 GCancellable *cancellable,
+                                                                 GAsyncReadyCallback callback,
+                                                                 gpointer user_data);
+
+GPtrArray *         secret_service_search_records_finish        (SecretService *service,
+                                                                 GAsyncResult *result,
+                                                                 GError **error);
+
+GPtrArray *         secret_service_search_records_sync          (SecretService *service,
+                                                                 const SecretSchema *schema,
+                                                                 GHashTable *attributes,
+                                                                 SecretSearchFlags flags,
+                                                                 GCancellable *cancellable,
+                                                                 GError **error);
+
+void                secret_service_search_records_stream        (SecretService *service,
+                                                                 const SecretSchema *schema,
+                                                                 GHashTable *attributes,
+                                                                 SecretSearchFlags flags,
+                                                                 guint limit,
+                                                                 SecretRecordFunc func,
+                                                                 gpointer func_data,
+                                                                 GDestroyNotify func_destroy,
+                                                                 GCancellable *cancellable,
+                                                                 GAsyncReadyCallback callback,
+                                                                 gpointer user_data);
+
+guint               secret_service_search_records_stream_finish (SecretService *service,
+                                                                 GAsyncResult *result,
+                                                                 GError **error);
+
+guint               secret_service_search_records_stream_sync   (SecretService *service,
+                                                                 const SecretSchema *schema,
+                                                                 GHashTable *attributes,
+                                                                 SecretSearchFlags flags,
+                                                                 guint limit,
+                                                                 SecretRecordFunc func,
+                                                                 gpointer func_data,
+                                                                 GCancellable *cancellable,
+                                                                 GError **error);
+
+void                secret_collection_search_records_stream        (SecretCollection *collection,
+                                                                    const SecretSchema *schema,
+                                                                    GHashTable *attributes,
+                                                                    SecretSearchFlags flags,
+                                                                    guint limit,
+                                                                    SecretRecordFunc func,
+                                                                    gpointer func_data,
+                                                                    GDestroyNotify func_destroy,
+                                                                    GCancellable *cancellable,
+                                                                    GAsyncReadyCallback callback,
+                                                                    gpointer user_data);
+
+guint               secret_collection_search_records_stream_finish (SecretCollection *collection,
+                                                                    GAsyncResult *result,
+                                                                    GError **error);
+
+guint               secret_collection_search_records_stream_sync   (SecretCollection *collection,
+                                                                    const SecretSchema *schema,
+                                                                    GHashTable *attributes,
+                                                                    SecretSearchFlags flags,
+                                                                    guint limit,
+                                                                    SecretRecordFunc func,
+                                                                    gpointer func_data,
+                                                                    GCancellable *cancellable,
+                                                                    GError **error);
+
+G_END_DECLS
+
+#endif /* __SECRET_RECORD_H___ */
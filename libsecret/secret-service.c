@@ -101,6 +101,9 @@
  *                               while initializing the #SecretService
  * @SECRET_SERVICE_LOAD_COLLECTIONS: load collections while initializing the
  *                                   #SecretService
+ * @SECRET_SERVICE_CACHE_SEARCHES: remember which items matched a search, so that
+ *                                 repeating the search does not contact the
+ *                                 secret service
  *
  * Flags which determine which parts of the #SecretService proxy are initialized
  * during a secret_service_get() or secret_service_open() operation.
@@ -124,12 +127,41 @@ struct _SecretServicePrivate {
 	/* Locked by mutex */
 	GMutex mutex;
 	gpointer session;
+	gboolean session_opening;
+	GSList *session_waiters;
+	guint session_opened;
+	guint session_coalesced;
 	GHashTable *collections;
+	SecretCache *cache;
+	guint cache_filter;
+	guint cache_signals;
+	GHashTable *proxies;
+	GHashTable *proxies_signals;
+	guint64 proxies_dispatched;
+	GHashTable *deferred;
+	gint object_manager;
 };
 
+typedef struct {
+	gpointer instance;
+	GWeakRef ref;
+	GMainContext *context;
+	gboolean reusable;
+} ServiceProxy;
+
+typedef struct {
+	GWeakRef service;
+	GMainContext *context;
+	guint subscription;
+	guint registered;
+} ServiceSignals;
+
 G_LOCK_DEFINE (service_instance);
 static gpointer service_instance = NULL;
 static guint service_watch = 0;
+static gboolean service_initializing = FALSE;
+static GThread *service_init_thread = NULL;
+static GSList *service_waiters = NULL;
 
 static GInitableIface *secret_service_initable_parent_iface = NULL;
 
@@ -222,6 +254,25 @@ service_cache_instance (SecretService *instance)
 		g_bus_unwatch_name (watch);
 }
 
+static void
+service_proxy_free (gpointer data)
+{
+	ServiceProxy *proxy = data;
+	g_weak_ref_clear (&proxy->ref);
+	if (proxy->context)
+		g_main_context_unref (proxy->context);
+	g_slice_free (ServiceProxy, proxy);
+}
+
+static void
+service_signals_free (gpointer data)
+{
+	ServiceSignals *signals = data;
+	g_weak_ref_clear (&signals->service);
+	g_main_context_unref (signals->context);
+	g_slice_free (ServiceSignals, signals);
+}
+
 static void
 secret_service_init (SecretService *self)
 {
@@ -230,6 +281,10 @@ secret_service_init (SecretService *self)
 
 	g_mutex_init (&self->pv->mutex);
 	self->pv->cancellable = g_cancellable_new ();
+	self->pv->proxies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->pv->proxies_signals = g_hash_table_new (g_direct_hash, g_direct_equal);
+	self->pv->deferred = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                            NULL, service_proxy_free);
 }
 
 static void
@@ -271,6 +326,14 @@ secret_service_set_property (GObject *obj,
 	}
 }
 
+static void
+proxy_list_free (gpointer key,
+                 gpointer value,
+                 gpointer user_data)
+{
+	g_slist_free_full (value, service_proxy_free);
+}
+
 static void
 secret_service_dispose (GObject *obj)
 {
@@ -285,6 +348,28 @@ static void
 secret_service_finalize (GObject *obj)
 {
 	SecretService *self = SECRET_SERVICE (obj);
+	GDBusConnection *connection;
+	ServiceSignals *signals;
+	GHashTableIter iter;
+
+	if (self->pv->cache) {
+		connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+		g_dbus_connection_remove_filter (connection, self->pv->cache_filter);
+		g_dbus_connection_signal_unsubscribe (connection, self->pv->cache_signals);
+		_secret_cache_unref (self->pv->cache);
+	}
+
+	/* Each subscription frees its own ServiceSignals */
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+	g_hash_table_iter_init (&iter, self->pv->proxies_signals);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&signals))
+		g_dbus_connection_signal_unsubscribe (connection, signals->subscription);
+	g_hash_table_destroy (self->pv->proxies_signals);
+
+	/* Proxies still registered hold no reference to us */
+	g_hash_table_foreach (self->pv->proxies, proxy_list_free, NULL);
+	g_hash_table_destroy (self->pv->proxies);
+	g_hash_table_destroy (self->pv->deferred);
 
 	_secret_session_free (self->pv->session);
 	if (self->pv->collections)
@@ -566,6 +651,8 @@ secret_service_class_init (SecretServiceClass *klass)
 typedef struct {
 	GCancellable *cancellable;
 	SecretServiceFlags flags;
+	SecretService *service;
+	GMainContext *context;
 } InitClosure;
 
 static void
@@ -573,15 +660,526 @@ init_closure_free (gpointer data)
 {
 	InitClosure *closure = data;
 	g_clear_object (&closure->cancellable);
+	g_clear_object (&closure->service);
+	if (closure->context)
+		g_main_context_unref (closure->context);
 	g_slice_free (InitClosure, closure);
 }
 
+static GDBusMessage *
+on_cache_filter (GDBusConnection *connection,
+                 GDBusMessage *message,
+                 gboolean incoming,
+                 gpointer user_data)
+{
+	if (incoming)
+		_secret_cache_process_message (user_data, message);
+	return message;
+}
+
+static void
+on_cache_signal (GDBusConnection *connection,
+                 const gchar *sender_name,
+                 const gchar *object_path,
+                 const gchar *interface_name,
+                 const gchar *signal_name,
+                 GVariant *parameters,
+                 gpointer user_data)
+{
+	/* Handled in on_cache_filter(), this only has the bus route them to us */
+}
+
+static SecretCache *
+service_ensure_cache (SecretService *self)
+{
+	GDBusConnection *connection;
+	const gchar *bus_name;
+	SecretCache *cache;
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+	bus_name = g_dbus_proxy_get_name (G_DBUS_PROXY (self));
+
+	g_mutex_lock (&self->pv->mutex);
+
+	/*
+	 * The signals are handled in a filter rather than by the proxies, so
+	 * that the cache stays coherent whether or not the collections and
+	 * items are loaded, and whichever main context they were created in.
+	 */
+	if (self->pv->cache == NULL) {
+		self->pv->cache = _secret_cache_new (bus_name);
+		self->pv->cache_filter = g_dbus_connection_add_filter (connection, on_cache_filter,
+		                                                       _secret_cache_ref (self->pv->cache),
+		                                                       _secret_cache_unref);
+		self->pv->cache_signals = g_dbus_connection_signal_subscribe (connection, bus_name,
+		                                                              NULL, NULL, NULL, NULL,
+		                                                              G_DBUS_SIGNAL_FLAGS_NONE,
+		                                                              on_cache_signal, NULL, NULL);
+	}
+
+	cache = _secret_cache_ref (self->pv->cache);
+
+	g_mutex_unlock (&self->pv->mutex);
+
+	return cache;
+}
+
+static void
+service_enable_search_cache (SecretService *self)
+{
+	SecretCache *cache;
+
+	cache = service_ensure_cache (self);
+	_secret_cache_enable_searches (cache);
+	_secret_cache_unref (cache);
+}
+
+SecretCache *
+_secret_service_get_cache (SecretService *self)
+{
+	SecretCache *cache = NULL;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+	if (self->pv->cache)
+		cache = _secret_cache_ref (self->pv->cache);
+	g_mutex_unlock (&self->pv->mutex);
+
+	return cache;
+}
+
+static void
+service_dispatch_to_proxy (GDBusProxy *proxy,
+                           const gchar *sender_name,
+                           const gchar *interface_name,
+                           const gchar *signal_name,
+                           GVariant *parameters)
+{
+	const gchar *interface;
+	const gchar **invalidated;
+	const gchar *name;
+	GVariantIter iter;
+	GVariant *changed;
+	GVariant *value;
+	guint i;
+
+	/* What GDBusProxy would have done itself, had it subscribed */
+	if (g_str_equal (interface_name, SECRET_PROPERTIES_INTERFACE) &&
+	    g_str_equal (signal_name, "PropertiesChanged")) {
+
+		/* A proxy that GDBusProxy loaded properties for also watches for changes */
+		if (!(g_dbus_proxy_get_flags (proxy) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES))
+			return;
+
+		if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+			return;
+
+		g_variant_get (parameters, "(&s@a{sv}^a&s)", &interface, &changed, &invalidated);
+
+		if (g_str_equal (interface, g_dbus_proxy_get_interface_name (proxy))) {
+			g_variant_iter_init (&iter, changed);
+			while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+				g_dbus_proxy_set_cached_property (proxy, name, value);
+				g_variant_unref (value);
+			}
+			for (i = 0; invalidated[i] != NULL; i++)
+				g_dbus_proxy_set_cached_property (proxy, invalidated[i], NULL);
+
+			g_signal_emit_by_name (proxy, "g-properties-changed", changed, invalidated);
+		}
+
+		g_variant_unref (changed);
+		g_free (invalidated);
+
+	} else if (g_str_equal (interface_name, g_dbus_proxy_get_interface_name (proxy))) {
+		g_signal_emit_by_name (proxy, "g-signal", sender_name, signal_name, parameters);
+	}
+}
+
+typedef struct {
+	GDBusProxy *proxy;
+	gchar *sender_name;
+	gchar *interface_name;
+	gchar *signal_name;
+	GVariant *parameters;
+} DispatchClosure;
+
+static void
+dispatch_closure_free (gpointer data)
+{
+	DispatchClosure *closure = data;
+	g_object_unref (closure->proxy);
+	g_free (closure->sender_name);
+	g_free (closure->interface_name);
+	g_free (closure->signal_name);
+	g_variant_unref (closure->parameters);
+	g_slice_free (DispatchClosure, closure);
+}
+
+static gboolean
+on_dispatch_in_context (gpointer user_data)
+{
+	DispatchClosure *closure = user_data;
+
+	service_dispatch_to_proxy (closure->proxy, closure->sender_name,
+	                           closure->interface_name, closure->signal_name,
+	                           closure->parameters);
+
+	return FALSE;
+}
+
+static void
+on_service_dispatch_signal (GDBusConnection *connection,
+                            const gchar *sender_name,
+                            const gchar *object_path,
+                            const gchar *interface_name,
+                            const gchar *signal_name,
+                            GVariant *parameters,
+                            gpointer user_data)
+{
+	ServiceSignals *signals = user_data;
+	DispatchClosure *closure;
+	SecretService *self;
+	ServiceProxy *proxy;
+	const gchar *item_path;
+	GSList *proxies = NULL;
+	GSList *l;
+
+	self = g_weak_ref_get (&signals->service);
+	if (self == NULL)
+		return;
+
+	/* Only the proxies that live in the context this subscription runs in */
+	g_mutex_lock (&self->pv->mutex);
+	for (l = g_hash_table_lookup (self->pv->proxies, object_path); l != NULL; l = g_slist_next (l)) {
+		proxy = l->data;
+		if (proxy->context == signals->context)
+			proxies = g_slist_prepend (proxies, g_weak_ref_get (&proxy->ref));
+	}
+	if (proxies != NULL)
+		self->pv->proxies_dispatched++;
+
+	/* Items deleted behind our back are no longer handed out */
+	if (g_str_equal (interface_name, SECRET_COLLECTION_INTERFACE) &&
+	    g_str_equal (signal_name, "ItemDeleted") &&
+	    g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(o)"))) {
+		g_variant_get (parameters, "(&o)", &item_path);
+		for (l = g_hash_table_lookup (self->pv->proxies, item_path); l != NULL; l = g_slist_next (l)) {
+			proxy = l->data;
+			proxy->reusable = FALSE;
+		}
+	}
+	g_mutex_unlock (&self->pv->mutex);
+
+	/*
+	 * Emitted outside the lock, as handlers may well call back into us.
+	 * This runs in the subscription's context already, but go through
+	 * g_main_context_invoke() in case that isn't the caller's thread.
+	 */
+	for (l = proxies; l != NULL; l = g_slist_next (l)) {
+		if (l->data == NULL)
+			continue;
+		closure = g_slice_new0 (DispatchClosure);
+		closure->proxy = l->data;
+		closure->sender_name = g_strdup (sender_name);
+		closure->interface_name = g_strdup (interface_name);
+		closure->signal_name = g_strdup (signal_name);
+		closure->parameters = g_variant_ref (parameters);
+		g_main_context_invoke_full (signals->context, G_PRIORITY_DEFAULT,
+		                            on_dispatch_in_context, closure,
+		                            dispatch_closure_free);
+	}
+
+	g_slist_free (proxies);
+	g_object_unref (self);
+}
+
+static void
+service_subscribe_signals_locked (SecretService *self,
+                                  GMainContext *context)
+{
+	GDBusConnection *connection;
+	ServiceSignals *signals;
+
+	signals = g_hash_table_lookup (self->pv->proxies_signals, context);
+	if (signals != NULL) {
+		signals->registered++;
+		return;
+	}
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+
+	signals = g_slice_new0 (ServiceSignals);
+	g_weak_ref_init (&signals->service, self);
+	signals->context = g_main_context_ref (context);
+	signals->registered = 1;
+
+	/*
+	 * Collection and item proxies neither subscribe to their own signals
+	 * nor have GDBusProxy load and watch their properties, either of which
+	 * would cost a match rule on the bus for each object path. One
+	 * subscription for everything the service sends, per main context the
+	 * proxies were created in, routes the signals to whichever are alive.
+	 * This runs in the proxy's thread-default context, as GDBusProxy would
+	 * have subscribed in itself.
+	 */
+	signals->subscription = g_dbus_connection_signal_subscribe (connection,
+	                                                            g_dbus_proxy_get_name (G_DBUS_PROXY (self)),
+	                                                            NULL, NULL, NULL, NULL,
+	                                                            G_DBUS_SIGNAL_FLAGS_NONE,
+	                                                            on_service_dispatch_signal,
+	                                                            signals, service_signals_free);
+
+	g_hash_table_insert (self->pv->proxies_signals, context, signals);
+}
+
+static void
+service_unsubscribe_signals_locked (SecretService *self,
+                                    GMainContext *context)
+{
+	GDBusConnection *connection;
+	ServiceSignals *signals;
+
+	signals = g_hash_table_lookup (self->pv->proxies_signals, context);
+	g_return_if_fail (signals != NULL);
+
+	if (--signals->registered > 0)
+		return;
+
+	g_hash_table_remove (self->pv->proxies_signals, context);
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (self));
+	g_dbus_connection_signal_unsubscribe (connection, signals->subscription);
+}
+
+void
+_secret_service_register_proxy (SecretService *self,
+                                GDBusProxy *proxy)
+{
+	ServiceProxy *registered;
+	const gchar *object_path;
+	GSList *proxies;
+	GSList *l;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+
+	/* Proxies that subscribed to their own signals need no help */
+	if (!(g_dbus_proxy_get_flags (proxy) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS))
+		return;
+
+	object_path = g_dbus_proxy_get_object_path (proxy);
+	if (object_path == NULL)
+		return;
+
+	g_mutex_lock (&self->pv->mutex);
+
+	proxies = g_hash_table_lookup (self->pv->proxies, object_path);
+	for (l = proxies; l != NULL; l = g_slist_next (l)) {
+		registered = l->data;
+		if (registered->instance == proxy)
+			break;
+	}
+
+	if (l == NULL) {
+		registered = g_slice_new0 (ServiceProxy);
+		registered->instance = proxy;
+		g_weak_ref_init (&registered->ref, proxy);
+		registered->context = g_main_context_ref_thread_default ();
+		service_subscribe_signals_locked (self, registered->context);
+		proxies = g_slist_prepend (proxies, registered);
+		g_hash_table_replace (self->pv->proxies, g_strdup (object_path), proxies);
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_unregister_proxy (SecretService *self,
+                                  GDBusProxy *proxy)
+{
+	ServiceProxy *registered;
+	const gchar *object_path;
+	GSList *proxies;
+	GSList *l;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	/* Called from finalize, so the proxy is only used as a key */
+	object_path = g_dbus_proxy_get_object_path (proxy);
+	if (object_path == NULL)
+		return;
+
+	g_mutex_lock (&self->pv->mutex);
+
+	proxies = g_hash_table_lookup (self->pv->proxies, object_path);
+	for (l = proxies; l != NULL; l = g_slist_next (l)) {
+		registered = l->data;
+		if (registered->instance == proxy) {
+			proxies = g_slist_delete_link (proxies, l);
+			service_unsubscribe_signals_locked (self, registered->context);
+			service_proxy_free (registered);
+			if (proxies == NULL)
+				g_hash_table_remove (self->pv->proxies, object_path);
+			else
+				g_hash_table_replace (self->pv->proxies, g_strdup (object_path), proxies);
+			break;
+		}
+	}
+
+	g_hash_table_remove (self->pv->deferred, proxy);
+
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+void
+_secret_service_set_proxy_reusable (SecretService *self,
+                                    GDBusProxy *proxy,
+                                    gboolean reusable)
+{
+	ServiceProxy *registered;
+	const gchar *object_path;
+	GSList *l;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+
+	object_path = g_dbus_proxy_get_object_path (proxy);
+	if (object_path == NULL)
+		return;
+
+	g_mutex_lock (&self->pv->mutex);
+
+	for (l = g_hash_table_lookup (self->pv->proxies, object_path); l != NULL; l = g_slist_next (l)) {
+		registered = l->data;
+		if (registered->instance == proxy) {
+			registered->reusable = reusable;
+			break;
+		}
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+GDBusProxy *
+_secret_service_find_proxy (SecretService *self,
+                            const gchar *object_path,
+                            GType type)
+{
+	ServiceProxy *registered;
+	GDBusProxy *proxy = NULL;
+	GSList *l;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (object_path != NULL, NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+
+	for (l = g_hash_table_lookup (self->pv->proxies, object_path); l != NULL; l = g_slist_next (l)) {
+		registered = l->data;
+
+		/* Still loading, failed to, or since deleted */
+		if (!registered->reusable)
+			continue;
+
+		proxy = g_weak_ref_get (&registered->ref);
+		if (proxy != NULL && G_TYPE_CHECK_INSTANCE_TYPE (proxy, type))
+			break;
+		g_clear_object (&proxy);
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
+
+	return proxy;
+}
+
+void
+_secret_service_defer_properties (SecretService *self,
+                                  GDBusProxy *proxy)
+{
+	ServiceProxy *deferred;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+
+	g_mutex_lock (&self->pv->mutex);
+
+	if (!g_hash_table_lookup (self->pv->deferred, proxy)) {
+		deferred = g_slice_new0 (ServiceProxy);
+		deferred->instance = proxy;
+		g_weak_ref_init (&deferred->ref, proxy);
+		g_hash_table_insert (self->pv->deferred, proxy, deferred);
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
+}
+
+GList *
+_secret_service_take_deferred (SecretService *self,
+                               guint max)
+{
+	ServiceProxy *deferred;
+	GHashTableIter iter;
+	GList *proxies = NULL;
+	gpointer proxy;
+	guint count = 0;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+
+	g_mutex_lock (&self->pv->mutex);
+
+	g_hash_table_iter_init (&iter, self->pv->deferred);
+	while (count < max && g_hash_table_iter_next (&iter, NULL, (gpointer *)&deferred)) {
+		proxy = g_weak_ref_get (&deferred->ref);
+		if (proxy != NULL) {
+			proxies = g_list_prepend (proxies, proxy);
+			count++;
+		}
+		g_hash_table_iter_remove (&iter);
+	}
+
+	g_mutex_unlock (&self->pv->mutex);
+
+	return proxies;
+}
+
+void
+_secret_service_get_dispatch_stats (SecretService *self,
+                                    guint *registered,
+                                    guint *subscriptions,
+                                    guint64 *dispatched)
+{
+	GHashTableIter iter;
+	GSList *proxies;
+	guint count = 0;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->mutex);
+
+	g_hash_table_iter_init (&iter, self->pv->proxies);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&proxies))
+		count += g_slist_length (proxies);
+
+	if (registered)
+		*registered = count;
+	if (subscriptions)
+		*subscriptions = g_hash_table_size (self->pv->proxies_signals);
+	if (dispatched)
+		*dispatched = self->pv->proxies_dispatched;
+
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 static gboolean
 service_ensure_for_flags_sync (SecretService *self,
                                SecretServiceFlags flags,
                                GCancellable *cancellable,
                                GError **error)
 {
+	if (flags & SECRET_SERVICE_CACHE_SEARCHES)
+		service_enable_search_cache (self);
+
 	if (flags & SECRET_SERVICE_OPEN_SESSION)
 		if (!secret_service_ensure_session_sync (self, cancellable, error))
 			return FALSE;
@@ -643,6 +1241,9 @@ service_ensure_for_flags_async (SecretService *self,
 
 	closure->flags = flags;
 
+	if (closure->flags & SECRET_SERVICE_CACHE_SEARCHES)
+		service_enable_search_cache (self);
+
 	if (closure->flags & SECRET_SERVICE_OPEN_SESSION)
 		secret_service_ensure_session (self, closure->cancellable,
 		                               on_ensure_session, g_object_ref (res));
@@ -662,6 +1263,9 @@ secret_service_initable_init (GInitable *initable,
 {
 	SecretService *self;
 
+	/* Work on the session keys while the proxy is initializing */
+	_secret_session_pregenerate ();
+
 	if (!secret_service_initable_parent_iface->init (initable, cancellable, error))
 		return FALSE;
 
@@ -707,6 +1311,9 @@ secret_service_async_initable_init_async (GAsyncInitable *initable,
 	GSimpleAsyncResult *res;
 	InitClosure *closure;
 
+	/* Work on the session keys while the proxy is initializing */
+	_secret_session_pregenerate ();
+
 	res = g_simple_async_result_new (G_OBJECT (initable), callback, user_data,
 	                                 secret_service_async_initable_init_async);
 	closure = g_slice_new0 (InitClosure);
@@ -756,45 +1363,158 @@ get_default_bus_name (void)
 	return bus_name;
 }
 
-/**
- * secret_service_get:
- * @flags: flags for which service functionality to ensure is initialized
- * @cancellable: optional cancellation object
- * @callback: called when the operation completes
- * @user_data: data to be passed to the callback
- *
- * Get a #SecretService proxy for the Secret Service. If such a proxy object
- * already exists, then the same proxy is returned.
- *
- * If @flags contains any flags of which parts of the secret service to
- * ensure are initialized, then those will be initialized before completing.
- *
- * This method will return immediately and complete asynchronously.
- */
-void
-secret_service_get (SecretServiceFlags flags,
-                    GCancellable *cancellable,
-                    GAsyncReadyCallback callback,
-                    gpointer user_data)
+static gboolean
+on_service_waiter (gpointer user_data)
 {
-	SecretService *service = NULL;
-	GSimpleAsyncResult *res;
-	InitClosure *closure;
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	InitClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretServiceFlags flags;
+	GError *error = NULL;
 
-	service = service_get_instance ();
+	/* The error has already been set */
+	if (closure->service == NULL) {
+		g_simple_async_result_complete (res);
 
-	/* Create a whole new service */
-	if (service == NULL) {
-		g_async_initable_new_async (SECRET_TYPE_SERVICE, G_PRIORITY_DEFAULT,
-		                            cancellable, callback, user_data,
-		                            "g-flags", G_DBUS_PROXY_FLAGS_NONE,
-		                            "g-interface-info", _secret_gen_service_interface_info (),
-		                            "g-name", get_default_bus_name (),
-		                            "g-bus-type", G_BUS_TYPE_SESSION,
-		                            "g-object-path", SECRET_SERVICE_PATH,
-		                            "g-interface-name", SECRET_SERVICE_INTERFACE,
-		                            "flags", flags,
-		                            NULL);
+	} else if (g_cancellable_set_error_if_cancelled (closure->cancellable, &error)) {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+
+	/* Each waiter ensures its own flags, skipping what's already done */
+	} else {
+		flags = closure->flags & ~secret_service_get_flags (closure->service);
+		service_ensure_for_flags_async (closure->service, flags, res);
+	}
+
+	return FALSE;
+}
+
+static SecretService *
+service_finish_initializing (SecretService *service,
+                             const GError *error)
+{
+	GSimpleAsyncResult *res;
+	SecretService *kept;
+	InitClosure *closure;
+	GSList *waiters, *l;
+
+	/* Everyone gets the instance that was kept, not necessarily this one */
+	if (service != NULL) {
+		service_cache_instance (service);
+		kept = service_get_instance ();
+		service = kept ? kept : g_object_ref (service);
+	}
+
+	G_LOCK (service_instance);
+	waiters = g_slist_reverse (service_waiters);
+	service_waiters = NULL;
+	service_initializing = FALSE;
+	service_init_thread = NULL;
+	G_UNLOCK (service_instance);
+
+	/* Each waiter completes in the main context it called from */
+	for (l = waiters; l != NULL; l = g_slist_next (l)) {
+		res = l->data;
+		closure = g_simple_async_result_get_op_res_gpointer (res);
+		if (service != NULL)
+			closure->service = g_object_ref (service);
+		else
+			g_simple_async_result_set_from_error (res, error);
+		g_main_context_invoke_full (closure->context, G_PRIORITY_DEFAULT,
+		                            on_service_waiter, res, g_object_unref);
+	}
+
+	g_slist_free (waiters);
+	return service;
+}
+
+static void
+on_service_instance_init (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	SecretService *service;
+	GObject *created;
+	GError *error = NULL;
+
+	created = g_async_initable_new_finish (G_ASYNC_INITABLE (source), result, &error);
+	service = service_finish_initializing (created ? SECRET_SERVICE (created) : NULL, error);
+
+	g_clear_error (&error);
+	g_clear_object (&created);
+	g_clear_object (&service);
+}
+
+/**
+ * secret_service_get:
+ * @flags: flags for which service functionality to ensure is initialized
+ * @cancellable: optional cancellation object
+ * @callback: called when the operation completes
+ * @user_data: data to be passed to the callback
+ *
+ * Get a #SecretService proxy for the Secret Service. If such a proxy object
+ * already exists, then the same proxy is returned.
+ *
+ * If @flags contains any flags of which parts of the secret service to
+ * ensure are initialized, then those will be initialized before completing.
+ *
+ * If the proxy is still being created for another caller, then this waits
+ * for that rather than creating another one, and then initializes any
+ * further parts requested in @flags.
+ *
+ * This method will return immediately and complete asynchronously.
+ */
+void
+secret_service_get (SecretServiceFlags flags,
+                    GCancellable *cancellable,
+                    GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+	SecretService *service = NULL;
+	GSimpleAsyncResult *res;
+	InitClosure *closure;
+	gboolean start = FALSE;
+
+	service = service_get_instance ();
+
+	/* Create a whole new service, or wait for the one being created */
+	if (service == NULL) {
+		res = g_simple_async_result_new (NULL, callback, user_data, secret_service_get);
+		closure = g_slice_new0 (InitClosure);
+		closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+		closure->flags = flags;
+		closure->context = g_main_context_ref_thread_default ();
+		g_simple_async_result_set_op_res_gpointer (res, closure, init_closure_free);
+
+		G_LOCK (service_instance);
+		if (service_instance != NULL) {
+			service = g_object_ref (service_instance);
+		} else {
+			service_waiters = g_slist_prepend (service_waiters, g_object_ref (res));
+			start = !service_initializing;
+			if (start)
+				service_init_thread = g_thread_self ();
+			service_initializing = TRUE;
+		}
+		G_UNLOCK (service_instance);
+
+		/* Shared by all the waiters, so no cancellable and no flags */
+		if (start) {
+			g_async_initable_new_async (SECRET_TYPE_SERVICE, G_PRIORITY_DEFAULT,
+			                            NULL, on_service_instance_init, NULL,
+			                            "g-flags", G_DBUS_PROXY_FLAGS_NONE,
+			                            "g-interface-info", _secret_gen_service_interface_info (),
+			                            "g-name", get_default_bus_name (),
+			                            "g-bus-type", G_BUS_TYPE_SESSION,
+			                            "g-object-path", SECRET_SERVICE_PATH,
+			                            "g-interface-name", SECRET_SERVICE_INTERFACE,
+			                            "flags", SECRET_SERVICE_NONE,
+			                            NULL);
+
+		/* Created while we were setting up */
+		} else if (service != NULL) {
+			closure->service = service;
+			service_ensure_for_flags_async (service, flags, res);
+		}
 
 	/* Just have to ensure that the service matches flags */
 	} else {
@@ -808,8 +1528,9 @@ secret_service_get (SecretServiceFlags flags,
 		service_ensure_for_flags_async (service, flags, res);
 
 		g_object_unref (service);
-		g_object_unref (res);
 	}
+
+	g_object_unref (res);
 }
 
 /**
@@ -829,22 +1550,23 @@ secret_service_get_finish (GAsyncResult *result,
 {
 	GObject *service = NULL;
 	GObject *source_object;
+	InitClosure *closure;
 
 	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
 	source_object = g_async_result_get_source_object (result);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, source_object,
+	                      secret_service_get), NULL);
 
-	/* Just ensuring that the service matches flags */
-	if (g_simple_async_result_is_valid (result, source_object, secret_service_get)) {
-		if (!_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
-			service = g_object_ref (source_object);
+	if (!_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error)) {
+		closure = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
 
-	/* Creating a whole new service */
-	} else {
-		service = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), result, error);
-		if (service)
-			service_cache_instance (SECRET_SERVICE (service));
+		/* Either waited for the service to be created, or it already was */
+		if (closure->service)
+			service = g_object_ref (closure->service);
+		else
+			service = g_object_ref (source_object);
 	}
 
 	if (source_object)
@@ -863,7 +1585,9 @@ secret_service_get_finish (GAsyncResult *result,
  * @error: location to place an error on failure
  *
  * Get a #SecretService proxy for the Secret Service. If such a proxy object
- * already exists, then the same proxy is returned.
+ * already exists, then the same proxy is returned. If another thread is
+ * already creating the proxy, this waits for that creation to finish and
+ * returns the same proxy.
  *
  * If @flags contains any flags of which parts of the secret service to
  * ensure are initialized, then those will be initialized before returning.
@@ -880,28 +1604,92 @@ secret_service_get_sync (SecretServiceFlags flags,
                          GError **error)
 {
 	SecretService *service = NULL;
+	GSimpleAsyncResult *res;
+	GObject *created;
+	GError *local = NULL;
+	gboolean initializing = FALSE;
+	InitClosure *closure;
+	SecretSync *sync;
+	gboolean wait = FALSE;
 
 	service = service_get_instance ();
 
 	if (service == NULL) {
-		service = g_initable_new (SECRET_TYPE_SERVICE, cancellable, error,
-		                          "g-flags", G_DBUS_PROXY_FLAGS_NONE,
-		                          "g-interface-info", _secret_gen_service_interface_info (),
-		                          "g-name", get_default_bus_name (),
-		                          "g-bus-type", G_BUS_TYPE_SESSION,
-		                          "g-object-path", SECRET_SERVICE_PATH,
-		                          "g-interface-name", SECRET_SERVICE_INTERFACE,
-		                          "flags", flags,
-		                          NULL);
+		sync = _secret_sync_new ();
+		g_main_context_push_thread_default (sync->context);
 
-		if (service != NULL)
-			service_cache_instance (service);
+		res = g_simple_async_result_new (NULL, _secret_sync_on_result, sync, secret_service_get);
+		closure = g_slice_new0 (InitClosure);
+		closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+		closure->flags = flags;
+		closure->context = g_main_context_ref (sync->context);
+		g_simple_async_result_set_op_res_gpointer (res, closure, init_closure_free);
 
-	} else {
-		if (!service_ensure_for_flags_sync (service, flags, cancellable, error)) {
-			g_object_unref (service);
-			return NULL;
+		/*
+		 * Join the initialization already under way, like secret_service_get().
+		 * Unless this thread started it, and would never get to complete it,
+		 * then create another one, and return whichever ends up being kept.
+		 */
+		G_LOCK (service_instance);
+		if (service_instance != NULL) {
+			service = g_object_ref (service_instance);
+		} else if (!service_initializing) {
+			service_initializing = TRUE;
+			service_init_thread = g_thread_self ();
+			initializing = TRUE;
+		} else if (service_init_thread != g_thread_self ()) {
+			service_waiters = g_slist_prepend (service_waiters, g_object_ref (res));
+			wait = TRUE;
 		}
+		G_UNLOCK (service_instance);
+
+		if (wait)
+			g_main_loop_run (sync->loop);
+
+		g_main_context_pop_thread_default (sync->context);
+		g_object_unref (res);
+
+		/* The waiter has also ensured the flags */
+		if (wait) {
+			service = secret_service_get_finish (sync->result, error);
+			_secret_sync_free (sync);
+			return service;
+		}
+
+		_secret_sync_free (sync);
+
+		/* Nobody else is creating it, so do it here, in the caller's context */
+		if (service == NULL) {
+			created = g_initable_new (SECRET_TYPE_SERVICE, NULL, &local,
+			                          "g-flags", G_DBUS_PROXY_FLAGS_NONE,
+			                          "g-interface-info", _secret_gen_service_interface_info (),
+			                          "g-name", get_default_bus_name (),
+			                          "g-bus-type", G_BUS_TYPE_SESSION,
+			                          "g-object-path", SECRET_SERVICE_PATH,
+			                          "g-interface-name", SECRET_SERVICE_INTERFACE,
+			                          "flags", SECRET_SERVICE_NONE,
+			                          NULL);
+
+			if (initializing) {
+				service = service_finish_initializing (created ? SECRET_SERVICE (created) : NULL, local);
+			} else if (created != NULL) {
+				service_cache_instance (SECRET_SERVICE (created));
+				service = service_get_instance ();
+			}
+
+			if (service == NULL && created != NULL)
+				service = g_object_ref (created);
+			g_clear_object (&created);
+			if (service == NULL) {
+				g_propagate_error (error, local);
+				return NULL;
+			}
+		}
+	}
+
+	if (!service_ensure_for_flags_sync (service, flags, cancellable, error)) {
+		g_object_unref (service);
+		return NULL;
 	}
 
 	return service;
@@ -926,6 +1714,38 @@ secret_service_disconnect (void)
 	service_uncache_instance (NULL);
 }
 
+/**
+ * secret_service_set_io_thread:
+ * @enabled: whether to use the I/O thread
+ *
+ * Run blocking calls on a dedicated thread owned by the library.
+ *
+ * By default each blocking call, such as secret_password_lookup_sync(),
+ * runs its own main loop in the calling thread. When @enabled is %TRUE,
+ * the lookup, store and clear functions of the password and #SecretService
+ * APIs instead queue their request to a single I/O thread, and the calling
+ * thread waits until that request completes. The default #SecretService
+ * proxy and its session are then created and used from that thread, which
+ * suits servers making blocking calls from many worker threads.
+ *
+ * Only those functions use the I/O thread. Other blocking calls, such as
+ * secret_service_search_sync() or secret_item_load_secret_sync(), still
+ * run their own main loop in the calling thread. Requests are handed to
+ * the I/O thread on a #GAsyncQueue, which is protected by a mutex rather
+ * than being lock-free.
+ *
+ * The I/O thread is started the first time this is enabled, and stays
+ * around until the process exits. Disabling it again only affects calls
+ * made afterwards.
+ *
+ * Stability: Unstable
+ */
+void
+secret_service_set_io_thread (gboolean enabled)
+{
+	_secret_sync_set_io_thread (enabled);
+}
+
 /**
  * secret_service_open:
  * @service_gtype: the GType of the new secret service
@@ -1082,12 +1902,129 @@ secret_service_get_flags (SecretService *self)
 		flags |= SECRET_SERVICE_OPEN_SESSION;
 	if (self->pv->collections)
 		flags |= SECRET_SERVICE_LOAD_COLLECTIONS;
+	if (self->pv->cache && _secret_cache_caches_searches (self->pv->cache))
+		flags |= SECRET_SERVICE_CACHE_SEARCHES;
 
 	g_mutex_unlock (&self->pv->mutex);
 
 	return flags;
 }
 
+/**
+ * secret_service_get_search_cache_stats:
+ * @self: the secret service proxy
+ * @hits: (out) (allow-none): location to place the number of searches
+ *        answered from the cache
+ * @misses: (out) (allow-none): location to place the number of searches
+ *          sent to the secret service
+ * @invalidations: (out) (allow-none): location to place the number of
+ *                 cached searches dropped because the items changed
+ *
+ * Get counters describing how well searches are being cached. All counters
+ * are zero unless the %SECRET_SERVICE_CACHE_SEARCHES flag was specified when
+ * initializing the #SecretService proxy object.
+ */
+void
+secret_service_get_search_cache_stats (SecretService *self,
+                                       guint64 *hits,
+                                       guint64 *misses,
+                                       guint64 *invalidations)
+{
+	SecretCache *cache;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	if (hits)
+		*hits = 0;
+	if (misses)
+		*misses = 0;
+	if (invalidations)
+		*invalidations = 0;
+
+	cache = _secret_service_get_cache (self);
+	if (cache) {
+		_secret_cache_get_search_stats (cache, hits, misses, invalidations);
+		_secret_cache_unref (cache);
+	}
+}
+
+/**
+ * secret_service_set_secret_cache_policy:
+ * @self: the secret service proxy
+ * @max_bytes: the most secret data to keep, zero to not cache secrets, or
+ *             -1 to use half of the memory that this process may lock
+ * @max_age: number of seconds after which a cached secret is retrieved
+ *           again, or zero to keep it until it is evicted
+ *
+ * Keep the secret values of items in a cache shared by the #SecretService
+ * proxy, so that looking them up again does not contact the secret service.
+ *
+ * Cached secrets are held in non-pageable memory. When they total more
+ * than @max_bytes the least recently used are evicted. A secret is also
+ * dropped when its item changes, is deleted or is locked. Secrets that
+ * are no longer cached are retrieved again as needed by
+ * secret_service_lookup() and secret_service_get_secret_for_dbus_path().
+ * secret_item_get_secret() returns %NULL for them until
+ * secret_item_load_secret() is called.
+ *
+ * No secrets are cached by default.
+ */
+void
+secret_service_set_secret_cache_policy (SecretService *self,
+                                        gssize max_bytes,
+                                        guint max_age)
+{
+	SecretCache *cache;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	cache = service_ensure_cache (self);
+	_secret_cache_set_secret_policy (cache, max_bytes, max_age);
+	_secret_cache_unref (cache);
+}
+
+/**
+ * secret_service_get_secret_cache_stats:
+ * @self: the secret service proxy
+ * @hits: (out) (allow-none): location to place the number of secrets
+ *        found in the cache
+ * @misses: (out) (allow-none): location to place the number of secrets
+ *          that had to be retrieved
+ * @evictions: (out) (allow-none): location to place the number of secrets
+ *             evicted to stay in the budget, or because they expired
+ * @bytes: (out) (allow-none): location to place the size of the secrets
+ *         currently cached
+ *
+ * Get counters describing how well secret values are being cached. See
+ * secret_service_set_secret_cache_policy().
+ */
+void
+secret_service_get_secret_cache_stats (SecretService *self,
+                                       guint64 *hits,
+                                       guint64 *misses,
+                                       guint64 *evictions,
+                                       gsize *bytes)
+{
+	SecretCache *cache;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	if (hits)
+		*hits = 0;
+	if (misses)
+		*misses = 0;
+	if (evictions)
+		*evictions = 0;
+	if (bytes)
+		*bytes = 0;
+
+	cache = _secret_service_get_cache (self);
+	if (cache) {
+		_secret_cache_get_secret_stats (cache, hits, misses, evictions, bytes);
+		_secret_cache_unref (cache);
+	}
+}
+
 /**
  * secret_service_get_collections:
  * @self: the secret service proxy
@@ -1139,11 +2076,16 @@ _secret_service_find_item_instance (SecretService *self,
 
 	g_free (collection_path);
 
-	if (collection == NULL)
-		return NULL;
+	if (collection == NULL) {
+		item = NULL;
+	} else {
+		item = _secret_collection_find_item_instance (collection, item_path);
+		g_object_unref (collection);
+	}
 
-	item = _secret_collection_find_item_instance (collection, item_path);
-	g_object_unref (collection);
+	/* Any other item the caller still holds, such as from a search */
+	if (item == NULL)
+		item = (SecretItem *)_secret_service_find_proxy (self, item_path, SECRET_TYPE_ITEM);
 
 	return item;
 }
@@ -1179,6 +2121,37 @@ _secret_service_get_session (SecretService *self)
 	return session;
 }
 
+gboolean
+_secret_service_has_capability (SecretService *self,
+                                const gchar *capability)
+{
+	GVariant *capabilities;
+	GVariantIter iter;
+	const gchar *name;
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (capability != NULL, FALSE);
+
+	/*
+	 * Capabilities is not part of the Secret Service spec. Services which
+	 * support our extensions list them there, and it arrives along with
+	 * the other properties, so checking it costs no round trip.
+	 */
+	capabilities = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Capabilities");
+	if (capabilities == NULL)
+		return FALSE;
+
+	if (g_variant_is_of_type (capabilities, G_VARIANT_TYPE_STRING_ARRAY)) {
+		g_variant_iter_init (&iter, capabilities);
+		while (!ret && g_variant_iter_loop (&iter, "&s", &name))
+			ret = g_str_equal (name, capability);
+	}
+
+	g_variant_unref (capabilities);
+	return ret;
+}
+
 void
 _secret_service_take_session (SecretService *self,
                               SecretSession *session)
@@ -1254,6 +2227,86 @@ secret_service_get_session_dbus_path (SecretService *self)
 	return path;
 }
 
+typedef struct {
+	SecretService *service;
+	GCancellable *cancellable;
+	gulong cancelled_sig;
+} SessionWaiter;
+
+static void
+session_waiter_free (gpointer data)
+{
+	SessionWaiter *waiter = data;
+
+	if (waiter->cancellable) {
+		g_cancellable_disconnect (waiter->cancellable, waiter->cancelled_sig);
+		g_object_unref (waiter->cancellable);
+	}
+	g_slice_free (SessionWaiter, waiter);
+}
+
+static void
+on_ensure_session_cancelled (GCancellable *cancellable,
+                             gpointer user_data)
+{
+	GSimpleAsyncResult *res = user_data;
+	SessionWaiter *waiter = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *self = waiter->service;
+	GError *error = NULL;
+	GSList *link;
+
+	/* Stop waiting, the negotiation carries on for the other waiters */
+	g_mutex_lock (&self->pv->mutex);
+	link = g_slist_find (self->pv->session_waiters, res);
+	if (link != NULL)
+		self->pv->session_waiters = g_slist_delete_link (self->pv->session_waiters, link);
+	g_mutex_unlock (&self->pv->mutex);
+
+	if (link != NULL) {
+		g_cancellable_set_error_if_cancelled (cancellable, &error);
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete_in_idle (res);
+		g_object_unref (res);
+	}
+}
+
+static void
+on_ensure_session_opened (GObject *source,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	SecretService *self = SECRET_SERVICE (source);
+	GSimpleAsyncResult *res;
+	SessionWaiter *waiter;
+	GError *error = NULL;
+	GSList *waiters, *l;
+
+	_secret_session_open_finish (result, &error);
+
+	g_mutex_lock (&self->pv->mutex);
+	waiters = g_slist_reverse (self->pv->session_waiters);
+	self->pv->session_waiters = NULL;
+	self->pv->session_opening = FALSE;
+	if (error == NULL)
+		self->pv->session_opened++;
+	g_mutex_unlock (&self->pv->mutex);
+
+	/* Each waiter completes in the main context it called from */
+	for (l = waiters; l != NULL; l = g_slist_next (l)) {
+		res = l->data;
+		waiter = g_simple_async_result_get_op_res_gpointer (res);
+		if (error != NULL)
+			g_simple_async_result_set_from_error (res, error);
+		else
+			g_simple_async_result_set_check_cancellable (res, waiter->cancellable);
+		g_simple_async_result_complete_in_idle (res);
+		g_object_unref (res);
+	}
+
+	g_slist_free (waiters);
+	g_clear_error (&error);
+}
+
 /**
  * secret_service_ensure_session:
  * @self: the secret service
@@ -1269,6 +2322,9 @@ secret_service_get_session_dbus_path (SecretService *self)
  * to secret_service_get() in order to ensure that a session has been established
  * by the time you get the #SecretService proxy.
  *
+ * If a session is already being established, then this waits for that one.
+ * Cancelling @cancellable only stops this call from waiting.
+ *
  * This method will return immediately and complete asynchronously.
  */
 void
@@ -1278,24 +2334,49 @@ secret_service_ensure_session (SecretService *self,
                                gpointer user_data)
 {
 	GSimpleAsyncResult *res;
-	SecretSession *session;
+	SessionWaiter *waiter;
+	gboolean start = FALSE;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 secret_service_ensure_session);
+
 	g_mutex_lock (&self->pv->mutex);
-	session = self->pv->session;
-	g_mutex_unlock (&self->pv->mutex);
+	if (self->pv->session == NULL) {
+		waiter = g_slice_new0 (SessionWaiter);
+		waiter->service = self;
+		waiter->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+		g_simple_async_result_set_op_res_gpointer (res, waiter, session_waiter_free);
+
+		/* Wait on a session already being negotiated, rather than starting another */
+		self->pv->session_waiters = g_slist_prepend (self->pv->session_waiters,
+		                                             g_object_ref (res));
+		if (self->pv->session_opening) {
+			self->pv->session_coalesced++;
+		} else {
+			self->pv->session_opening = TRUE;
+			start = TRUE;
+		}
+		g_mutex_unlock (&self->pv->mutex);
+
+		/* Shared by all the waiters, so no cancellable */
+		if (start)
+			_secret_session_open (self, NULL, on_ensure_session_opened, NULL);
 
-	if (session == NULL) {
-		_secret_session_open (self, cancellable, callback, user_data);
+		/* But each waiter can give up on it, disconnected when res goes away */
+		if (cancellable)
+			waiter->cancelled_sig = g_cancellable_connect (cancellable,
+			                                               G_CALLBACK (on_ensure_session_cancelled),
+			                                               res, NULL);
 
 	} else {
-		res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
-		                                 secret_service_ensure_session);
+		g_mutex_unlock (&self->pv->mutex);
 		g_simple_async_result_complete_in_idle (res);
-		g_object_unref (res);
 	}
+
+	g_object_unref (res);
 }
 
 /**
@@ -1316,17 +2397,31 @@ secret_service_ensure_session_finish (SecretService *self,
 {
 	g_return_val_if_fail (SECRET_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      secret_service_ensure_session), FALSE);
 
-	if (!g_simple_async_result_is_valid (result, G_OBJECT (self),
-	                                     secret_service_ensure_session)) {
-		if (!_secret_session_open_finish (result, error))
-			return FALSE;
-	}
+	if (_secret_util_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error))
+		return FALSE;
 
 	g_return_val_if_fail (self->pv->session != NULL, FALSE);
 	return TRUE;
 }
 
+void
+_secret_service_get_session_stats (SecretService *self,
+                                   guint *opened,
+                                   guint *coalesced)
+{
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+
+	g_mutex_lock (&self->pv->mutex);
+	if (opened)
+		*opened = self->pv->session_opened;
+	if (coalesced)
+		*coalesced = self->pv->session_coalesced;
+	g_mutex_unlock (&self->pv->mutex);
+}
+
 /**
  * secret_service_ensure_session_sync:
  * @self: the secret service
@@ -1393,6 +2488,157 @@ service_lookup_collection (SecretService *self,
 	return collection;
 }
 
+static GHashTable *
+managed_objects_table (GVariant *retval)
+{
+	GHashTable *objects;
+	GVariant *interfaces;
+	GVariant *managed;
+	GVariantIter iter;
+	gchar *path;
+
+	/* Keyed by path, as proxies look themselves up one by one */
+	objects = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                 (GDestroyNotify)g_variant_unref);
+
+	managed = g_variant_get_child_value (retval, 0);
+	g_variant_iter_init (&iter, managed);
+	while (g_variant_iter_next (&iter, "{o@a{sa{sv}}}", &path, &interfaces))
+		g_hash_table_insert (objects, path, interfaces);
+	g_variant_unref (managed);
+
+	return objects;
+}
+
+static gboolean
+managed_objects_unsupported (GError *error)
+{
+	/* The service doesn't implement the ObjectManager interface at all */
+	return g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD) ||
+	       g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE);
+}
+
+static gboolean
+managed_objects_failed (GError *error)
+{
+	/* Some other reply from the service, or one not in the expected form */
+	return g_dbus_error_is_remote_error (error) ||
+	       g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+}
+
+static void
+on_get_managed_objects (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (g_async_result_get_source_object (user_data));
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (retval != NULL) {
+		g_atomic_int_set (&self->pv->object_manager, 1);
+		g_simple_async_result_set_op_res_gpointer (res, managed_objects_table (retval),
+		                                           (GDestroyNotify)g_hash_table_unref);
+		g_variant_unref (retval);
+
+	/* Callers fall back to loading each object, and so do we from now on */
+	} else if (managed_objects_unsupported (error)) {
+		g_atomic_int_set (&self->pv->object_manager, -1);
+		g_error_free (error);
+
+	/* Callers fall back this time, but it's tried again next time */
+	} else if (managed_objects_failed (error)) {
+		g_error_free (error);
+
+	} else {
+		g_simple_async_result_take_error (res, error);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (self);
+	g_object_unref (res);
+}
+
+void
+_secret_service_get_managed_objects (SecretService *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+	GDBusProxy *proxy;
+
+	g_return_if_fail (SECRET_IS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+	                                 _secret_service_get_managed_objects);
+
+	if (g_atomic_int_get (&self->pv->object_manager) < 0) {
+		g_simple_async_result_complete_in_idle (res);
+
+	} else {
+		proxy = G_DBUS_PROXY (self);
+		g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+		                        g_dbus_proxy_get_name (proxy),
+		                        g_dbus_proxy_get_object_path (proxy),
+		                        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects",
+		                        g_variant_new ("()"), G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+		                        G_DBUS_CALL_FLAGS_NONE, -1, cancellable,
+		                        on_get_managed_objects, g_object_ref (res));
+	}
+
+	g_object_unref (res);
+}
+
+GHashTable *
+_secret_service_get_managed_objects_finish (SecretService *self,
+                                            GAsyncResult *result,
+                                            GError **error)
+{
+	GSimpleAsyncResult *res;
+	GHashTable *objects;
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self),
+	                      _secret_service_get_managed_objects), NULL);
+
+	res = G_SIMPLE_ASYNC_RESULT (result);
+	if (_secret_util_propagate_error (res, error))
+		return NULL;
+
+	/* NULL without an error when the service isn't an ObjectManager */
+	objects = g_simple_async_result_get_op_res_gpointer (res);
+	return objects ? g_hash_table_ref (objects) : NULL;
+}
+
+GHashTable *
+_secret_service_get_managed_objects_sync (SecretService *self,
+                                          GCancellable *cancellable,
+                                          GError **error)
+{
+	GHashTable *objects;
+	SecretSync *sync;
+
+	g_return_val_if_fail (SECRET_IS_SERVICE (self), NULL);
+
+	sync = _secret_sync_new ();
+	g_main_context_push_thread_default (sync->context);
+
+	_secret_service_get_managed_objects (self, cancellable,
+	                                     _secret_sync_on_result, sync);
+
+	g_main_loop_run (sync->loop);
+
+	objects = _secret_service_get_managed_objects_finish (self, sync->result, error);
+
+	g_main_context_pop_thread_default (sync->context);
+	_secret_sync_free (sync);
+
+	return objects;
+}
+
 static void
 service_update_collections (SecretService *self,
                             GHashTable *collections)
@@ -1469,6 +2715,96 @@ on_ensure_collection (GObject *source,
 	g_object_unref (res);
 }
 
+static guint
+service_count_missing_collections (SecretService *self)
+{
+	SecretCollection *collection;
+	GVariantIter iter;
+	const gchar *path;
+	GVariant *paths;
+	guint missing = 0;
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
+	g_return_val_if_fail (paths != NULL, 0);
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_next (&iter, "&o", &path)) {
+		collection = service_lookup_collection (self, path);
+		if (collection == NULL)
+			missing++;
+		else
+			g_object_unref (collection);
+	}
+
+	g_variant_unref (paths);
+	return missing;
+}
+
+static void
+service_load_collections_for_objects (SecretService *self,
+                                      GHashTable *objects,
+                                      GSimpleAsyncResult *res)
+{
+	EnsureClosure *closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretCollection *collection;
+	const gchar *path;
+	GVariant *paths;
+	GVariantIter iter;
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
+	g_return_if_fail (paths != NULL);
+
+	g_variant_iter_init (&iter, paths);
+	while (g_variant_iter_loop (&iter, "&o", &path)) {
+		collection = service_lookup_collection (self, path);
+
+		/* No such collection yet create a new one */
+		if (collection == NULL) {
+			if (objects != NULL)
+				_secret_collection_new_for_objects (self, path, objects, SECRET_COLLECTION_LOAD_ITEMS,
+				                                    closure->cancellable, on_ensure_collection,
+				                                    g_object_ref (res));
+			else
+				secret_collection_new_for_dbus_path (self, path, SECRET_COLLECTION_LOAD_ITEMS,
+				                                     closure->cancellable, on_ensure_collection,
+				                                     g_object_ref (res));
+			closure->collections_loading++;
+		} else {
+			g_hash_table_insert (closure->collections, g_strdup (path), collection);
+		}
+	}
+
+	if (closure->collections_loading == 0) {
+		service_update_collections (self, closure->collections);
+		g_simple_async_result_complete_in_idle (res);
+	}
+
+	g_variant_unref (paths);
+}
+
+static void
+on_load_collections_objects (GObject *source,
+                             GAsyncResult *result,
+                             gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	SecretService *self = SECRET_SERVICE (source);
+	GHashTable *objects;
+	GError *error = NULL;
+
+	objects = _secret_service_get_managed_objects_finish (self, result, &error);
+	if (error == NULL) {
+		service_load_collections_for_objects (self, objects, res);
+	} else {
+		g_simple_async_result_take_error (res, error);
+		g_simple_async_result_complete (res);
+	}
+
+	if (objects != NULL)
+		g_hash_table_unref (objects);
+	g_object_unref (res);
+}
+
 /**
  * secret_service_load_collections:
  * @self: the secret service
@@ -1493,18 +2829,11 @@ secret_service_load_collections (SecretService *self,
                                  gpointer user_data)
 {
 	EnsureClosure *closure;
-	SecretCollection *collection;
 	GSimpleAsyncResult *res;
-	const gchar *path;
-	GVariant *paths;
-	GVariantIter iter;
 
 	g_return_if_fail (SECRET_IS_SERVICE (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
-	g_return_if_fail (paths != NULL);
-
 	res = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
 	                                 secret_service_load_collections);
 	closure = g_slice_new0 (EnsureClosure);
@@ -1512,26 +2841,14 @@ secret_service_load_collections (SecretService *self,
 	closure->collections = collections_table_new ();
 	g_simple_async_result_set_op_res_gpointer (res, closure, ensure_closure_free);
 
-	g_variant_iter_init (&iter, paths);
-	while (g_variant_iter_loop (&iter, "&o", &path)) {
-		collection = service_lookup_collection (self, path);
-
-		/* No such collection yet create a new one */
-		if (collection == NULL) {
-			secret_collection_new_for_dbus_path (self, path, SECRET_COLLECTION_LOAD_ITEMS,
-			                                     cancellable, on_ensure_collection, g_object_ref (res));
-			closure->collections_loading++;
-		} else {
-			g_hash_table_insert (closure->collections, g_strdup (path), collection);
-		}
-	}
-
-	if (closure->collections_loading == 0) {
-		service_update_collections (self, closure->collections);
-		g_simple_async_result_complete_in_idle (res);
-	}
+	/* Everything in one round trip, if any collections need loading */
+	if (service_count_missing_collections (self) > 0)
+		_secret_service_get_managed_objects (self, cancellable,
+		                                     on_load_collections_objects,
+		                                     g_object_ref (res));
+	else
+		service_load_collections_for_objects (self, NULL, res);
 
-	g_variant_unref (paths);
 	g_object_unref (res);
 }
 
@@ -1587,7 +2904,9 @@ secret_service_load_collections_sync (SecretService *self,
                                       GError **error)
 {
 	SecretCollection *collection;
+	GHashTable *objects = NULL;
 	GHashTable *collections;
+	GError *local_error = NULL;
 	GVariant *paths;
 	GVariantIter iter;
 	const gchar *path;
@@ -1597,6 +2916,15 @@ secret_service_load_collections_sync (SecretService *self,
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	/* Everything in one round trip, if any collections need loading */
+	if (service_count_missing_collections (self) > 0) {
+		objects = _secret_service_get_managed_objects_sync (self, cancellable, &local_error);
+		if (local_error != NULL) {
+			g_propagate_error (error, local_error);
+			return FALSE;
+		}
+	}
+
 	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (self), "Collections");
 	g_return_val_if_fail (paths != NULL, FALSE);
 
@@ -1608,9 +2936,14 @@ secret_service_load_collections_sync (SecretService *self,
 
 		/* No such collection yet create a new one */
 		if (collection == NULL) {
-			collection = secret_collection_new_for_dbus_path_sync (self, path,
-			                                                       SECRET_COLLECTION_LOAD_ITEMS,
-			                                                       cancellable, error);
+			if (objects != NULL)
+				collection = _secret_collection_new_for_objects_sync (self, path, objects,
+				                                                      SECRET_COLLECTION_LOAD_ITEMS,
+				                                                      cancellable, error);
+			else
+				collection = secret_collection_new_for_dbus_path_sync (self, path,
+				                                                       SECRET_COLLECTION_LOAD_ITEMS,
+				                                                       cancellable, error);
 			if (collection == NULL) {
 				ret = FALSE;
 				break;
@@ -1623,6 +2956,8 @@ secret_service_load_collections_sync (SecretService *self,
 	if (ret)
 		service_update_collections (self, collections);
 
+	if (objects != NULL)
+		g_hash_table_unref (objects);
 	g_hash_table_unref (collections);
 	g_variant_unref (paths);
 	return ret;
@@ -33,6 +33,7 @@ typedef enum {
 	SECRET_SERVICE_NONE = 0,
 	SECRET_SERVICE_OPEN_SESSION = 1 << 1,
 	SECRET_SERVICE_LOAD_COLLECTIONS = 1 << 2,
+	SECRET_SERVICE_CACHE_SEARCHES = 1 << 3,
 } SecretServiceFlags;
 
 typedef enum {
@@ -112,6 +113,8 @@ SecretService *      secret_service_get_sync                      (SecretService
 
 void                 secret_service_disconnect                    (void);
 
+void                 secret_service_set_io_thread                 (gboolean enabled);
+
 void                 secret_service_open                          (GType service_gtype,
                                                                    const gchar *service_bus_name,
                                                                    SecretServiceFlags flags,
@@ -134,6 +137,21 @@ const gchar *        secret_service_get_session_algorithms        (SecretService
 
 GList *              secret_service_get_collections               (SecretService *self);
 
+void                 secret_service_get_search_cache_stats        (SecretService *self,
+                                                                   guint64 *hits,
+                                                                   guint64 *misses,
+                                                                   guint64 *invalidations);
+
+void                 secret_service_set_secret_cache_policy       (SecretService *self,
+                                                                   gssize max_bytes,
+                                                                   guint max_age);
+
+void                 secret_service_get_secret_cache_stats        (SecretService *self,
+                                                                   guint64 *hits,
+                                                                   guint64 *misses,
+                                                                   guint64 *evictions,
+                                                                   gsize *bytes);
+
 void                 secret_service_ensure_session                (SecretService *self,
                                                                    GCancellable *cancellable,
                                                                    GAsyncReadyCallback callback,
@@ -253,6 +271,33 @@ gboolean             secret_service_store_sync                    (SecretService
                                                                    GCancellable *cancellable,
                                                                    GError **error);
 
+void                 secret_service_store_many                    (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable **attributes,
+                                                                   const gchar **labels,
+                                                                   SecretValue **values,
+                                                                   guint n_items,
+                                                                   const gchar *collection,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+gboolean             secret_service_store_many_finish             (SecretService *service,
+                                                                   GAsyncResult *result,
+                                                                   GPtrArray **errors,
+                                                                   GError **error);
+
+gboolean             secret_service_store_many_sync               (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable **attributes,
+                                                                   const gchar **labels,
+                                                                   SecretValue **values,
+                                                                   guint n_items,
+                                                                   const gchar *collection,
+                                                                   GCancellable *cancellable,
+                                                                   GPtrArray **errors,
+                                                                   GError **error);
+
 void                 secret_service_lookup                        (SecretService *service,
                                                                    const SecretSchema *schema,
                                                                    GHashTable *attributes,
@@ -287,6 +332,36 @@ gboolean             secret_service_clear_sync                    (SecretService
                                                                    GCancellable *cancellable,
                                                                    GError **error);
 
+typedef void      (* SecretClearProgressFunc)                     (guint cleared,
+                                                                   guint total,
+                                                                   gpointer user_data);
+
+void                 secret_service_clear_full                    (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   guint max_in_flight,
+                                                                   SecretClearProgressFunc progress,
+                                                                   gpointer progress_data,
+                                                                   GDestroyNotify progress_destroy,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+gboolean             secret_service_clear_full_finish             (SecretService *service,
+                                                                   GAsyncResult *result,
+                                                                   guint *cleared,
+                                                                   GError **error);
+
+gboolean             secret_service_clear_full_sync               (SecretService *service,
+                                                                   const SecretSchema *schema,
+                                                                   GHashTable *attributes,
+                                                                   guint max_in_flight,
+                                                                   SecretClearProgressFunc progress,
+                                                                   gpointer progress_data,
+                                                                   GCancellable *cancellable,
+                                                                   guint *cleared,
+                                                                   GError **error);
+
 void                 secret_service_set_alias                     (SecretService *service,
                                                                    const gchar *alias,
                                                                    SecretCollection *collection,
@@ -33,6 +33,20 @@ EGG_SECURE_DECLARE (secret_session);
 #define ALGORITHMS_AES    "dh-ietf1024-sha256-aes128-cbc-pkcs7"
 #define ALGORITHMS_PLAIN  "plain"
 
+/* X25519 needs gcry_ecc_mul_point() from libgcrypt 1.9 */
+#if defined (WITH_GCRYPT) && defined (HAVE_GCRY_ECC_MUL_POINT)
+#define WITH_X25519 1
+#define ALGORITHMS_X25519 "x25519-sha256-aes128-cbc-pkcs7"
+#define ALGORITHMS_X25519_GCM "x25519-sha256-aes128-gcm"
+#define X25519_KEY_SIZE   32
+#endif
+
+#define GCM_NONCE_SIZE    12
+#define GCM_TAG_SIZE      16
+
+/* When opted in, plain secrets this large refer to the reply rather than being copied */
+#define PLAIN_BORROW_SIZE 4096
+
 struct _SecretSession {
 	gchar *path;
 	const gchar *algorithms;
@@ -40,9 +54,16 @@ struct _SecretSession {
 	gcry_mpi_t prime;
 	gcry_mpi_t privat;
 	gcry_mpi_t publi;
+	gpointer ecdh_privat;
+
+	/* Keyed once the session is negotiated, protected by mutex */
+	GMutex mutex;
+	gcry_cipher_hd_t cih;
+	gboolean aead;
 #endif
 	gpointer key;
 	gsize n_key;
+	gboolean borrow_plain;
 };
 
 void
@@ -58,6 +79,10 @@ _secret_session_free (gpointer data)
 	gcry_mpi_release (session->publi);
 	gcry_mpi_release (session->privat);
 	gcry_mpi_release (session->prime);
+	egg_secure_free (session->ecdh_privat);
+	if (session->cih)
+		gcry_cipher_close (session->cih);
+	g_mutex_clear (&session->mutex);
 #endif
 	egg_secure_free (session->key);
 	g_free (session);
@@ -65,38 +90,275 @@ _secret_session_free (gpointer data)
 
 #ifdef WITH_GCRYPT
 
-static GVariant *
-request_open_session_aes (SecretSession *session)
+static gboolean
+generate_session_pair (gcry_mpi_t *prime,
+                       gcry_mpi_t *publi,
+                       gcry_mpi_t *privat)
 {
-	gcry_error_t gcry;
 	gcry_mpi_t base;
-	unsigned char *buffer;
-	size_t n_buffer;
-	GVariant *argument;
-
-	g_assert (session->prime == NULL);
-	g_assert (session->privat == NULL);
-	g_assert (session->publi == NULL);
 
 	egg_libgcrypt_initialize ();
 
 	/* Initialize our local parameters and values */
-	if (!egg_dh_default_params ("ietf-ike-grp-modp-1024",
-	                            &session->prime, &base))
-		g_return_val_if_reached (NULL);
+	if (!egg_dh_default_params ("ietf-ike-grp-modp-1024", prime, &base))
+		return FALSE;
 
 #if 0
 	g_printerr ("\n lib prime: ");
-	gcry_mpi_dump (session->prime);
+	gcry_mpi_dump (*prime);
 	g_printerr ("\n  lib base: ");
 	gcry_mpi_dump (base);
 	g_printerr ("\n");
 #endif
 
-	if (!egg_dh_gen_pair (session->prime, base, 0,
-	                      &session->publi, &session->privat))
-		g_return_val_if_reached (NULL);
+	if (!egg_dh_gen_pair (*prime, base, 0, publi, privat)) {
+		gcry_mpi_release (*prime);
+		gcry_mpi_release (base);
+		*prime = NULL;
+		return FALSE;
+	}
+
 	gcry_mpi_release (base);
+	return TRUE;
+}
+
+/*
+ * At most one spare key pair is generated ahead of time, on a background
+ * thread, so that opening a session only needs to derive the shared secret.
+ * This is only done when the SECRET_SESSION_PREGENERATE environment variable
+ * is set, and starts as soon as a service is initialized, unless a service
+ * already negotiated a session that doesn't fall back to such a key pair.
+ */
+
+static GMutex pregenerate_mutex;
+static GCond pregenerate_cond;
+static gboolean pregenerating = FALSE;
+static gcry_mpi_t pregenerated_prime = NULL;
+static gcry_mpi_t pregenerated_publi = NULL;
+static gcry_mpi_t pregenerated_privat = NULL;
+static gint pregenerate_wanted = 1;
+static gint pregenerate_forced = -1;
+static guint pregenerate_taken = 0;
+static guint pregenerate_missed = 0;
+
+static gboolean
+pregenerate_enabled (void)
+{
+	static gsize enabled = 0;
+	const gchar *env;
+	gint forced;
+
+	forced = g_atomic_int_get (&pregenerate_forced);
+	if (forced >= 0)
+		return forced;
+
+	if (g_once_init_enter (&enabled)) {
+		env = g_getenv ("SECRET_SESSION_PREGENERATE");
+		g_once_init_leave (&enabled, (env && env[0] && !g_str_equal (env, "0")) ? 2 : 1);
+	}
+
+	return enabled == 2;
+}
+
+static gpointer
+pregenerate_thread (gpointer unused)
+{
+	gcry_mpi_t prime = NULL;
+	gcry_mpi_t publi = NULL;
+	gcry_mpi_t privat = NULL;
+
+	if (!generate_session_pair (&prime, &publi, &privat))
+		g_warning ("couldn't generate session key pair in the background");
+
+	g_mutex_lock (&pregenerate_mutex);
+	g_assert (pregenerated_prime == NULL);
+	pregenerated_prime = prime;
+	pregenerated_publi = publi;
+	pregenerated_privat = privat;
+	pregenerating = FALSE;
+	g_cond_broadcast (&pregenerate_cond);
+	g_mutex_unlock (&pregenerate_mutex);
+
+	return NULL;
+}
+
+static gboolean
+take_pregenerated_pair (gcry_mpi_t *prime,
+                        gcry_mpi_t *publi,
+                        gcry_mpi_t *privat)
+{
+	gboolean ret = FALSE;
+
+	g_mutex_lock (&pregenerate_mutex);
+
+	/* A key pair still underway is left for the next session */
+	if (pregenerated_prime != NULL) {
+		*prime = pregenerated_prime;
+		*publi = pregenerated_publi;
+		*privat = pregenerated_privat;
+		pregenerated_prime = pregenerated_publi = pregenerated_privat = NULL;
+		pregenerate_taken++;
+		ret = TRUE;
+	} else {
+		pregenerate_missed++;
+	}
+
+	g_mutex_unlock (&pregenerate_mutex);
+
+	return ret;
+}
+
+#endif /* WITH_GCRYPT */
+
+/*
+ * Start generating a session key pair in the background, if enabled, if the
+ * next session may still need such a key pair, and if there isn't already a
+ * spare one available.
+ */
+void
+_secret_session_pregenerate (void)
+{
+#ifdef WITH_GCRYPT
+	GThread *thread;
+	GError *error = NULL;
+
+	if (!pregenerate_enabled () || !g_atomic_int_get (&pregenerate_wanted))
+		return;
+
+	g_mutex_lock (&pregenerate_mutex);
+
+	if (!pregenerating && pregenerated_prime == NULL) {
+		thread = g_thread_try_new ("secret-session", pregenerate_thread, NULL, &error);
+		if (thread == NULL) {
+			g_warning ("couldn't start session key pair thread: %s", error->message);
+			g_error_free (error);
+		} else {
+			pregenerating = TRUE;
+			g_thread_unref (thread);
+		}
+	}
+
+	g_mutex_unlock (&pregenerate_mutex);
+#endif /* WITH_GCRYPT */
+}
+
+/*
+ * Overrides SECRET_SESSION_PREGENERATE, used by the tests. Any spare key
+ * pair and the statistics are thrown away.
+ */
+void
+_secret_session_set_pregenerate (gboolean enabled)
+{
+#ifdef WITH_GCRYPT
+	g_mutex_lock (&pregenerate_mutex);
+
+	while (pregenerating)
+		g_cond_wait (&pregenerate_cond, &pregenerate_mutex);
+
+	gcry_mpi_release (pregenerated_prime);
+	gcry_mpi_release (pregenerated_publi);
+	gcry_mpi_release (pregenerated_privat);
+	pregenerated_prime = pregenerated_publi = pregenerated_privat = NULL;
+	pregenerate_taken = pregenerate_missed = 0;
+	g_atomic_int_set (&pregenerate_wanted, 1);
+	g_atomic_int_set (&pregenerate_forced, enabled ? 1 : 0);
+
+	g_mutex_unlock (&pregenerate_mutex);
+#endif /* WITH_GCRYPT */
+}
+
+void
+_secret_session_get_pregenerate_stats (guint *taken,
+                                       guint *missed,
+                                       gboolean *pending,
+                                       gboolean *ready)
+{
+#ifdef WITH_GCRYPT
+	g_mutex_lock (&pregenerate_mutex);
+	if (taken)
+		*taken = pregenerate_taken;
+	if (missed)
+		*missed = pregenerate_missed;
+	if (pending)
+		*pending = pregenerating || pregenerated_prime != NULL;
+	if (ready)
+		*ready = pregenerated_prime != NULL;
+	g_mutex_unlock (&pregenerate_mutex);
+#else
+	if (taken)
+		*taken = 0;
+	if (missed)
+		*missed = 0;
+	if (pending)
+		*pending = FALSE;
+	if (ready)
+		*ready = FALSE;
+#endif /* WITH_GCRYPT */
+}
+
+#ifdef WITH_GCRYPT
+
+static gboolean
+session_open_cipher (SecretSession *session,
+                     gcry_cipher_hd_t *cih)
+{
+	gcry_error_t gcry;
+
+	gcry = gcry_cipher_open (cih, GCRY_CIPHER_AES,
+	                         session->aead ? GCRY_CIPHER_MODE_GCM : GCRY_CIPHER_MODE_CBC,
+	                         GCRY_CIPHER_SECURE);
+	if (gcry != 0) {
+		g_warning ("couldn't create AES cipher: %s", gcry_strerror (gcry));
+		*cih = NULL;
+		return FALSE;
+	}
+
+	gcry = gcry_cipher_setkey (*cih, session->key, session->n_key);
+	if (gcry != 0) {
+		g_warning ("couldn't set AES key: %s", gcry_strerror (gcry));
+		gcry_cipher_close (*cih);
+		*cih = NULL;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+session_derive_key (SecretSession *session,
+                    gpointer ikm,
+                    gsize n_ikm)
+{
+	gboolean ret;
+
+	session->n_key = 16;
+	session->key = egg_secure_alloc (session->n_key);
+	ret = egg_hkdf_perform ("sha256", ikm, n_ikm, NULL, 0, NULL, 0,
+	                        session->key, session->n_key);
+	egg_secure_free (ikm);
+	g_return_val_if_fail (ret, FALSE);
+
+	/* The cipher is reused for every secret sent or received in this session */
+	return session_open_cipher (session, &session->cih);
+}
+
+static GVariant *
+request_open_session_aes (SecretSession *session)
+{
+	gcry_error_t gcry;
+	unsigned char *buffer;
+	size_t n_buffer;
+	GVariant *argument;
+
+	g_assert (session->prime == NULL);
+	g_assert (session->privat == NULL);
+	g_assert (session->publi == NULL);
+
+	/* Use a key pair generated in the background, or generate it now */
+	if (!take_pregenerated_pair (&session->prime, &session->publi, &session->privat)) {
+		if (!generate_session_pair (&session->prime, &session->publi, &session->privat))
+			g_return_val_if_reached (NULL);
+	}
 
 	gcry = gcry_mpi_aprint (GCRYMPI_FMT_USG, &buffer, &n_buffer, session->publi);
 	g_return_val_if_fail (gcry == 0, NULL);
@@ -158,17 +420,114 @@ response_open_session_aes (SecretSession *session,
 		return FALSE;
 	}
 
-	session->n_key = 16;
-	session->key = egg_secure_alloc (session->n_key);
-	if (!egg_hkdf_perform ("sha256", ikm, n_ikm, NULL, 0, NULL, 0,
-	                       session->key, session->n_key))
-		g_return_val_if_reached (FALSE);
-	egg_secure_free (ikm);
+	if (!session_derive_key (session, ikm, n_ikm))
+		return FALSE;
+
+	/* The service wants these, start on the key pair for the next session */
+	g_atomic_int_set (&pregenerate_wanted, 1);
+	_secret_session_pregenerate ();
 
 	session->algorithms = ALGORITHMS_AES;
 	return TRUE;
 }
 
+#ifdef WITH_X25519
+
+static GVariant *
+request_open_session_x25519 (SecretSession *session,
+                             const gchar *algorithms)
+{
+	gcry_error_t gcry;
+	guchar *publi;
+	GVariant *argument;
+
+	egg_libgcrypt_initialize ();
+
+	/* The same key is offered again when falling back */
+	if (session->ecdh_privat == NULL) {
+		session->ecdh_privat = egg_secure_alloc (X25519_KEY_SIZE);
+		gcry_randomize (session->ecdh_privat, X25519_KEY_SIZE, GCRY_STRONG_RANDOM);
+	}
+
+	publi = g_malloc (X25519_KEY_SIZE);
+	gcry = gcry_ecc_mul_point (GCRY_ECC_CURVE25519, publi, session->ecdh_privat, NULL);
+	if (gcry != 0) {
+		g_warning ("couldn't generate X25519 key: %s", gcry_strerror (gcry));
+		g_free (publi);
+		return NULL;
+	}
+
+	argument = g_variant_new_from_data (G_VARIANT_TYPE ("ay"),
+	                                    publi, X25519_KEY_SIZE, TRUE,
+	                                    g_free, publi);
+
+	session->algorithms = algorithms;
+	session->aead = g_str_equal (algorithms, ALGORITHMS_X25519_GCM);
+	return g_variant_new ("(sv)", algorithms, argument);
+}
+
+static gboolean
+response_open_session_x25519 (SecretSession *session,
+                              GVariant *response)
+{
+	gconstpointer peer;
+	GVariant *argument;
+	const gchar *sig;
+	gsize n_peer;
+	gcry_error_t gcry;
+	guchar *ikm;
+	guchar check;
+	gsize i;
+
+	sig = g_variant_get_type_string (response);
+	g_return_val_if_fail (sig != NULL, FALSE);
+
+	if (!g_str_equal (sig, "(vo)")) {
+		g_warning ("invalid OpenSession() response from daemon with signature: %s", sig);
+		return FALSE;
+	}
+
+	g_assert (session->path == NULL);
+	g_variant_get (response, "(vo)", &argument, &session->path);
+
+	if (!g_variant_is_of_type (argument, G_VARIANT_TYPE ("ay"))) {
+		g_warning ("invalid OpenSession() argument from daemon");
+		g_variant_unref (argument);
+		return FALSE;
+	}
+
+	peer = g_variant_get_fixed_array (argument, &n_peer, sizeof (guchar));
+	ikm = egg_secure_alloc (X25519_KEY_SIZE);
+	if (n_peer == X25519_KEY_SIZE)
+		gcry = gcry_ecc_mul_point (GCRY_ECC_CURVE25519, ikm, session->ecdh_privat, peer);
+	else
+		gcry = GPG_ERR_INV_LENGTH;
+	g_variant_unref (argument);
+
+	egg_secure_free (session->ecdh_privat);
+	session->ecdh_privat = NULL;
+
+	/* An all zero result means the peer sent a low order point */
+	for (i = 0, check = 0; i < X25519_KEY_SIZE; i++)
+		check |= ikm[i];
+
+	if (gcry != 0 || check == 0) {
+		g_warning ("couldn't negotiate a valid X25519 session key");
+		egg_secure_free (ikm);
+		g_free (session->path);
+		session->path = NULL;
+		return FALSE;
+	}
+
+	/* No use for a spare key pair with these */
+	g_atomic_int_set (&pregenerate_wanted, 0);
+
+	/* The algorithms were chosen in the request */
+	return session_derive_key (session, ikm, X25519_KEY_SIZE);
+}
+
+#endif /* WITH_X25519 */
+
 #endif /* WITH_GCRYPT */
 
 static GVariant *
@@ -304,6 +663,70 @@ on_service_open_session_aes (GObject *source,
 	g_object_unref (res);
 }
 
+#ifdef WITH_X25519
+
+static void
+on_service_open_session_x25519 (GObject *source,
+                                GAsyncResult *result,
+                                gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	OpenSessionClosure * closure = g_simple_async_result_get_op_res_gpointer (res);
+	SecretService *service = SECRET_SERVICE (source);
+	GError *error = NULL;
+	GVariant *response;
+
+	response =  g_dbus_proxy_call_finish (G_DBUS_PROXY (service), result, &error);
+
+	/* A successful response, decode it */
+	if (response != NULL) {
+		if (response_open_session_x25519 (closure->session, response)) {
+			_secret_service_take_session (service, closure->session);
+			closure->session = NULL;
+
+		} else {
+			g_simple_async_result_set_error (res, SECRET_ERROR, SECRET_ERROR_PROTOCOL,
+			                                 _("Couldn't communicate with the secret storage"));
+		}
+
+		g_simple_async_result_complete (res);
+		g_variant_unref (response);
+
+	} else {
+		/* AES-GCM not supported, request the same key agreement with CBC */
+		if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED) &&
+		    closure->session->aead) {
+			g_dbus_proxy_call (G_DBUS_PROXY (source), "OpenSession",
+			                   request_open_session_x25519 (closure->session, ALGORITHMS_X25519),
+			                   G_DBUS_CALL_FLAGS_NONE, -1,
+			                   closure->cancellable, on_service_open_session_x25519,
+			                   g_object_ref (res));
+			g_error_free (error);
+
+		/* X25519 session not supported, request a DH session */
+		} else if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED)) {
+			closure->session->aead = FALSE;
+			egg_secure_free (closure->session->ecdh_privat);
+			closure->session->ecdh_privat = NULL;
+			g_dbus_proxy_call (G_DBUS_PROXY (source), "OpenSession",
+			                   request_open_session_aes (closure->session),
+			                   G_DBUS_CALL_FLAGS_NONE, -1,
+			                   closure->cancellable, on_service_open_session_aes,
+			                   g_object_ref (res));
+			g_error_free (error);
+
+		/* Other errors result in a failure */
+		} else {
+			g_simple_async_result_take_error (res, error);
+			g_simple_async_result_complete (res);
+		}
+	}
+
+	g_object_unref (res);
+}
+
+#endif /* WITH_X25519 */
+
 #endif /* WITH_GCRYPT */
 
 
@@ -315,14 +738,40 @@ _secret_session_open (SecretService *service,
 {
 	GSimpleAsyncResult *res;
 	OpenSessionClosure *closure;
+#ifdef WITH_X25519
+	GVariant *request;
+#endif
 
 	res = g_simple_async_result_new (G_OBJECT (service), callback, user_data,
 	                                 _secret_session_open);
 	closure = g_new (OpenSessionClosure, 1);
 	closure->cancellable = cancellable ? g_object_ref (cancellable) : cancellable;
 	closure->session = g_new0 (SecretSession, 1);
+#ifdef WITH_GCRYPT
+	g_mutex_init (&closure->session->mutex);
+#endif
+
+	/*
+	 * Plain secrets of PLAIN_BORROW_SIZE or more only refer to the reply,
+	 * in pageable memory, when SECRET_PLAIN_BORROW is set as the session
+	 * is opened. Only sensible over a trusted transport.
+	 */
+	closure->session->borrow_plain = g_getenv ("SECRET_PLAIN_BORROW") != NULL;
 	g_simple_async_result_set_op_res_gpointer (res, closure, open_session_closure_free);
 
+#ifdef WITH_X25519
+	/* Try the fastest key agreement first, and fall back from there */
+	request = request_open_session_x25519 (closure->session, ALGORITHMS_X25519_GCM);
+	if (request != NULL) {
+		g_dbus_proxy_call (G_DBUS_PROXY (service), "OpenSession", request,
+		                   G_DBUS_CALL_FLAGS_NONE, -1,
+		                   cancellable, on_service_open_session_x25519,
+		                   g_object_ref (res));
+		g_object_unref (res);
+		return;
+	}
+#endif
+
 	g_dbus_proxy_call (G_DBUS_PROXY (service), "OpenSession",
 #ifdef WITH_GCRYPT
 	                   request_open_session_aes (closure->session),
@@ -382,17 +831,16 @@ pkcs7_unpad_bytes_in_place (guchar *padded,
 
 static SecretValue *
 service_decode_aes_secret (SecretSession *session,
+                           gcry_cipher_hd_t cih,
                            gconstpointer param,
                            gsize n_param,
                            gconstpointer value,
                            gsize n_value,
                            const gchar *content_type)
 {
-	gcry_cipher_hd_t cih;
 	gsize n_padded;
 	gcry_error_t gcry;
 	guchar *padded;
-	gsize pos;
 
 	if (n_param != 16) {
 		g_message ("received an encrypted secret structure with invalid parameter");
@@ -404,38 +852,36 @@ service_decode_aes_secret (SecretSession *session,
 		return NULL;
 	}
 
-	gcry = gcry_cipher_open (&cih, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CBC, 0);
-	if (gcry != 0) {
-		g_warning ("couldn't create AES cipher: %s", gcry_strerror (gcry));
-		return NULL;
-	}
+	g_return_val_if_fail (cih != NULL || session->cih != NULL, NULL);
 
 #if 0
 	g_printerr ("    lib iv:  %s\n", egg_hex_encode (param, n_param));
-#endif
-
-	gcry = gcry_cipher_setiv (cih, param, n_param);
-	g_return_val_if_fail (gcry == 0, NULL);
-
-#if 0
 	g_printerr ("   lib key:  %s\n", egg_hex_encode (session->key, session->n_key));
 #endif
 
-	gcry = gcry_cipher_setkey (cih, session->key, session->n_key);
-	g_return_val_if_fail (gcry == 0, NULL);
-
-	/* Copy the memory buffer */
+	/* Allocate the memory buffer */
 	n_padded = n_value;
 	padded = egg_secure_alloc (n_padded);
-	memcpy (padded, value, n_padded);
 
-	/* Perform the decryption */
-	for (pos = 0; pos < n_padded; pos += 16) {
-		gcry = gcry_cipher_decrypt (cih, (guchar*)padded + pos, 16, NULL, 0);
-		g_return_val_if_fail (gcry == 0, FALSE);
+	/* Decrypt straight out of the message, in one pass */
+	if (cih != NULL) {
+		gcry = gcry_cipher_setiv (cih, param, n_param);
+		if (gcry == 0)
+			gcry = gcry_cipher_decrypt (cih, padded, n_padded, value, n_value);
+	} else {
+		g_mutex_lock (&session->mutex);
+		gcry = gcry_cipher_setiv (session->cih, param, n_param);
+		if (gcry == 0)
+			gcry = gcry_cipher_decrypt (session->cih, padded, n_padded, value, n_value);
+		g_mutex_unlock (&session->mutex);
 	}
 
-	gcry_cipher_close (cih);
+	if (gcry != 0) {
+		egg_secure_clear (padded, n_padded);
+		egg_secure_free (padded);
+		g_warning ("couldn't decrypt AES secret: %s", gcry_strerror (gcry));
+		return NULL;
+	}
 
 	/* Unpad the resulting value */
 	if (!pkcs7_unpad_bytes_in_place (padded, &n_padded)) {
@@ -448,41 +894,108 @@ service_decode_aes_secret (SecretSession *session,
 	return secret_value_new_full ((gchar *)padded, n_padded, content_type, egg_secure_free);
 }
 
+static SecretValue *
+service_decode_gcm_secret (SecretSession *session,
+                           gcry_cipher_hd_t cih,
+                           gconstpointer param,
+                           gsize n_param,
+                           gconstpointer value,
+                           gsize n_value,
+                           const gchar *content_type)
+{
+	const guchar *tag;
+	gcry_error_t gcry;
+	guchar *plain;
+	gsize n_plain;
+
+	if (n_param != GCM_NONCE_SIZE) {
+		g_message ("received an encrypted secret structure with invalid parameter");
+		return NULL;
+	}
+
+	if (n_value < GCM_TAG_SIZE) {
+		g_message ("received an encrypted secret structure with bad secret length");
+		return NULL;
+	}
+
+	/* The authentication tag follows the cipher text */
+	n_plain = n_value - GCM_TAG_SIZE;
+	tag = (const guchar *)value + n_plain;
+
+	/* Null terminated as a courtesy */
+	plain = egg_secure_alloc (n_plain + 1);
+
+	if (cih == NULL)
+		g_mutex_lock (&session->mutex);
+	gcry = gcry_cipher_setiv (cih ? cih : session->cih, param, n_param);
+	if (gcry == 0)
+		gcry = gcry_cipher_decrypt (cih ? cih : session->cih, plain, n_plain, value, n_plain);
+	if (gcry == 0)
+		gcry = gcry_cipher_checktag (cih ? cih : session->cih, tag, GCM_TAG_SIZE);
+	if (cih == NULL)
+		g_mutex_unlock (&session->mutex);
+
+	if (gcry != 0) {
+		egg_secure_clear (plain, n_plain + 1);
+		egg_secure_free (plain);
+		g_message ("received an invalid or unauthenticated secret");
+		return NULL;
+	}
+
+	plain[n_plain] = 0;
+	return secret_value_new_full ((gchar *)plain, n_plain, content_type, egg_secure_free);
+}
+
 #endif /* WITH_GCRYPT */
 
 static SecretValue *
 service_decode_plain_secret (SecretSession *session,
                              gconstpointer param,
                              gsize n_param,
-                             gconstpointer value,
-                             gsize n_value,
+                             GVariant *vvalue,
                              const gchar *content_type)
 {
+	SecretValue *result;
+	GBytes *bytes;
+
 	if (n_param != 0) {
 		g_message ("received a plain secret structure with invalid parameter");
 		return NULL;
 	}
 
-	return secret_value_new (value, n_value, content_type);
+	/*
+	 * When the caller opted in, large secrets refer to the reply buffer
+	 * directly, which is ordinary pageable memory. Otherwise, and for small
+	 * ones such as passwords, they're copied into secure memory where they
+	 * are null-terminated as callers expect.
+	 */
+	if (!session->borrow_plain || g_variant_get_size (vvalue) < PLAIN_BORROW_SIZE) {
+		return secret_value_new (g_variant_get_data (vvalue),
+		                         g_variant_get_size (vvalue), content_type);
+	}
+
+	bytes = g_variant_get_data_as_bytes (vvalue);
+	result = secret_value_new_for_bytes (bytes, content_type);
+	g_bytes_unref (bytes);
+
+	return result;
 }
 
-SecretValue *
-_secret_session_decode_secret (SecretSession *session,
-                               GVariant *encoded)
+static SecretValue *
+session_decode_secret (SecretSession *session,
+#ifdef WITH_GCRYPT
+                       gcry_cipher_hd_t cih,
+#endif
+                       GVariant *encoded)
 {
 	SecretValue *result;
 	gconstpointer param;
-	gconstpointer value;
 	gchar *session_path;
 	gchar *content_type;
 	gsize n_param;
-	gsize n_value;
 	GVariant *vparam;
 	GVariant *vvalue;
 
-	g_return_val_if_fail (session != NULL, NULL);
-	g_return_val_if_fail (encoded != NULL, NULL);
-
 	/* Parsing (oayays) */
 	g_variant_get_child (encoded, 0, "o", &session_path);
 
@@ -496,17 +1009,24 @@ _secret_session_decode_secret (SecretSession *session,
 	vparam = g_variant_get_child_value (encoded, 1);
 	param = g_variant_get_fixed_array (vparam, &n_param, sizeof (guchar));
 	vvalue = g_variant_get_child_value (encoded, 2);
-	value = g_variant_get_fixed_array (vvalue, &n_value, sizeof (guchar));
 	g_variant_get_child (encoded, 3, "s", &content_type);
 
 #ifdef WITH_GCRYPT
-	if (session->key != NULL)
-		result = service_decode_aes_secret (session, param, n_param,
-		                                    value, n_value, content_type);
-	else
+	if (session->key != NULL) {
+		gconstpointer value;
+		gsize n_value;
+
+		value = g_variant_get_fixed_array (vvalue, &n_value, sizeof (guchar));
+		if (session->aead)
+			result = service_decode_gcm_secret (session, cih, param, n_param,
+			                                    value, n_value, content_type);
+		else
+			result = service_decode_aes_secret (session, cih, param, n_param,
+			                                    value, n_value, content_type);
+	} else
 #endif
 		result = service_decode_plain_secret (session, param, n_param,
-		                                      value, n_value, content_type);
+		                                      vvalue, content_type);
 
 	g_variant_unref (vparam);
 	g_variant_unref (vvalue);
@@ -516,6 +1036,176 @@ _secret_session_decode_secret (SecretSession *session,
 	return result;
 }
 
+SecretValue *
+_secret_session_decode_secret (SecretSession *session,
+                               GVariant *encoded)
+{
+	g_return_val_if_fail (session != NULL, NULL);
+	g_return_val_if_fail (encoded != NULL, NULL);
+
+#ifdef WITH_GCRYPT
+	return session_decode_secret (session, NULL, encoded);
+#else
+	return session_decode_secret (session, encoded);
+#endif
+}
+
+#ifdef WITH_GCRYPT
+
+/* Number of secrets handed to a worker thread at a time */
+#define DECODE_CHUNK_SIZE 64
+
+typedef struct {
+	SecretSession *session;
+	GVariant **encoded;
+	SecretValue **decoded;
+	GMutex mutex;
+	GCond cond;
+	guint outstanding;
+} DecodeBatch;
+
+typedef struct {
+	DecodeBatch *batch;
+	gsize offset;
+	gsize count;
+} DecodeChunk;
+
+static void
+on_decode_chunk (gpointer data,
+                 gpointer user_data)
+{
+	DecodeChunk *chunk = data;
+	DecodeBatch *batch = chunk->batch;
+	SecretSession *session = batch->session;
+	gcry_cipher_hd_t cih = NULL;
+	gsize i;
+
+	/* Each worker uses its own cipher, so they don't contend on the session */
+	session_open_cipher (session, &cih);
+
+	for (i = chunk->offset; i < chunk->offset + chunk->count; i++)
+		batch->decoded[i] = session_decode_secret (session, cih, batch->encoded[i]);
+
+	if (cih != NULL)
+		gcry_cipher_close (cih);
+
+	g_mutex_lock (&batch->mutex);
+	batch->outstanding--;
+	g_cond_signal (&batch->cond);
+	g_mutex_unlock (&batch->mutex);
+
+	g_slice_free (DecodeChunk, chunk);
+}
+
+static gpointer
+decode_pool_new (gpointer unused)
+{
+	gint max_threads;
+
+	max_threads = CLAMP (g_get_num_processors (), 1, 8);
+	return g_thread_pool_new (on_decode_chunk, NULL, max_threads, FALSE, NULL);
+}
+
+static gsize
+decode_parallel_threshold (void)
+{
+	static gsize threshold = 0;
+	const gchar *env;
+	gsize value;
+
+	if (g_once_init_enter (&threshold)) {
+		value = 256 * 1024;
+		env = g_getenv ("SECRET_DECODE_PARALLEL_THRESHOLD");
+		if (env != NULL)
+			value = MAX (g_ascii_strtoull (env, NULL, 10), 1);
+		g_once_init_leave (&threshold, value);
+	}
+
+	return threshold;
+}
+
+static void
+session_decode_secrets_parallel (SecretSession *session,
+                                 GVariant **encoded,
+                                 SecretValue **decoded,
+                                 gsize count)
+{
+	static GOnce decode_pool = G_ONCE_INIT;
+	DecodeChunk *chunk;
+	DecodeBatch batch;
+	GError *error = NULL;
+	GThreadPool *pool;
+	gsize offset;
+
+	pool = g_once (&decode_pool, decode_pool_new, NULL);
+
+	batch.session = session;
+	batch.encoded = encoded;
+	batch.decoded = decoded;
+	batch.outstanding = 0;
+	g_mutex_init (&batch.mutex);
+	g_cond_init (&batch.cond);
+
+	for (offset = 0; offset < count; offset += DECODE_CHUNK_SIZE) {
+		chunk = g_slice_new (DecodeChunk);
+		chunk->batch = &batch;
+		chunk->offset = offset;
+		chunk->count = MIN (DECODE_CHUNK_SIZE, count - offset);
+
+		g_mutex_lock (&batch.mutex);
+		batch.outstanding++;
+		g_mutex_unlock (&batch.mutex);
+
+		if (!g_thread_pool_push (pool, chunk, &error)) {
+			g_warning ("couldn't decode secrets in parallel: %s", error->message);
+			g_clear_error (&error);
+			on_decode_chunk (chunk, NULL);
+		}
+	}
+
+	/* Each chunk fills in its own slots, so the result order is stable */
+	g_mutex_lock (&batch.mutex);
+	while (batch.outstanding > 0)
+		g_cond_wait (&batch.cond, &batch.mutex);
+	g_mutex_unlock (&batch.mutex);
+
+	g_mutex_clear (&batch.mutex);
+	g_cond_clear (&batch.cond);
+}
+
+#endif /* WITH_GCRYPT */
+
+/*
+ * Decode @count encoded secrets into @decoded, in the same order. Slots
+ * for secrets that could not be decoded are set to %NULL. Large batches
+ * of AES encrypted secrets, over @n_total bytes in size, are spread
+ * across a pool of worker threads.
+ */
+void
+_secret_session_decode_secrets (SecretSession *session,
+                                GVariant **encoded,
+                                SecretValue **decoded,
+                                gsize count,
+                                gsize n_total)
+{
+	gsize i;
+
+	g_return_if_fail (session != NULL);
+	g_return_if_fail (encoded != NULL || count == 0);
+	g_return_if_fail (decoded != NULL || count == 0);
+
+#ifdef WITH_GCRYPT
+	if (session->key != NULL && count > DECODE_CHUNK_SIZE &&
+	    n_total >= decode_parallel_threshold ()) {
+		session_decode_secrets_parallel (session, encoded, decoded, count);
+		return;
+	}
+#endif
+
+	for (i = 0; i < count; i++)
+		decoded[i] = _secret_session_decode_secret (session, encoded[i]);
+}
+
 #ifdef WITH_GCRYPT
 
 static guchar*
@@ -543,23 +1233,17 @@ service_encode_aes_secret (SecretSession *session,
                            SecretValue *value,
                            GVariantBuilder *builder)
 {
-	gcry_cipher_hd_t cih;
 	guchar *padded;
-	gsize n_padded, pos;
+	gsize n_padded;
 	gcry_error_t gcry;
 	gpointer iv;
 	gconstpointer secret;
 	gsize n_secret;
 	GVariant *child;
 
-	g_variant_builder_add (builder, "o", session->path);
+	g_return_val_if_fail (session->cih != NULL, FALSE);
 
-	/* Create the cipher */
-	gcry = gcry_cipher_open (&cih, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CBC, 0);
-	if (gcry != 0) {
-		g_warning ("couldn't create AES cipher: %s", gcry_strerror (gcry));
-		return FALSE;
-	}
+	g_variant_builder_add (builder, "o", session->path);
 
 	secret = secret_value_get (value, &n_secret);
 
@@ -570,21 +1254,22 @@ service_encode_aes_secret (SecretSession *session,
 	/* Setup the IV */
 	iv = g_malloc0 (16);
 	gcry_create_nonce (iv, 16);
-	gcry = gcry_cipher_setiv (cih, iv, 16);
-	g_return_val_if_fail (gcry == 0, FALSE);
 
-	/* Setup the key */
-	gcry = gcry_cipher_setkey (cih, session->key, session->n_key);
-	g_return_val_if_fail (gcry == 0, FALSE);
+	/* Perform the encryption in place, in one pass */
+	g_mutex_lock (&session->mutex);
+	gcry = gcry_cipher_setiv (session->cih, iv, 16);
+	if (gcry == 0)
+		gcry = gcry_cipher_encrypt (session->cih, padded, n_padded, NULL, 0);
+	g_mutex_unlock (&session->mutex);
 
-	/* Perform the encryption */
-	for (pos = 0; pos < n_padded; pos += 16) {
-		gcry = gcry_cipher_encrypt (cih, (guchar*)padded + pos, 16, NULL, 0);
-		g_return_val_if_fail (gcry == 0, FALSE);
+	if (gcry != 0) {
+		g_warning ("couldn't encrypt AES secret: %s", gcry_strerror (gcry));
+		egg_secure_clear (padded, n_padded);
+		egg_secure_free (padded);
+		g_free (iv);
+		return FALSE;
 	}
 
-	gcry_cipher_close (cih);
-
 	child = g_variant_new_from_data (G_VARIANT_TYPE ("ay"), iv, 16, TRUE, g_free, iv);
 	g_variant_builder_add_value (builder, child);
 
@@ -595,6 +1280,59 @@ service_encode_aes_secret (SecretSession *session,
 	return TRUE;
 }
 
+static gboolean
+service_encode_gcm_secret (SecretSession *session,
+                           SecretValue *value,
+                           GVariantBuilder *builder)
+{
+	guchar *buffer;
+	gsize n_buffer;
+	gcry_error_t gcry;
+	gpointer nonce;
+	gconstpointer secret;
+	gsize n_secret;
+	GVariant *child;
+
+	g_return_val_if_fail (session->cih != NULL, FALSE);
+
+	g_variant_builder_add (builder, "o", session->path);
+
+	secret = secret_value_get (value, &n_secret);
+
+	/* No padding, the authentication tag goes on the end */
+	n_buffer = n_secret + GCM_TAG_SIZE;
+	buffer = egg_secure_alloc (n_buffer);
+	memcpy (buffer, secret, n_secret);
+
+	nonce = g_malloc0 (GCM_NONCE_SIZE);
+	gcry_create_nonce (nonce, GCM_NONCE_SIZE);
+
+	g_mutex_lock (&session->mutex);
+	gcry = gcry_cipher_setiv (session->cih, nonce, GCM_NONCE_SIZE);
+	if (gcry == 0)
+		gcry = gcry_cipher_encrypt (session->cih, buffer, n_secret, NULL, 0);
+	if (gcry == 0)
+		gcry = gcry_cipher_gettag (session->cih, buffer + n_secret, GCM_TAG_SIZE);
+	g_mutex_unlock (&session->mutex);
+
+	if (gcry != 0) {
+		g_warning ("couldn't encrypt AES secret: %s", gcry_strerror (gcry));
+		egg_secure_clear (buffer, n_buffer);
+		egg_secure_free (buffer);
+		g_free (nonce);
+		return FALSE;
+	}
+
+	child = g_variant_new_from_data (G_VARIANT_TYPE ("ay"), nonce, GCM_NONCE_SIZE, TRUE, g_free, nonce);
+	g_variant_builder_add_value (builder, child);
+
+	child = g_variant_new_from_data (G_VARIANT_TYPE ("ay"), buffer, n_buffer, TRUE, egg_secure_free, buffer);
+	g_variant_builder_add_value (builder, child);
+
+	g_variant_builder_add (builder, "s", secret_value_get_content_type (value));
+	return TRUE;
+}
+
 #endif /* WITH_GCRYPT */
 
 static gboolean
@@ -639,7 +1377,9 @@ _secret_session_encode_secret (SecretSession *session,
 	builder = g_variant_builder_new (type);
 
 #ifdef WITH_GCRYPT
-	if (session->key)
+	if (session->key && session->aead)
+		ret = service_encode_gcm_secret (session, value, builder);
+	else if (session->key)
 		ret = service_encode_aes_secret (session, value, builder);
 	else
 #endif
@@ -279,6 +279,142 @@ _secret_util_get_properties_finish (GDBusProxy *proxy,
 	return TRUE;
 }
 
+static void
+load_get_all_reply (GDBusProxy *proxy,
+                    GVariant *retval)
+{
+	GVariantIter *iter;
+	GVariant *value;
+	gchar *key;
+
+	/* No change notifications, nobody has seen these properties yet */
+	g_variant_get (retval, "(a{sv})", &iter);
+	while (g_variant_iter_loop (iter, "{sv}", &key, &value))
+		g_dbus_proxy_set_cached_property (proxy, key, value);
+	g_variant_iter_free (iter);
+}
+
+static void
+on_load_properties (GObject *source,
+                    GAsyncResult *result,
+                    gpointer user_data)
+{
+	GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+	GDBusProxy *proxy = G_DBUS_PROXY (g_async_result_get_source_object (user_data));
+	GError *error = NULL;
+	GVariant *retval;
+
+	retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+
+	/* Errors are ignored, as GDBusProxy does when loading its properties */
+	if (error == NULL) {
+		load_get_all_reply (proxy, retval);
+		g_variant_unref (retval);
+	} else {
+		g_error_free (error);
+	}
+
+	g_simple_async_result_complete (res);
+	g_object_unref (proxy);
+	g_object_unref (res);
+}
+
+/*
+ * Fill in the cached properties of a proxy created with
+ * G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES, in place of GDBusProxy's own
+ * load. Unlike that, it doesn't leave a PropertiesChanged match rule for
+ * the object path behind: the service's dispatcher keeps the properties
+ * up to date instead.
+ */
+void
+_secret_util_load_properties (GDBusProxy *proxy,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+	GSimpleAsyncResult *res;
+
+	g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	res = g_simple_async_result_new (G_OBJECT (proxy), callback, user_data,
+	                                 _secret_util_load_properties);
+
+	g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+	                        g_dbus_proxy_get_name (proxy),
+	                        g_dbus_proxy_get_object_path (proxy),
+	                        SECRET_PROPERTIES_INTERFACE, "GetAll",
+	                        g_variant_new ("(s)", g_dbus_proxy_get_interface_name (proxy)),
+	                        G_VARIANT_TYPE ("(a{sv})"),
+	                        G_DBUS_CALL_FLAGS_NONE, -1,
+	                        cancellable, on_load_properties,
+	                        g_object_ref (res));
+
+	g_object_unref (res);
+}
+
+void
+_secret_util_load_properties_finish (GDBusProxy *proxy,
+                                     GAsyncResult *result)
+{
+	g_return_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (proxy),
+	                  _secret_util_load_properties));
+}
+
+void
+_secret_util_load_properties_sync (GDBusProxy *proxy,
+                                   GCancellable *cancellable)
+{
+	GVariant *retval;
+
+	g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	retval = g_dbus_connection_call_sync (g_dbus_proxy_get_connection (proxy),
+	                                      g_dbus_proxy_get_name (proxy),
+	                                      g_dbus_proxy_get_object_path (proxy),
+	                                      SECRET_PROPERTIES_INTERFACE, "GetAll",
+	                                      g_variant_new ("(s)", g_dbus_proxy_get_interface_name (proxy)),
+	                                      G_VARIANT_TYPE ("(a{sv})"),
+	                                      G_DBUS_CALL_FLAGS_NONE, -1,
+	                                      cancellable, NULL);
+
+	if (retval != NULL) {
+		load_get_all_reply (proxy, retval);
+		g_variant_unref (retval);
+	}
+}
+
+gboolean
+_secret_util_seed_properties (GDBusProxy *proxy,
+                              GHashTable *objects)
+{
+	GVariant *interfaces;
+	GVariant *properties;
+	GVariantIter iter;
+	const gchar *name;
+	GVariant *value;
+
+	/* The object's interfaces and properties from GetManagedObjects */
+	interfaces = g_hash_table_lookup (objects, g_dbus_proxy_get_object_path (proxy));
+	if (interfaces == NULL)
+		return FALSE;
+
+	properties = g_variant_lookup_value (interfaces, g_dbus_proxy_get_interface_name (proxy),
+	                                     G_VARIANT_TYPE_VARDICT);
+	if (properties == NULL)
+		return FALSE;
+
+	g_variant_iter_init (&iter, properties);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+		g_dbus_proxy_set_cached_property (proxy, name, value);
+		g_variant_unref (value);
+	}
+
+	g_variant_unref (properties);
+	return TRUE;
+}
+
 typedef struct {
 	gchar *property;
 	GVariant *value;
@@ -430,6 +566,38 @@ _secret_util_have_cached_properties (GDBusProxy *proxy)
 	return names != NULL;
 }
 
+static gint max_in_flight_override = 0;
+
+void
+_secret_util_set_max_in_flight (guint max_in_flight)
+{
+	/* Zero goes back to the default or SECRET_MAX_IN_FLIGHT */
+	g_atomic_int_set (&max_in_flight_override, max_in_flight);
+}
+
+guint
+_secret_util_max_in_flight (void)
+{
+	static gsize max_in_flight = 0;
+	const gchar *env;
+	gsize value;
+
+	value = g_atomic_int_get (&max_in_flight_override);
+	if (value != 0)
+		return value;
+
+	/* How many requests bulk operations keep outstanding on the bus */
+	if (g_once_init_enter (&max_in_flight)) {
+		value = 16;
+		env = g_getenv ("SECRET_MAX_IN_FLIGHT");
+		if (env != NULL)
+			value = CLAMP (g_ascii_strtoull (env, NULL, 10), 1, G_MAXUINT);
+		g_once_init_leave (&max_in_flight, value);
+	}
+
+	return max_in_flight;
+}
+
 SecretSync *
 _secret_sync_new (void)
 {
@@ -439,6 +607,8 @@ _secret_sync_new (void)
 
 	sync->context = g_main_context_new ();
 	sync->loop = g_main_loop_new (sync->context, FALSE);
+	g_mutex_init (&sync->mutex);
+	g_cond_init (&sync->cond);
 
 	return sync;
 }
@@ -448,11 +618,16 @@ _secret_sync_free (gpointer data)
 {
 	SecretSync *sync = data;
 
-	while (g_main_context_iteration (sync->context, FALSE));
+	/* Requests run on the I/O thread never had a main loop of their own */
+	if (sync->context != NULL) {
+		while (g_main_context_iteration (sync->context, FALSE));
+		g_main_loop_unref (sync->loop);
+		g_main_context_unref (sync->context);
+	}
 
 	g_clear_object (&sync->result);
-	g_main_loop_unref (sync->loop);
-	g_main_context_unref (sync->context);
+	g_mutex_clear (&sync->mutex);
+	g_cond_clear (&sync->cond);
 	g_free (sync);
 }
 
@@ -462,7 +637,128 @@ _secret_sync_on_result (GObject *source,
                         gpointer user_data)
 {
 	SecretSync *sync = user_data;
-	g_assert (sync->result == NULL);
-	sync->result = g_object_ref (result);
-	g_main_loop_quit (sync->loop);
+
+	if (sync->io) {
+		g_mutex_lock (&sync->mutex);
+		g_assert (sync->result == NULL);
+		sync->result = g_object_ref (result);
+		g_cond_signal (&sync->cond);
+		g_mutex_unlock (&sync->mutex);
+
+	} else {
+		g_assert (sync->result == NULL);
+		sync->result = g_object_ref (result);
+		g_main_loop_quit (sync->loop);
+	}
+}
+
+static volatile gint io_enabled = 0;
+static GAsyncQueue *io_queue = NULL;
+static GMainContext *io_context = NULL;
+static GThread *io_thread = NULL;
+
+static gboolean
+io_source_prepare (GSource *source,
+                   gint *timeout)
+{
+	*timeout = -1;
+	return g_async_queue_length (io_queue) > 0;
+}
+
+static gboolean
+io_source_check (GSource *source)
+{
+	return g_async_queue_length (io_queue) > 0;
+}
+
+static gboolean
+io_source_dispatch (GSource *source,
+                    GSourceFunc callback,
+                    gpointer user_data)
+{
+	SecretSync *sync;
+
+	/* Start every submitted request, they complete in this thread */
+	while ((sync = g_async_queue_try_pop (io_queue)) != NULL)
+		(sync->func) (sync->data, _secret_sync_on_result, sync);
+
+	return TRUE;
+}
+
+static GSourceFuncs io_source_funcs = {
+	io_source_prepare,
+	io_source_check,
+	io_source_dispatch,
+	NULL,
+};
+
+static gpointer
+io_thread_main (gpointer unused)
+{
+	GMainLoop *loop;
+	GSource *source;
+
+	g_main_context_push_thread_default (io_context);
+
+	source = g_source_new (&io_source_funcs, sizeof (GSource));
+	g_source_attach (source, io_context);
+	g_source_unref (source);
+
+	/* Runs for the lifetime of the process */
+	loop = g_main_loop_new (io_context, FALSE);
+	g_main_loop_run (loop);
+
+	g_main_loop_unref (loop);
+	return NULL;
+}
+
+void
+_secret_sync_set_io_thread (gboolean enabled)
+{
+	static gsize started = 0;
+
+	if (enabled && g_once_init_enter (&started)) {
+		io_queue = g_async_queue_new ();
+		io_context = g_main_context_new ();
+		io_thread = g_thread_new ("libsecret-io", io_thread_main, NULL);
+		g_once_init_leave (&started, 1);
+	}
+
+	g_atomic_int_set (&io_enabled, enabled ? 1 : 0);
+}
+
+SecretSync *
+_secret_sync_run (SecretSyncFunc func,
+                  gpointer data)
+{
+	SecretSync *sync;
+
+	/* The I/O thread itself can't wait on its own requests */
+	if (!g_atomic_int_get (&io_enabled) || g_thread_self () == io_thread) {
+		sync = _secret_sync_new ();
+		g_main_context_push_thread_default (sync->context);
+		(func) (data, _secret_sync_on_result, sync);
+		g_main_loop_run (sync->loop);
+		g_main_context_pop_thread_default (sync->context);
+		return sync;
+	}
+
+	/* Completes on the I/O thread, so no main context or loop here */
+	sync = g_new0 (SecretSync, 1);
+	g_mutex_init (&sync->mutex);
+	g_cond_init (&sync->cond);
+	sync->io = TRUE;
+	sync->func = func;
+	sync->data = data;
+
+	/* A GAsyncQueue, which takes a mutex, rather than being lock-free */
+	g_async_queue_push (io_queue, sync);
+	g_main_context_wakeup (io_context);
+
+	g_mutex_lock (&sync->mutex);
+	while (sync->result == NULL)
+		g_cond_wait (&sync->cond, &sync->mutex);
+	g_mutex_unlock (&sync->mutex);
+
+	return sync;
 }
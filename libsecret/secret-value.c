@@ -38,6 +38,11 @@
  * #SecretValue is reference counted and immutable. The secret data is only
  * freed when all references have been released via secret_value_unref().
  *
+ * A #SecretValue created with secret_value_new_for_bytes() exposes the data
+ * of the #GBytes directly rather than copying it. Such a value is not stored
+ * in non-pageable memory, use secret_value_move_to_secure() if that is
+ * required.
+ *
  * Stability: Stable
  */
 
@@ -55,8 +60,10 @@ struct _SecretValue {
 	gint refs;
 	gpointer secret;
 	gsize length;
+	gpointer owner;
 	GDestroyNotify destroy;
 	gchar *content_type;
+	gchar *text;
 };
 
 GType
@@ -143,10 +150,77 @@ secret_value_new_full (gchar *secret,
 	value->destroy = destroy;
 	value->length = length;
 	value->secret = secret;
+	value->owner = secret;
+
+	return value;
+}
+
+/**
+ * secret_value_new_for_bytes:
+ * @bytes: the secret data
+ * @content_type: the content type of the data
+ *
+ * Create a #SecretValue which refers to the data in @bytes. The data is
+ * not copied, and a reference to @bytes is held until the last reference
+ * to the #SecretValue is released. The caller keeps its own reference to
+ * @bytes, and must not change the data while the value borrows it.
+ *
+ * Since the data is borrowed, it is not copied into non-pageable memory,
+ * nor null-terminated. Use secret_value_move_to_secure() if either is
+ * required.
+ *
+ * Returns: (transfer full): the new #SecretValue
+ */
+SecretValue *
+secret_value_new_for_bytes (GBytes *bytes,
+                            const gchar *content_type)
+{
+	SecretValue *value;
+	gsize length;
+
+	g_return_val_if_fail (bytes != NULL, NULL);
+	g_return_val_if_fail (content_type, NULL);
+
+	value = g_slice_new0 (SecretValue);
+	value->refs = 1;
+	value->content_type = g_strdup (content_type);
+	value->secret = (gpointer)g_bytes_get_data (bytes, &length);
+	value->length = length;
+	value->owner = g_bytes_ref (bytes);
+	value->destroy = (GDestroyNotify)g_bytes_unref;
 
 	return value;
 }
 
+/**
+ * secret_value_move_to_secure:
+ * @value: (transfer full): the value
+ *
+ * Make sure the secret data is stored in non-pageable 'secure' memory.
+ * This is useful for values created with secret_value_new_for_bytes() or
+ * secret_value_new_full().
+ *
+ * The reference to @value is consumed. If the secret data is already in
+ * secure memory the same value is returned, otherwise a new #SecretValue
+ * is created with a copy of the data, and @value is unreferenced.
+ *
+ * Returns: (transfer full): a value with its data in secure memory
+ */
+SecretValue *
+secret_value_move_to_secure (SecretValue *value)
+{
+	SecretValue *result;
+
+	g_return_val_if_fail (value != NULL, NULL);
+
+	if (value->destroy == egg_secure_free)
+		return value;
+
+	result = secret_value_new (value->secret, value->length, value->content_type);
+	secret_value_unref (value);
+	return result;
+}
+
 /**
  * secret_value_get:
  * @value: the value
@@ -154,7 +228,8 @@ secret_value_new_full (gchar *secret,
  *
  * Get the secret data in the #SecretValue. The value is not necessarily
  * null-terminated unless it was created with secret_value_new() or a
- * null-terminated string was passed to secret_value_new_full().
+ * null-terminated string was passed to secret_value_new_full(). Values
+ * created with secret_value_new_for_bytes() are never null-terminated.
  *
  * Returns: (array length=length) (element-type guint8): the secret data
  */
@@ -168,6 +243,19 @@ secret_value_get (SecretValue *value,
 	return value->secret;
 }
 
+static gchar *
+value_dup_text (SecretValue *value)
+{
+	gchar *text;
+
+	/* Exactly length bytes, as borrowed data has no terminator of its own */
+	text = egg_secure_alloc (value->length + 1);
+	if (value->length > 0)
+		memcpy (text, value->secret, value->length);
+	text[value->length] = 0;
+	return text;
+}
+
 /**
  * secret_value_get_text:
  * @value: the value
@@ -180,12 +268,27 @@ secret_value_get (SecretValue *value,
 const gchar *
 secret_value_get_text (SecretValue *value)
 {
+	gchar *text;
+
 	g_return_val_if_fail (value, NULL);
 
 	if (!is_password_value (value))
 		return NULL;
 
-	return value->secret;
+	if (value->owner == value->secret)
+		return value->secret;
+
+	/* Borrowed data is not null-terminated, so make a terminated copy once */
+	text = g_atomic_pointer_get (&value->text);
+	if (text == NULL) {
+		text = value_dup_text (value);
+		if (!g_atomic_pointer_compare_and_exchange (&value->text, NULL, text)) {
+			egg_secure_free (text);
+			text = g_atomic_pointer_get (&value->text);
+		}
+	}
+
+	return text;
 }
 
 /**
@@ -237,8 +340,9 @@ secret_value_unref (gpointer value)
 
 	if (g_atomic_int_dec_and_test (&val->refs)) {
 		g_free (val->content_type);
+		egg_secure_free (val->text);
 		if (val->destroy)
-			(val->destroy) (val->secret);
+			(val->destroy) (val->owner);
 		g_slice_free (SecretValue, val);
 	}
 }
@@ -270,19 +374,20 @@ _secret_value_unref_to_password (SecretValue *value)
 	}
 
 	if (g_atomic_int_dec_and_test (&val->refs)) {
-		if (val->destroy == egg_secure_free) {
+		if (val->destroy == egg_secure_free && val->owner == val->secret) {
 			result = val->secret;
 
 		} else {
-			result = egg_secure_strndup (val->secret, val->length);
+			result = value_dup_text (val);
 			if (val->destroy)
-				(val->destroy) (val->secret);
+				(val->destroy) (val->owner);
 		}
+		egg_secure_free (val->text);
 		g_free (val->content_type);
 		g_slice_free (SecretValue, val);
 
 	} else {
-		result = egg_secure_strndup (val->secret, val->length);
+		result = value_dup_text (val);
 	}
 
 	return result;
@@ -302,14 +407,15 @@ _secret_value_unref_to_string (SecretValue *value)
 	}
 
 	if (g_atomic_int_dec_and_test (&val->refs)) {
-		if (val->destroy == g_free) {
+		if (val->destroy == g_free && val->owner == val->secret) {
 			result = val->secret;
 
 		} else {
 			result = g_strndup (val->secret, val->length);
 			if (val->destroy)
-				(val->destroy) (val->secret);
+				(val->destroy) (val->owner);
 		}
+		egg_secure_free (val->text);
 		g_free (val->content_type);
 		g_slice_free (SecretValue, val);
 
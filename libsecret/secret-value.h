@@ -40,6 +40,11 @@ SecretValue *       secret_value_new_full          (gchar *secret,
                                                     const gchar *content_type,
                                                     GDestroyNotify destroy);
 
+SecretValue *       secret_value_new_for_bytes     (GBytes *bytes,
+                                                    const gchar *content_type);
+
+SecretValue *       secret_value_move_to_secure    (SecretValue *value);
+
 const gchar *       secret_value_get               (SecretValue *value,
                                                     gsize *length);
 
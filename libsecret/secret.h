@@ -39,6 +39,7 @@
 #endif
 
 #include <libsecret/secret-paths.h>
+#include <libsecret/secret-record.h>
 
 #endif /* SECRET_WITH_UNSTABLE || SECRET_API_SUBJECT_TO_CHANGE */
 
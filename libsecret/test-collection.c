@@ -93,6 +93,15 @@ on_notify_stop (GObject *obj,
 		egg_test_wait_stop ();
 }
 
+static void
+on_notify_count (GObject *obj,
+                 GParamSpec *spec,
+                 gpointer user_data)
+{
+	guint *count = user_data;
+	(*count)++;
+}
+
 static void
 test_new_sync (Test *test,
                gconstpointer unused)
@@ -447,6 +456,513 @@ test_items (Test *test,
 	g_object_unref (collection);
 }
 
+static void
+test_items_object_manager (Test *test,
+                           gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection;
+	GError *error = NULL;
+	GList *items, *l;
+	gchar *label;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/english/1",
+	                   "/org/freedesktop/secrets/collection/english/2",
+	                   "/org/freedesktop/secrets/collection/english/3",
+	                   NULL);
+
+	/* Properties came from GetManagedObjects, rather than a GetAll each */
+	for (l = items; l != NULL; l = g_list_next (l))
+		g_assert (g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+
+	label = secret_item_get_label (items->data);
+	g_assert_cmpstr (label, ==, "Item One");
+	g_free (label);
+
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+}
+
+static void
+test_items_object_manager_failure (Test *test,
+                                   gconstpointer unused)
+{
+	SecretCollection *collection;
+	GError *error = NULL;
+	GList *items, *l;
+
+	/* The first GetManagedObjects fails, so each item loads its own properties */
+	collection = secret_collection_new_for_dbus_path_sync (test->service,
+	                                                       "/org/freedesktop/secrets/collection/english",
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+
+	items = secret_collection_get_items (collection);
+	g_assert_cmpuint (g_list_length (items), ==, 3);
+	for (l = items; l != NULL; l = g_list_next (l))
+		g_assert (!(g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES));
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+
+	/* But that wasn't taken to mean it's unsupported, it's tried again */
+	collection = secret_collection_new_for_dbus_path_sync (test->service,
+	                                                       "/org/freedesktop/secrets/collection/spanish",
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/spanish/10",
+	                   "/org/freedesktop/secrets/collection/spanish/20",
+	                   "/org/freedesktop/secrets/collection/spanish/30",
+	                   NULL);
+	for (l = items; l != NULL; l = g_list_next (l))
+		g_assert (g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+}
+
+static void
+test_items_object_manager_async (Test *test,
+                                 gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	SecretCollection *collection;
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	GList *items, *l;
+	gchar *label;
+
+	secret_collection_new_for_dbus_path (test->service, collection_path,
+	                                     SECRET_COLLECTION_LOAD_ITEMS,
+	                                     NULL, on_async_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	collection = secret_collection_new_for_dbus_path_finish (result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/english/1",
+	                   "/org/freedesktop/secrets/collection/english/2",
+	                   "/org/freedesktop/secrets/collection/english/3",
+	                   NULL);
+
+	for (l = items; l != NULL; l = g_list_next (l))
+		g_assert (g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+
+	label = secret_item_get_label (items->data);
+	g_assert_cmpstr (label, ==, "Item One");
+	g_free (label);
+
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+}
+
+typedef struct {
+	guint position;
+	guint removed;
+	guint added;
+	guint total_removed;
+	guint total_added;
+	guint wait_for;
+} ItemsChanged;
+
+static void
+on_items_changed (SecretCollection *collection,
+                  guint position,
+                  guint removed,
+                  guint added,
+                  gpointer user_data)
+{
+	ItemsChanged *changed = user_data;
+
+	changed->position = position;
+	changed->removed = removed;
+	changed->added = added;
+	changed->total_removed += removed;
+	changed->total_added += added;
+
+	if (changed->total_removed + changed->total_added >= changed->wait_for)
+		egg_test_wait_stop ();
+}
+
+static void
+test_items_changed (Test *test,
+                    gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	ItemsChanged changed = { 0, };
+	SecretCollection *collection;
+	GHashTable *attributes;
+	GError *error = NULL;
+	SecretValue *value;
+	SecretItem *item;
+	GVariant *paths;
+	GList *items;
+	gboolean ret;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+	g_signal_connect (collection, "items-changed", G_CALLBACK (on_items_changed), &changed);
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "9");
+	value = secret_value_new ("nine", -1, "text/plain");
+
+	item = secret_item_create_sync (collection, &MOCK_SCHEMA, attributes, "Nine",
+	                                value, SECRET_ITEM_CREATE_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+	secret_value_unref (value);
+
+	/* Only the new item is added, at the end */
+	changed.wait_for = 1;
+	if (changed.total_added < 1)
+		egg_test_wait ();
+	g_assert_cmpuint (changed.position, ==, 3);
+	g_assert_cmpuint (changed.removed, ==, 0);
+	g_assert_cmpuint (changed.added, ==, 1);
+
+	items = secret_collection_get_items (collection);
+	g_assert_cmpuint (g_list_length (items), ==, 4);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (g_list_last (items)->data), ==,
+	                 g_dbus_proxy_get_object_path (G_DBUS_PROXY (item)));
+	g_list_free_full (items, g_object_unref);
+
+	/* The cached property follows along, for later loads */
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (collection), "Items");
+	g_assert_cmpuint (g_variant_n_children (paths), ==, 4);
+	g_variant_unref (paths);
+
+	ret = secret_item_delete_sync (item, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_object_unref (item);
+
+	changed.wait_for = 2;
+	if (changed.total_removed < 1)
+		egg_test_wait ();
+	g_assert_cmpuint (changed.position, ==, 3);
+	g_assert_cmpuint (changed.removed, ==, 1);
+	g_assert_cmpuint (changed.added, ==, 0);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/english/1",
+	                   "/org/freedesktop/secrets/collection/english/2",
+	                   "/org/freedesktop/secrets/collection/english/3",
+	                   NULL);
+	g_list_free_full (items, g_object_unref);
+
+	paths = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (collection), "Items");
+	g_assert_cmpuint (g_variant_n_children (paths), ==, 3);
+	g_variant_unref (paths);
+
+	g_signal_handlers_disconnect_by_func (collection, on_items_changed, &changed);
+
+	/* Nothing deleted is left to load */
+	ret = secret_collection_load_items_sync (collection, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_object_unref (collection);
+}
+
+static SecretItem *
+create_numbered_item (SecretCollection *collection,
+                      const gchar *number)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	SecretValue *value;
+	SecretItem *item;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", (gpointer)number);
+	value = secret_value_new (number, -1, "text/plain");
+
+	item = secret_item_create_sync (collection, &MOCK_SCHEMA, attributes, number,
+	                                value, SECRET_ITEM_CREATE_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+	secret_value_unref (value);
+
+	return item;
+}
+
+static void
+test_items_changed_deleted_while_created (Test *test,
+                                          gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	ItemsChanged changed = { 0, };
+	SecretCollection *collection;
+	GError *error = NULL;
+	SecretItem *gone;
+	SecretItem *item;
+	GList *items;
+	gboolean ret;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+	g_signal_connect (collection, "items-changed", G_CALLBACK (on_items_changed), &changed);
+
+	/* Both ItemCreated and ItemDeleted are queued before the item is loaded */
+	gone = create_numbered_item (collection, "9");
+	ret = secret_service_delete_item_dbus_path_sync (test->service,
+	                                                 g_dbus_proxy_get_object_path (G_DBUS_PROXY (gone)),
+	                                                 NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Signals arrive in order, so once this one is added the other is settled */
+	item = create_numbered_item (collection, "10");
+	changed.wait_for = 1;
+	if (changed.total_added < 1)
+		egg_test_wait ();
+	g_assert_cmpuint (changed.total_added, ==, 1);
+	g_assert_cmpuint (changed.total_removed, ==, 0);
+
+	items = secret_collection_get_items (collection);
+	check_items_equal (items,
+	                   "/org/freedesktop/secrets/collection/english/1",
+	                   "/org/freedesktop/secrets/collection/english/2",
+	                   "/org/freedesktop/secrets/collection/english/3",
+	                   g_dbus_proxy_get_object_path (G_DBUS_PROXY (item)),
+	                   NULL);
+	g_list_free_full (items, g_object_unref);
+
+	g_signal_handlers_disconnect_by_func (collection, on_items_changed, &changed);
+	g_object_unref (collection);
+	g_object_unref (gone);
+	g_object_unref (item);
+}
+
+static const SecretSchema STORM_SCHEMA = {
+	"org.mock.Storm",
+	SECRET_SCHEMA_NONE,
+	{
+		{ "number", SECRET_SCHEMA_ATTRIBUTE_STRING },
+		{ "storm", SECRET_SCHEMA_ATTRIBUTE_STRING },
+	}
+};
+
+static void
+test_benchmark_items_changed (Test *test,
+                              gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/many";
+	ItemsChanged changed = { 0, };
+	SecretCollection *collection;
+	GHashTable *attributes[1000];
+	SecretValue *values[1000];
+	const gchar *labels[1000];
+	GHashTable *storm;
+	GError *error = NULL;
+	guint n_items = 1000;
+	gdouble elapsed;
+	guint cleared;
+	guint i;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+	g_signal_connect (collection, "items-changed", G_CALLBACK (on_items_changed), &changed);
+
+	for (i = 0; i < n_items; i++) {
+		attributes[i] = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+		g_hash_table_insert (attributes[i], "number", g_strdup_printf ("%u", i));
+		g_hash_table_insert (attributes[i], "storm", g_strdup ("true"));
+		labels[i] = "Storm";
+		values[i] = secret_value_new ("storm", -1, "text/plain");
+	}
+
+	/* Every stored item is announced with an ItemCreated signal */
+	changed.wait_for = n_items;
+	g_test_timer_start ();
+	secret_service_store_many_sync (test->service, &STORM_SCHEMA, attributes, labels, values,
+	                                n_items, collection_path, NULL, NULL, &error);
+	g_assert_no_error (error);
+	while (changed.total_added < n_items)
+		egg_test_wait ();
+	elapsed = g_test_timer_elapsed ();
+
+	/* PropertiesChanged(Items) comes too, but nothing is loaded all over again */
+	g_assert_cmpuint (changed.total_added, ==, n_items);
+	g_assert_cmpuint (changed.total_removed, ==, 0);
+
+	g_test_minimized_result (elapsed, "%u items created in collection of %u: %.3f sec",
+	                         n_items, 10000, elapsed);
+
+	/* And every deleted one with ItemDeleted */
+	storm = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (storm, "storm", "true");
+
+	changed.wait_for = n_items * 2;
+	g_test_timer_start ();
+	secret_service_clear_full_sync (test->service, &STORM_SCHEMA, storm, 0, NULL, NULL,
+	                                NULL, &cleared, &error);
+	g_assert_no_error (error);
+	g_assert_cmpuint (cleared, ==, n_items);
+	while (changed.total_removed < n_items)
+		egg_test_wait ();
+	elapsed = g_test_timer_elapsed ();
+
+	g_assert_cmpuint (changed.total_added, ==, n_items);
+	g_assert_cmpuint (changed.total_removed, ==, n_items);
+
+	g_test_minimized_result (elapsed, "%u items deleted in collection of %u: %.3f sec",
+	                         n_items, 10000, elapsed);
+
+	for (i = 0; i < n_items; i++) {
+		g_hash_table_unref (attributes[i]);
+		secret_value_unref (values[i]);
+	}
+
+	g_hash_table_unref (storm);
+	g_signal_handlers_disconnect_by_func (collection, on_items_changed, &changed);
+	g_object_unref (collection);
+}
+
+static guint
+bus_match_rules (GDBusConnection *connection)
+{
+	GVariant *retval;
+	GVariant *stats;
+	guint rules = 0;
+
+	/* Only available when the bus daemon was built with statistics */
+	retval = g_dbus_connection_call_sync (connection, "org.freedesktop.DBus", "/org/freedesktop/DBus",
+	                                      "org.freedesktop.DBus.Debug.Stats", "GetConnectionStats",
+	                                      g_variant_new ("(s)", g_dbus_connection_get_unique_name (connection)),
+	                                      G_VARIANT_TYPE ("(a{sv})"), G_DBUS_CALL_FLAGS_NONE,
+	                                      -1, NULL, NULL);
+	if (retval == NULL)
+		return 0;
+
+	stats = g_variant_get_child_value (retval, 0);
+	if (!g_variant_lookup (stats, "MatchRules", "u", &rules))
+		rules = 0;
+	g_variant_unref (stats);
+	g_variant_unref (retval);
+
+	return rules;
+}
+
+static void
+test_benchmark_signal_dispatch (Test *test,
+                                gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/many";
+	GDBusConnection *connection;
+	SecretCollection *collection;
+	GError *error = NULL;
+	GVariant *retval;
+	GList *items, *l;
+	guint64 dispatched;
+	guint subscriptions;
+	guint registered;
+	guint n_changes = 0;
+	guint rules_before;
+	guint rules;
+	gdouble elapsed;
+	guint sigs;
+	gchar *label;
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	rules_before = bus_match_rules (connection);
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+
+	/* Without the dispatcher each proxy would add match rules for its path */
+	_secret_service_get_dispatch_stats (test->service, &registered, &subscriptions, NULL);
+	g_assert_cmpuint (subscriptions, ==, 1);
+	g_test_message ("%u proxies share %u signal subscription", registered, subscriptions);
+
+	/* Neither for its signals, nor for watching its properties */
+	items = secret_collection_get_items (collection);
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (collection)) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+	for (l = items; l != NULL; l = g_list_next (l)) {
+		g_assert (g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS);
+		g_assert (g_dbus_proxy_get_flags (l->data) & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES);
+	}
+
+	/* At most the one shared subscription, however many proxies there are */
+	rules = bus_match_rules (connection);
+	if (rules > 0) {
+		g_assert_cmpuint (rules, <=, rules_before + 1);
+		g_test_minimized_result (rules, "%u match rules on the bus for %u proxies", rules, registered);
+	}
+
+	/* Time from a property change to the notification on the item */
+	g_test_timer_start ();
+	for (l = items; l != NULL && n_changes < 100; l = g_list_next (l), n_changes++) {
+		label = g_strdup_printf ("Dispatched %u", n_changes);
+		sigs = 1;
+		g_signal_connect (l->data, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+		retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+		                                      g_dbus_proxy_get_object_path (l->data),
+		                                      SECRET_PROPERTIES_INTERFACE, "Set",
+		                                      g_variant_new ("(ssv)", SECRET_ITEM_INTERFACE, "Label",
+		                                                     g_variant_new_string (label)),
+		                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+		g_assert_no_error (error);
+		g_variant_unref (retval);
+		egg_test_wait ();
+		g_signal_handlers_disconnect_by_func (l->data, on_notify_stop, &sigs);
+		g_free (label);
+	}
+	elapsed = g_test_timer_elapsed ();
+
+	_secret_service_get_dispatch_stats (test->service, NULL, NULL, &dispatched);
+	g_assert_cmpuint (dispatched, >=, n_changes);
+
+	g_test_minimized_result (elapsed / n_changes, "signal dispatch latency among %u proxies: %.6f sec",
+	                         registered, elapsed / n_changes);
+
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+}
+
+static void
+test_benchmark_load_items (Test *test,
+                           gconstpointer data)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/many";
+	SecretCollection *collection;
+	GError *error = NULL;
+	gdouble elapsed;
+	GList *items;
+
+	/* Cold load of a large collection along with all its items */
+	g_test_timer_start ();
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_LOAD_ITEMS, NULL, &error);
+	g_assert_no_error (error);
+	elapsed = g_test_timer_elapsed ();
+
+	items = secret_collection_get_items (collection);
+	g_test_minimized_result (elapsed, "loaded collection of %u items from %s: %.3f sec",
+	                         g_list_length (items), (const gchar *)data, elapsed);
+
+	g_list_free_full (items, g_object_unref);
+	g_object_unref (collection);
+}
+
 static void
 test_items_empty (Test *test,
                   gconstpointer unused)
@@ -604,6 +1120,50 @@ test_set_label_prop (Test *test,
 	g_object_unref (collection);
 }
 
+static void
+test_label_changed (Test *test,
+                    gconstpointer unused)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
+	GDBusConnection *connection;
+	SecretCollection *collection;
+	GError *error = NULL;
+	GVariant *retval;
+	guint notified = 0;
+	guint sigs = 1;
+	gchar *label;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	g_signal_connect (collection, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	g_signal_connect (collection, "notify::label", G_CALLBACK (on_notify_count), &notified);
+
+	/* Change the label behind the collection's back */
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+	                                      collection_path, SECRET_PROPERTIES_INTERFACE, "Set",
+	                                      g_variant_new ("(ssv)", SECRET_COLLECTION_INTERFACE, "Label",
+	                                                     g_variant_new_string ("Changed")),
+	                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+
+	egg_test_wait ();
+
+	/* Notified once, not by both GDBusProxy and the dispatcher */
+	g_signal_handlers_disconnect_by_func (collection, on_notify_stop, &sigs);
+	egg_test_wait_until (100);
+	g_assert_cmpuint (notified, ==, 1);
+
+	label = secret_collection_get_label (collection);
+	g_assert_cmpstr (label, ==, "Changed");
+	g_free (label);
+
+	g_object_unref (collection);
+}
+
 static void
 test_delete_sync (Test *test,
                   gconstpointer unused)
@@ -1013,11 +1573,17 @@ main (int argc, char **argv)
 	g_test_add ("/collection/create-async", Test, "mock-service-normal.py", setup, test_create_async, teardown);
 	g_test_add ("/collection/properties", Test, "mock-service-normal.py", setup, test_properties, teardown);
 	g_test_add ("/collection/items", Test, "mock-service-normal.py", setup, test_items, teardown);
+	g_test_add ("/collection/items-changed", Test, "mock-service-signals.py", setup, test_items_changed, teardown);
+	g_test_add ("/collection/items-changed-deleted-while-created", Test, "mock-service-signals.py", setup, test_items_changed_deleted_while_created, teardown);
+	g_test_add ("/collection/items-object-manager", Test, "mock-service-object-manager.py", setup, test_items_object_manager, teardown);
+	g_test_add ("/collection/items-object-manager-async", Test, "mock-service-object-manager.py", setup, test_items_object_manager_async, teardown);
+	g_test_add ("/collection/items-object-manager-failure", Test, "mock-service-object-manager-failure.py", setup, test_items_object_manager_failure, teardown);
 	g_test_add ("/collection/items-empty", Test, "mock-service-normal.py", setup, test_items_empty, teardown);
 	g_test_add ("/collection/items-empty-async", Test, "mock-service-normal.py", setup, test_items_empty_async, teardown);
 	g_test_add ("/collection/set-label-sync", Test, "mock-service-normal.py", setup, test_set_label_sync, teardown);
 	g_test_add ("/collection/set-label-async", Test, "mock-service-normal.py", setup, test_set_label_async, teardown);
 	g_test_add ("/collection/set-label-prop", Test, "mock-service-normal.py", setup, test_set_label_prop, teardown);
+	g_test_add ("/collection/label-changed", Test, "mock-service-normal.py", setup, test_label_changed, teardown);
 	g_test_add ("/collection/delete-sync", Test, "mock-service-normal.py", setup, test_delete_sync, teardown);
 	g_test_add ("/collection/delete-async", Test, "mock-service-normal.py", setup, test_delete_async, teardown);
 
@@ -1030,5 +1596,12 @@ main (int argc, char **argv)
 	g_test_add ("/collection/search-secrets-sync", Test, "mock-service-normal.py", setup, test_search_secrets_sync, teardown);
 	g_test_add ("/collection/search-secrets-async", Test, "mock-service-normal.py", setup, test_search_secrets_async, teardown);
 
+	if (g_test_perf ()) {
+		g_test_add ("/collection/benchmark-items-changed", Test, "mock-service-many-signals.py", setup, test_benchmark_items_changed, teardown);
+		g_test_add ("/collection/benchmark-signal-dispatch", Test, "mock-service-many.py", setup, test_benchmark_signal_dispatch, teardown);
+		g_test_add ("/collection/benchmark-load-items", Test, "mock-service-many.py", setup, test_benchmark_load_items, teardown);
+		g_test_add ("/collection/benchmark-load-items-object-manager", Test, "mock-service-many-object-manager.py", setup, test_benchmark_load_items, teardown);
+	}
+
 	return egg_tests_run_with_loop ();
 }
@@ -419,6 +419,161 @@ test_set_label_prop (Test *test,
 		g_main_context_iteration (g_main_context_get_thread_default (), TRUE);
 }
 
+static void
+on_notify_count (GObject *obj,
+                 GParamSpec *spec,
+                 gpointer user_data)
+{
+	guint *count = user_data;
+	(*count)++;
+}
+
+static void
+test_signal_dispatch (Test *test,
+                      gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GDBusConnection *connection;
+	GError *error = NULL;
+	SecretItem *item;
+	guint64 dispatched;
+	guint subscriptions;
+	guint registered;
+	guint before;
+	guint sigs = 1;
+	guint notified = 0;
+	GVariant *retval;
+	gchar *label;
+
+	/* Subscribed once the first proxy is registered */
+	_secret_service_get_dispatch_stats (test->service, &before, &subscriptions, NULL);
+	g_assert_cmpuint (subscriptions, ==, before > 0 ? 1 : 0);
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	/* The item leaves subscribing to its signals to the service */
+	g_assert (g_dbus_proxy_get_flags (G_DBUS_PROXY (item)) & G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS);
+	_secret_service_get_dispatch_stats (test->service, &registered, &subscriptions, NULL);
+	g_assert_cmpuint (registered, ==, before + 1);
+	g_assert_cmpuint (subscriptions, ==, 1);
+
+	/* Change the label behind the item's back */
+	g_signal_connect (item, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	g_signal_connect (item, "notify::label", G_CALLBACK (on_notify_count), &notified);
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+	                                      item_path, SECRET_PROPERTIES_INTERFACE, "Set",
+	                                      g_variant_new ("(ssv)", SECRET_ITEM_INTERFACE, "Label",
+	                                                     g_variant_new_string ("Dispatched")),
+	                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+
+	egg_test_wait ();
+
+	/* Notified once, not by both GDBusProxy and the dispatcher */
+	g_signal_handlers_disconnect_by_func (item, on_notify_stop, &sigs);
+	egg_test_wait_until (100);
+	g_assert_cmpuint (notified, ==, 1);
+
+	label = secret_item_get_label (item);
+	g_assert_cmpstr (label, ==, "Dispatched");
+	g_free (label);
+
+	_secret_service_get_dispatch_stats (test->service, NULL, NULL, &dispatched);
+	g_assert_cmpuint (dispatched, >, 0);
+
+	g_object_add_weak_pointer (G_OBJECT (item), (gpointer *)&item);
+	g_object_unref (item);
+
+	while (item != NULL)
+		g_main_context_iteration (g_main_context_get_thread_default (), TRUE);
+
+	_secret_service_get_dispatch_stats (test->service, &registered, NULL, NULL);
+	g_assert_cmpuint (registered, ==, before);
+}
+
+static void
+on_notify_flag (GObject *obj,
+                GParamSpec *spec,
+                gpointer user_data)
+{
+	gboolean *notified = user_data;
+	*notified = TRUE;
+}
+
+static void
+test_signal_dispatch_context (Test *test,
+                              gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	const gchar *other_path = "/org/freedesktop/secrets/collection/english/2";
+	GDBusConnection *connection;
+	gboolean notified_other = FALSE;
+	GMainContext *context;
+	GError *error = NULL;
+	SecretItem *other;
+	SecretItem *item;
+	guint subscriptions;
+	guint sigs = 1;
+	GVariant *retval;
+	gchar *label;
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	/* Created while another context is the thread default */
+	context = g_main_context_new ();
+	g_main_context_push_thread_default (context);
+	other = secret_item_new_for_dbus_path_sync (test->service, other_path,
+	                                            SECRET_ITEM_NONE, NULL, &error);
+	g_main_context_pop_thread_default (context);
+	g_assert_no_error (error);
+
+	_secret_service_get_dispatch_stats (test->service, NULL, &subscriptions, NULL);
+	g_assert_cmpuint (subscriptions, ==, 2);
+
+	g_signal_connect (item, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	g_signal_connect (other, "notify::label", G_CALLBACK (on_notify_flag), &notified_other);
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+	                                      other_path, SECRET_PROPERTIES_INTERFACE, "Set",
+	                                      g_variant_new ("(ssv)", SECRET_ITEM_INTERFACE, "Label",
+	                                                     g_variant_new_string ("Dispatched")),
+	                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+	retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+	                                      item_path, SECRET_PROPERTIES_INTERFACE, "Set",
+	                                      g_variant_new ("(ssv)", SECRET_ITEM_INTERFACE, "Label",
+	                                                     g_variant_new_string ("Dispatched")),
+	                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+
+	/* Each proxy hears about it in its own context */
+	egg_test_wait ();
+	g_assert (!notified_other);
+
+	while (!notified_other)
+		g_main_context_iteration (context, TRUE);
+
+	label = secret_item_get_label (other);
+	g_assert_cmpstr (label, ==, "Dispatched");
+	g_free (label);
+
+	g_object_unref (other);
+	g_object_unref (item);
+
+	_secret_service_get_dispatch_stats (test->service, NULL, &subscriptions, NULL);
+	g_assert_cmpuint (subscriptions, <=, 1);
+
+	while (g_main_context_iteration (context, FALSE));
+	g_main_context_unref (context);
+}
+
 static void
 test_set_attributes_sync (Test *test,
                            gconstpointer unused)
@@ -604,6 +759,134 @@ test_load_secret_sync (Test *test,
 	g_object_unref (item);
 }
 
+static void
+test_load_secret_cached (Test *test,
+                         gconstpointer unused)
+{
+	const gchar *path_one = "/org/freedesktop/secrets/collection/english/1";
+	const gchar *path_two = "/org/freedesktop/secrets/collection/english/2";
+	GError *error = NULL;
+	SecretItem *one;
+	SecretItem *two;
+	SecretValue *value;
+	guint64 evictions;
+	gboolean ret;
+	gsize bytes;
+
+	/* Only room for one of the three byte secrets */
+	secret_service_set_secret_cache_policy (test->service, 5, 0);
+
+	one = secret_item_new_for_dbus_path_sync (test->service, path_one, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+	two = secret_item_new_for_dbus_path_sync (test->service, path_two, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	ret = secret_item_load_secret_sync (one, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpuint (secret_item_get_flags (one), ==, SECRET_ITEM_LOAD_SECRET);
+
+	ret = secret_item_load_secret_sync (two, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* The first was evicted */
+	g_assert_cmpuint (secret_item_get_flags (one), ==, SECRET_ITEM_NONE);
+	value = secret_item_get_secret (one);
+	g_assert (value == NULL);
+
+	value = secret_item_get_secret (two);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "222");
+	secret_value_unref (value);
+
+	secret_service_get_secret_cache_stats (test->service, NULL, NULL, &evictions, &bytes);
+	g_assert_cmpuint (evictions, ==, 1);
+	g_assert_cmpuint (bytes, ==, 3);
+
+	/* Loading again brings it back */
+	ret = secret_item_load_secret_sync (one, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	value = secret_item_get_secret (one);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "111");
+	secret_value_unref (value);
+
+	/* Turning off the cache drops everything */
+	secret_service_set_secret_cache_policy (test->service, 0, 0);
+	value = secret_item_get_secret (one);
+	g_assert (value == NULL);
+
+	g_object_unref (one);
+	g_object_unref (two);
+}
+
+static GDBusMessage *
+on_filter_invalidate (GDBusConnection *connection,
+                      GDBusMessage *message,
+                      gboolean incoming,
+                      gpointer user_data)
+{
+	SecretCache *cache = user_data;
+	GDBusMessage *signal;
+
+	/* Changed on the service while the request is on its way */
+	if (!incoming && g_strcmp0 (g_dbus_message_get_member (message), "GetSecret") == 0) {
+		signal = g_dbus_message_new_signal ("/org/freedesktop/secrets/collection/english",
+		                                    SECRET_COLLECTION_INTERFACE, "ItemChanged");
+		g_dbus_message_set_body (signal, g_variant_new ("(o)", g_dbus_message_get_path (message)));
+		_secret_cache_process_message (cache, signal);
+		g_object_unref (signal);
+	}
+
+	return message;
+}
+
+static void
+test_load_secret_cached_invalidated (Test *test,
+                                     gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GDBusConnection *connection;
+	GError *error = NULL;
+	SecretCache *cache;
+	SecretValue *value;
+	SecretItem *item;
+	gboolean ret;
+	guint filter;
+	gsize bytes;
+
+	secret_service_set_secret_cache_policy (test->service, 1024, 0);
+	cache = _secret_service_get_cache (test->service);
+	g_assert (cache != NULL);
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	filter = g_dbus_connection_add_filter (connection, on_filter_invalidate, cache, NULL);
+
+	ret = secret_item_load_secret_sync (item, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_dbus_connection_remove_filter (connection, filter);
+
+	/* Possibly stale, so not cached, but the item still has it */
+	secret_service_get_secret_cache_stats (test->service, NULL, NULL, NULL, &bytes);
+	g_assert_cmpuint (bytes, ==, 0);
+
+	value = secret_item_get_secret (item);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "111");
+	secret_value_unref (value);
+
+	secret_service_set_secret_cache_policy (test->service, 0, 0);
+	_secret_cache_unref (cache);
+	g_object_unref (item);
+}
+
 static void
 test_load_secret_async (Test *test,
                         gconstpointer unused)
@@ -686,6 +969,111 @@ test_set_secret_sync (Test *test,
 	g_object_unref (item);
 }
 
+static void
+test_lazy_properties (Test *test,
+                      gconstpointer unused)
+{
+	const gchar *path_item_one = "/org/freedesktop/secrets/collection/english/1";
+	const gchar *path_item_two = "/org/freedesktop/secrets/collection/english/2";
+	SecretItem *item_one, *item_two;
+	GError *error = NULL;
+	GVariant *variant;
+	gchar **names;
+	gchar *label;
+
+	item_one = secret_item_new_for_dbus_path_sync (test->service, path_item_one,
+	                                               SECRET_ITEM_LAZY_PROPERTIES, NULL, &error);
+	g_assert_no_error (error);
+	item_two = secret_item_new_for_dbus_path_sync (test->service, path_item_two,
+	                                               SECRET_ITEM_LAZY_PROPERTIES, NULL, &error);
+	g_assert_no_error (error);
+
+	names = g_dbus_proxy_get_cached_property_names (G_DBUS_PROXY (item_one));
+	g_assert (names == NULL || names[0] == NULL);
+	g_strfreev (names);
+
+	label = secret_item_get_label (item_one);
+	g_assert_cmpstr (label, ==, "Item One");
+	g_free (label);
+	g_assert (secret_item_get_locked (item_one) == FALSE);
+
+	/* Loaded in the same batch as the first item */
+	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (item_two), "Label");
+	g_assert (variant != NULL);
+	g_assert_cmpstr (g_variant_get_string (variant, NULL), ==, "Item Two");
+	g_variant_unref (variant);
+
+	g_object_unref (item_one);
+	g_object_unref (item_two);
+}
+
+static void
+test_lazy_properties_noexist (Test *test,
+                              gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/0000";
+	GError *error = NULL;
+	SecretItem *item;
+
+	/* Nothing is checked until the properties are needed */
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path,
+	                                           SECRET_ITEM_LAZY_PROPERTIES, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (item != NULL);
+
+	/* Quietly falls back to the defaults, and doesn't try again */
+	g_assert (secret_item_get_label (item) == NULL);
+	g_assert (secret_item_get_attributes (item) == NULL);
+	g_assert (secret_item_get_schema_name (item) == NULL);
+	g_assert (secret_item_get_locked (item) == TRUE);
+	g_assert_cmpuint (secret_item_get_created (item), ==, 0);
+	g_assert_cmpuint (secret_item_get_modified (item), ==, 0);
+
+	g_object_unref (item);
+}
+
+static void
+test_lazy_properties_secrets (Test *test,
+                              gconstpointer unused)
+{
+	const gchar *path_item_one = "/org/freedesktop/secrets/collection/english/1";
+	const gchar *path_item_three = "/org/freedesktop/secrets/collection/spanish/10";
+	SecretItem *item_one, *item_three;
+	GError *error = NULL;
+	GList *items = NULL;
+	SecretValue *value;
+	GVariant *variant;
+	gboolean ret;
+
+	item_one = secret_item_new_for_dbus_path_sync (test->service, path_item_one,
+	                                               SECRET_ITEM_LAZY_PROPERTIES, NULL, &error);
+	g_assert_no_error (error);
+	item_three = secret_item_new_for_dbus_path_sync (test->service, path_item_three,
+	                                                 SECRET_ITEM_LAZY_PROPERTIES, NULL, &error);
+	g_assert_no_error (error);
+
+	items = g_list_append (items, item_one);
+	items = g_list_append (items, item_three);
+
+	ret = secret_item_load_secrets_sync (items, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	value = secret_item_get_secret (item_one);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, NULL), ==, "111");
+	secret_value_unref (value);
+
+	/* Locked, so left out, and the properties were never needed */
+	value = secret_item_get_secret (item_three);
+	g_assert (value == NULL);
+
+	variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (item_three), "Locked");
+	g_assert (variant == NULL);
+
+	g_list_free_full (items, g_object_unref);
+}
+
 static void
 test_secrets_sync (Test *test,
                    gconstpointer used)
@@ -823,6 +1211,32 @@ test_delete_sync (Test *test,
 	g_clear_error (&error);
 }
 
+static void
+test_delete_held (Test *test,
+                  gconstpointer unused)
+{
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
+	GError *error = NULL;
+	SecretItem *item;
+	SecretItem *other;
+	gboolean ret;
+
+	item = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	ret = secret_item_delete_sync (item, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Still held here, but never handed out again once deleted */
+	other = secret_item_new_for_dbus_path_sync (test->service, item_path, SECRET_ITEM_NONE, NULL, &error);
+	g_assert_error (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD);
+	g_assert (other == NULL);
+	g_clear_error (&error);
+
+	g_object_unref (item);
+}
+
 static void
 test_delete_async (Test *test,
                    gconstpointer unused)
@@ -873,15 +1287,23 @@ main (int argc, char **argv)
 	g_test_add ("/item/set-label-sync", Test, "mock-service-normal.py", setup, test_set_label_sync, teardown);
 	g_test_add ("/item/set-label-async", Test, "mock-service-normal.py", setup, test_set_label_async, teardown);
 	g_test_add ("/item/set-label-prop", Test, "mock-service-normal.py", setup, test_set_label_prop, teardown);
+	g_test_add ("/item/signal-dispatch", Test, "mock-service-normal.py", setup, test_signal_dispatch, teardown);
+	g_test_add ("/item/signal-dispatch-context", Test, "mock-service-normal.py", setup, test_signal_dispatch_context, teardown);
 	g_test_add ("/item/set-attributes-sync", Test, "mock-service-normal.py", setup, test_set_attributes_sync, teardown);
 	g_test_add ("/item/set-attributes-async", Test, "mock-service-normal.py", setup, test_set_attributes_async, teardown);
 	g_test_add ("/item/set-attributes-prop", Test, "mock-service-normal.py", setup, test_set_attributes_prop, teardown);
 	g_test_add ("/item/load-secret-sync", Test, "mock-service-normal.py", setup, test_load_secret_sync, teardown);
 	g_test_add ("/item/load-secret-async", Test, "mock-service-normal.py", setup, test_load_secret_async, teardown);
+	g_test_add ("/item/load-secret-cached", Test, "mock-service-normal.py", setup, test_load_secret_cached, teardown);
+	g_test_add ("/item/load-secret-cached-invalidated", Test, "mock-service-normal.py", setup, test_load_secret_cached_invalidated, teardown);
 	g_test_add ("/item/set-secret-sync", Test, "mock-service-normal.py", setup, test_set_secret_sync, teardown);
+	g_test_add ("/item/lazy-properties", Test, "mock-service-normal.py", setup, test_lazy_properties, teardown);
+	g_test_add ("/item/lazy-properties-noexist", Test, "mock-service-normal.py", setup, test_lazy_properties_noexist, teardown);
+	g_test_add ("/item/lazy-properties-secrets", Test, "mock-service-normal.py", setup, test_lazy_properties_secrets, teardown);
 	g_test_add ("/item/secrets-sync", Test, "mock-service-normal.py", setup, test_secrets_sync, teardown);
 	g_test_add ("/item/secrets-async", Test, "mock-service-normal.py", setup, test_secrets_async, teardown);
 	g_test_add ("/item/delete-sync", Test, "mock-service-normal.py", setup, test_delete_sync, teardown);
+	g_test_add ("/item/delete-held", Test, "mock-service-normal.py", setup, test_delete_held, teardown);
 	g_test_add ("/item/delete-async", Test, "mock-service-normal.py", setup, test_delete_async, teardown);
 
 	return egg_tests_run_with_loop ();
@@ -18,6 +18,7 @@
 #include "secret-item.h"
 #include "secret-paths.h"
 #include "secret-private.h"
+#include "secret-record.h"
 #include "secret-service.h"
 
 #include "mock-service.h"
@@ -29,6 +30,10 @@
 #include <errno.h>
 #include <stdlib.h>
 
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
 static const SecretSchema MOCK_SCHEMA = {
 	"org.mock.Schema",
 	SECRET_SCHEMA_NONE,
@@ -86,6 +91,28 @@ setup (Test *test,
 	g_object_add_weak_pointer (G_OBJECT (test->service), (gpointer *)&test->service);
 }
 
+static void
+setup_throttled (Test *test,
+                 gconstpointer data)
+{
+	/* Small enough that searching for all items has to queue some */
+	_secret_util_set_max_in_flight (2);
+	setup (test, data);
+}
+
+static void
+setup_cache (Test *test,
+             gconstpointer data)
+{
+	GError *error = NULL;
+
+	setup_mock (test, data);
+
+	test->service = secret_service_get_sync (SECRET_SERVICE_CACHE_SEARCHES, NULL, &error);
+	g_assert_no_error (error);
+	g_object_add_weak_pointer (G_OBJECT (test->service), (gpointer *)&test->service);
+}
+
 static void
 teardown_mock (Test *test,
                gconstpointer unused)
@@ -107,6 +134,14 @@ teardown (Test *test,
 	teardown_mock (test, unused);
 }
 
+static void
+teardown_throttled (Test *test,
+                    gconstpointer unused)
+{
+	teardown (test, unused);
+	_secret_util_set_max_in_flight (0);
+}
+
 static void
 on_complete_get_result (GObject *source,
                         GAsyncResult *result,
@@ -142,6 +177,147 @@ test_search_sync (Test *test,
 	g_list_free_full (items, g_object_unref);
 }
 
+static void
+on_notify_stop (GObject *obj,
+                GParamSpec *spec,
+                gpointer user_data)
+{
+	guint *sigs = user_data;
+	g_assert (sigs != NULL);
+	g_assert (*sigs > 0);
+	if (--(*sigs) == 0)
+		egg_test_wait_stop ();
+}
+
+static void
+test_search_sync_notify (Test *test,
+                         gconstpointer used)
+{
+	GDBusConnection *connection;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GVariant *retval;
+	GList *items;
+	guint sigs = 1;
+	gchar *label;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+	g_assert (items != NULL);
+
+	/* The item must hear about changes in this main context */
+	g_signal_connect (items->data, "notify::label", G_CALLBACK (on_notify_stop), &sigs);
+	connection = g_dbus_proxy_get_connection (G_DBUS_PROXY (test->service));
+	retval = g_dbus_connection_call_sync (connection, g_dbus_proxy_get_name (G_DBUS_PROXY (test->service)),
+	                                      g_dbus_proxy_get_object_path (items->data),
+	                                      SECRET_PROPERTIES_INTERFACE, "Set",
+	                                      g_variant_new ("(ssv)", SECRET_ITEM_INTERFACE, "Label",
+	                                                     g_variant_new_string ("Changed")),
+	                                      NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+	g_assert_no_error (error);
+	g_variant_unref (retval);
+
+	egg_test_wait ();
+
+	label = secret_item_get_label (items->data);
+	g_assert_cmpstr (label, ==, "Changed");
+	g_free (label);
+
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_search_reuse (Test *test,
+                   gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items, *again;
+	SecretItem *item;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (items != NULL);
+	g_assert (items->next == NULL);
+
+	/* The item is still alive, so the same proxy comes back */
+	again = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (again != NULL);
+	g_assert (again->data == items->data);
+	g_list_free_full (again, g_object_unref);
+
+	item = secret_item_new_for_dbus_path_sync (test->service,
+	                                           "/org/freedesktop/secrets/collection/english/1",
+	                                           SECRET_ITEM_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (item == items->data);
+	g_object_unref (item);
+
+	g_hash_table_unref (attributes);
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_search_reuse_async (Test *test,
+                         gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items, *again;
+	SecretItem *item;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (items != NULL);
+
+	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
+	                       SECRET_SEARCH_NONE, NULL,
+	                       on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	again = secret_service_search_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_clear_object (&result);
+
+	g_assert (again != NULL);
+	g_assert (again->data == items->data);
+	g_list_free_full (again, g_object_unref);
+
+	secret_item_new_for_dbus_path (test->service, "/org/freedesktop/secrets/collection/english/1",
+	                               SECRET_ITEM_NONE, NULL, on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	item = secret_item_new_for_dbus_path_finish (result, &error);
+	g_assert_no_error (error);
+	g_clear_object (&result);
+
+	g_assert (item == items->data);
+	g_object_unref (item);
+
+	g_hash_table_unref (attributes);
+	g_list_free_full (items, g_object_unref);
+}
+
 static void
 test_search_async (Test *test,
                    gconstpointer used)
@@ -244,241 +420,1247 @@ test_search_all_async (Test *test,
 }
 
 static void
-test_search_unlock_sync (Test *test,
-                         gconstpointer used)
+assert_items_match_paths (GList *items,
+                          gchar **unlocked,
+                          gchar **locked)
+{
+	GList *l = items;
+	guint i;
+
+	for (i = 0; unlocked[i] != NULL; i++, l = l->next) {
+		g_assert (l != NULL);
+		g_assert_cmpstr (g_dbus_proxy_get_object_path (l->data), ==, unlocked[i]);
+		g_assert (secret_item_get_locked (l->data) == FALSE);
+	}
+
+	for (i = 0; locked[i] != NULL; i++, l = l->next) {
+		g_assert (l != NULL);
+		g_assert_cmpstr (g_dbus_proxy_get_object_path (l->data), ==, locked[i]);
+		g_assert (secret_item_get_locked (l->data) == TRUE);
+	}
+
+	g_assert (l == NULL);
+}
+
+static void
+test_search_all_many_sync (Test *test,
+                           gconstpointer used)
 {
 	GHashTable *attributes;
 	GError *error = NULL;
+	gchar **unlocked;
+	gchar **locked;
 	GList *items;
 
+	/* Matches every item, more than the in-flight limit in setup_throttled() */
 	attributes = g_hash_table_new (g_str_hash, g_str_equal);
-	g_hash_table_insert (attributes, "number", "1");
 
-	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
-	                                    SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK,
-	                                    NULL, &error);
+	secret_service_search_for_dbus_paths_sync (test->service, NULL, attributes, NULL,
+	                                           &unlocked, &locked, &error);
 	g_assert_no_error (error);
-	g_hash_table_unref (attributes);
+	g_assert_cmpuint (g_strv_length (unlocked) + g_strv_length (locked), >, 2);
 
-	g_assert (items != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
-	g_assert (secret_item_get_locked (items->data) == FALSE);
-	g_assert (secret_item_get_secret (items->data) == NULL);
+	items = secret_service_search_sync (test->service, NULL, attributes,
+	                                    SECRET_SEARCH_ALL, NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
 
-	g_assert (items->next != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
-	g_assert (secret_item_get_locked (items->next->data) == FALSE);
-	g_assert (secret_item_get_secret (items->next->data) == NULL);
+	assert_items_match_paths (items, unlocked, locked);
 
-	g_assert (items->next->next == NULL);
 	g_list_free_full (items, g_object_unref);
+	g_strfreev (unlocked);
+	g_strfreev (locked);
 }
 
 static void
-test_search_unlock_async (Test *test,
-                          gconstpointer used)
+test_search_all_many_async (Test *test,
+                            gconstpointer used)
 {
 	GAsyncResult *result = NULL;
 	GHashTable *attributes;
 	GError *error = NULL;
+	gchar **unlocked;
+	gchar **locked;
 	GList *items;
 
 	attributes = g_hash_table_new (g_str_hash, g_str_equal);
-	g_hash_table_insert (attributes, "number", "1");
 
-	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
-	                       SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK, NULL,
+	secret_service_search_for_dbus_paths_sync (test->service, NULL, attributes, NULL,
+	                                           &unlocked, &locked, &error);
+	g_assert_no_error (error);
+
+	secret_service_search (test->service, NULL, attributes,
+	                       SECRET_SEARCH_ALL, NULL,
 	                       on_complete_get_result, &result);
 	g_hash_table_unref (attributes);
 	g_assert (result == NULL);
 
 	egg_test_wait ();
 
-	g_assert (G_IS_ASYNC_RESULT (result));
 	items = secret_service_search_finish (test->service, result, &error);
 	g_assert_no_error (error);
 	g_object_unref (result);
 
-	g_assert (items != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
-	g_assert (secret_item_get_locked (items->data) == FALSE);
-	g_assert (secret_item_get_secret (items->data) == NULL);
-
-	g_assert (items->next != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
-	g_assert (secret_item_get_locked (items->next->data) == FALSE);
-	g_assert (secret_item_get_secret (items->next->data) == NULL);
+	assert_items_match_paths (items, unlocked, locked);
 
-	g_assert (items->next->next == NULL);
 	g_list_free_full (items, g_object_unref);
+	g_strfreev (unlocked);
+	g_strfreev (locked);
 }
 
 static void
-test_search_secrets_sync (Test *test,
+test_search_records_sync (Test *test,
                           gconstpointer used)
 {
 	GHashTable *attributes;
 	GError *error = NULL;
-	SecretValue *value;
-	GList *items;
+	GPtrArray *records;
+	SecretRecord *record;
+	gchar *schema_name;
 
 	attributes = g_hash_table_new (g_str_hash, g_str_equal);
 	g_hash_table_insert (attributes, "number", "1");
 
-	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
-	                                    SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS,
-	                                    NULL, &error);
+	records = secret_service_search_records_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                              SECRET_SEARCH_ALL, NULL, &error);
 	g_assert_no_error (error);
 	g_hash_table_unref (attributes);
 
-	g_assert (items != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
-	g_assert (secret_item_get_locked (items->data) == FALSE);
-	value = secret_item_get_secret (items->data);
-	g_assert (value != NULL);
-	secret_value_unref (value);
+	g_assert (records != NULL);
+	g_assert_cmpuint (records->len, ==, 2);
 
-	g_assert (items->next != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
-	g_assert (secret_item_get_locked (items->next->data) == TRUE);
-	g_assert (secret_item_get_secret (items->next->data) == NULL);
+	record = records->pdata[0];
+	g_assert_cmpstr (secret_record_get_dbus_path (record), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert_cmpstr (secret_record_get_label (record), ==, "Item One");
+	g_assert (secret_record_get_locked (record) == FALSE);
+	g_assert (secret_record_get_secret (record) == NULL);
+	g_assert_cmpuint (secret_record_get_created (record), >, 0);
+	g_assert_cmpuint (secret_record_get_modified (record), >, 0);
 
-	g_assert (items->next->next == NULL);
-	g_list_free_full (items, g_object_unref);
+	attributes = secret_record_get_attributes (record);
+	g_assert_cmpstr (g_hash_table_lookup (attributes, "string"), ==, "one");
+	g_assert_cmpuint (g_hash_table_size (attributes), ==, 4);
+	g_hash_table_unref (attributes);
+
+	schema_name = secret_record_get_schema_name (record);
+	g_assert_cmpstr (schema_name, ==, "org.mock.Schema");
+	g_free (schema_name);
+
+	record = records->pdata[1];
+	g_assert_cmpstr (secret_record_get_dbus_path (record), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_record_get_locked (record) == TRUE);
+	g_assert (secret_record_get_secret (record) == NULL);
+
+	g_ptr_array_unref (records);
 }
 
 static void
-test_search_secrets_async (Test *test,
+test_search_records_async (Test *test,
                            gconstpointer used)
 {
 	GAsyncResult *result = NULL;
 	GHashTable *attributes;
 	GError *error = NULL;
+	GPtrArray *records;
 	SecretValue *value;
-	GList *items;
+	gsize length;
 
 	attributes = g_hash_table_new (g_str_hash, g_str_equal);
 	g_hash_table_insert (attributes, "number", "1");
 
-	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
-	                       SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, NULL,
-	                       on_complete_get_result, &result);
+	secret_service_search_records (test->service, &MOCK_SCHEMA, attributes,
+	                               SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, NULL,
+	                               on_complete_get_result, &result);
 	g_hash_table_unref (attributes);
 	g_assert (result == NULL);
 
 	egg_test_wait ();
 
-	g_assert (G_IS_ASYNC_RESULT (result));
-	items = secret_service_search_finish (test->service, result, &error);
+	records = secret_service_search_records_finish (test->service, result, &error);
 	g_assert_no_error (error);
 	g_object_unref (result);
 
-	g_assert (items != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
-	g_assert (secret_item_get_locked (items->data) == FALSE);
-	value = secret_item_get_secret (items->data);
+	g_assert (records != NULL);
+	g_assert_cmpuint (records->len, ==, 2);
+
+	value = secret_record_get_secret (records->pdata[0]);
 	g_assert (value != NULL);
-	secret_value_unref (value);
+	g_assert_cmpstr (secret_value_get (value, &length), ==, "111");
+	g_assert_cmpuint (length, ==, 3);
 
-	g_assert (items->next != NULL);
-	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
-	g_assert (secret_item_get_locked (items->next->data) == TRUE);
-	g_assert (secret_item_get_secret (items->next->data) == NULL);
+	/* Locked, so no secret */
+	g_assert (secret_record_get_locked (records->pdata[1]) == TRUE);
+	g_assert (secret_record_get_secret (records->pdata[1]) == NULL);
 
-	g_assert (items->next->next == NULL);
-	g_list_free_full (items, g_object_unref);
+	g_ptr_array_unref (records);
 }
 
 static void
-test_lock_sync (Test *test,
-                gconstpointer used)
+test_search_records_first (Test *test,
+                           gconstpointer used)
 {
-	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockone";
-	SecretCollection *collection;
+	GHashTable *attributes;
 	GError *error = NULL;
-	GList *locked;
-	GList *objects;
-	gboolean ret;
-
-	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
-	                                                       SECRET_COLLECTION_NONE, NULL, &error);
-	g_assert_no_error (error);
+	GPtrArray *records;
 
-	objects = g_list_append (NULL, collection);
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
 
-	ret = secret_service_lock_sync (test->service, objects, NULL, &locked, &error);
+	records = secret_service_search_records_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                              SECRET_SEARCH_NONE, NULL, &error);
 	g_assert_no_error (error);
-	g_assert (ret == TRUE);
+	g_hash_table_unref (attributes);
 
-	g_assert (locked != NULL);
-	g_assert (locked->data == collection);
-	g_assert (locked->next == NULL);
-	g_list_free_full (locked, g_object_unref);
+	g_assert_cmpuint (records->len, ==, 1);
+	g_assert_cmpstr (secret_record_get_dbus_path (records->pdata[0]), ==,
+	                 "/org/freedesktop/secrets/collection/english/1");
 
-	g_list_free (objects);
-	g_object_unref (collection);
+	g_ptr_array_unref (records);
 }
 
 static void
-test_unlock_sync (Test *test,
-                  gconstpointer used)
+test_search_records_unlock (Test *test,
+                            gconstpointer used)
 {
-	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockone";
-	SecretCollection *collection;
+	GHashTable *attributes;
 	GError *error = NULL;
-	GList *unlocked;
-	GList *objects;
-	gboolean ret;
+	GPtrArray *records;
+	SecretValue *value;
 
-	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
-	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	records = secret_service_search_records_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                              SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK |
+	                                              SECRET_SEARCH_LOAD_SECRETS, NULL, &error);
 	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
 
-	objects = g_list_append (NULL, collection);
+	g_assert_cmpuint (records->len, ==, 2);
+	g_assert_cmpstr (secret_record_get_dbus_path (records->pdata[1]), ==,
+	                 "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_record_get_locked (records->pdata[1]) == FALSE);
 
-	ret = secret_service_unlock_sync (test->service, objects, NULL, &unlocked, &error);
-	g_assert_no_error (error);
-	g_assert (ret == TRUE);
+	value = secret_record_get_secret (records->pdata[1]);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, NULL), ==, "111");
 
-	g_assert (unlocked != NULL);
-	g_assert (unlocked->data == collection);
-	g_assert (unlocked->next == NULL);
-	g_list_free_full (unlocked, g_object_unref);
+	g_ptr_array_unref (records);
+}
 
-	g_list_free (objects);
-	g_object_unref (collection);
+static gboolean
+on_stream_record (SecretRecord *record,
+                  gpointer user_data)
+{
+	GPtrArray *records = user_data;
+	g_ptr_array_add (records, secret_record_ref (record));
+	return TRUE;
 }
 
-static void
-test_clear_sync (Test *test,
-                 gconstpointer used)
+static gboolean
+on_stream_record_stop (SecretRecord *record,
+                       gpointer user_data)
 {
+	GPtrArray *records = user_data;
+	g_ptr_array_add (records, secret_record_ref (record));
+	return FALSE;
+}
+
+static void
+test_search_records_stream (Test *test,
+                            gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	SecretRecord *record;
+	SecretValue *value;
+	guint emitted;
+	guint i;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	records = g_ptr_array_new_with_free_func (secret_record_unref);
+	secret_service_search_records_stream (test->service, &MOCK_SCHEMA, attributes,
+	                                      SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, 0,
+	                                      on_stream_record, g_ptr_array_ref (records),
+	                                      (GDestroyNotify)g_ptr_array_unref, NULL,
+	                                      on_complete_get_result, &result);
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	emitted = secret_service_search_records_stream_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	g_assert_cmpuint (emitted, ==, 2);
+	g_assert_cmpuint (records->len, ==, 2);
+
+	/* Emitted as loaded, so the order isn't defined */
+	for (i = 0; i < records->len; i++) {
+		record = records->pdata[i];
+		value = secret_record_get_secret (record);
+		if (g_str_equal (secret_record_get_dbus_path (record), "/org/freedesktop/secrets/collection/english/1")) {
+			g_assert (value != NULL);
+			g_assert_cmpstr (secret_value_get (value, NULL), ==, "111");
+		} else {
+			g_assert_cmpstr (secret_record_get_dbus_path (record), ==, "/org/freedesktop/secrets/collection/spanish/10");
+			g_assert (secret_record_get_locked (record) == TRUE);
+			g_assert (value == NULL);
+		}
+	}
+
+	g_ptr_array_unref (records);
+}
+
+static void
+test_search_records_stream_limit (Test *test,
+                                  gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	guint emitted;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	records = g_ptr_array_new_with_free_func (secret_record_unref);
+	emitted = secret_service_search_records_stream_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                     SECRET_SEARCH_ALL, 1,
+	                                                     on_stream_record, records,
+	                                                     NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert_cmpuint (emitted, ==, 1);
+	g_assert_cmpuint (records->len, ==, 1);
+	g_assert_cmpstr (secret_record_get_dbus_path (records->pdata[0]), ==,
+	                 "/org/freedesktop/secrets/collection/english/1");
+
+	g_ptr_array_unref (records);
+}
+
+static void
+test_search_records_stream_stop (Test *test,
+                                 gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	guint emitted;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "even", "false");
+
+	records = g_ptr_array_new_with_free_func (secret_record_unref);
+	emitted = secret_service_search_records_stream_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                     SECRET_SEARCH_ALL, 0,
+	                                                     on_stream_record_stop, records,
+	                                                     NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert_cmpuint (emitted, ==, 1);
+	g_assert_cmpuint (records->len, ==, 1);
+
+	g_ptr_array_unref (records);
+}
+
+static gboolean
+on_stream_record_nested (SecretRecord *record,
+                         gpointer user_data)
+{
+	Test *test = user_data;
+	GError *error = NULL;
+	SecretValue *value;
+
+	/* A sync call made while another one is running on this thread */
+	value = secret_service_get_secret_for_dbus_path_sync (test->service,
+	                                                      secret_record_get_dbus_path (record),
+	                                                      NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, NULL), ==, "111");
+	secret_value_unref (value);
+
+	return TRUE;
+}
+
+static void
+test_search_records_stream_nested (Test *test,
+                                   gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	guint emitted;
+	guint i;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+	g_hash_table_insert (attributes, "string", "one");
+
+	/* The outer and inner sync calls must not share a main loop */
+	for (i = 0; i < 3; i++) {
+		emitted = secret_service_search_records_stream_sync (test->service, &MOCK_SCHEMA, attributes,
+		                                                     SECRET_SEARCH_ALL, 0,
+		                                                     on_stream_record_nested, test,
+		                                                     NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpuint (emitted, ==, 1);
+	}
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_search_records_stream_collection (Test *test,
+                                       gconstpointer used)
+{
+	SecretCollection *collection;
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	SecretRecord *record;
+	SecretValue *value;
+	guint emitted;
+	guint i;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, "/org/freedesktop/secrets/collection/english",
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "even", "false");
+
+	records = g_ptr_array_new_with_free_func (secret_record_unref);
+	secret_collection_search_records_stream (collection, &MOCK_SCHEMA, attributes,
+	                                         SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, 0,
+	                                         on_stream_record, g_ptr_array_ref (records),
+	                                         (GDestroyNotify)g_ptr_array_unref, NULL,
+	                                         on_complete_get_result, &result);
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	emitted = secret_collection_search_records_stream_finish (collection, result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	/* Nothing from the spanish collection, which matches too */
+	g_assert_cmpuint (emitted, ==, 2);
+	g_assert_cmpuint (records->len, ==, 2);
+
+	for (i = 0; i < records->len; i++) {
+		record = records->pdata[i];
+		value = secret_record_get_secret (record);
+		g_assert (value != NULL);
+		if (g_str_equal (secret_record_get_dbus_path (record), "/org/freedesktop/secrets/collection/english/1")) {
+			g_assert_cmpstr (secret_value_get (value, NULL), ==, "111");
+		} else {
+			g_assert_cmpstr (secret_record_get_dbus_path (record), ==, "/org/freedesktop/secrets/collection/english/3");
+			g_assert_cmpstr (secret_value_get (value, NULL), ==, "333");
+		}
+	}
+
+	g_ptr_array_unref (records);
+	g_object_unref (collection);
+}
+
+static void
+test_search_records_stream_collection_locked (Test *test,
+                                              gconstpointer used)
+{
+	SecretCollection *collection;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	guint emitted;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, "/org/freedesktop/secrets/collection/spanish",
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	records = g_ptr_array_new_with_free_func (secret_record_unref);
+	emitted = secret_collection_search_records_stream_sync (collection, &MOCK_SCHEMA, attributes,
+	                                                        SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, 0,
+	                                                        on_stream_record, records,
+	                                                        NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert_cmpuint (emitted, ==, 1);
+	g_assert_cmpstr (secret_record_get_dbus_path (records->pdata[0]), ==,
+	                 "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_record_get_locked (records->pdata[0]) == TRUE);
+	g_assert (secret_record_get_secret (records->pdata[0]) == NULL);
+
+	g_ptr_array_unref (records);
+	g_object_unref (collection);
+}
+
+static gsize
+allocated_bytes (void)
+{
+#ifdef HAVE_MALLINFO2
+	return mallinfo2 ().uordblks;
+#else
+	return 0;
+#endif
+}
+
+static void
+test_benchmark_records (Test *test,
+                        gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GPtrArray *records;
+	GList *items;
+	gdouble elapsed;
+	gsize before;
+	gsize after;
+	guint count;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "many", "true");
+
+	before = allocated_bytes ();
+	g_test_timer_start ();
+	records = secret_service_search_records_sync (test->service, NULL, attributes,
+	                                              SECRET_SEARCH_ALL, NULL, &error);
+	elapsed = g_test_timer_elapsed ();
+	after = allocated_bytes ();
+	g_assert_no_error (error);
+
+	count = records->len;
+	g_assert_cmpuint (count, ==, 10000);
+	g_test_minimized_result (elapsed, "search %u records: %.3f sec", count, elapsed);
+	if (after > before) {
+		g_test_minimized_result (after - before, "%u records use %" G_GSIZE_FORMAT " KiB",
+		                         count, (after - before) / 1024);
+	}
+
+	g_ptr_array_unref (records);
+
+	before = allocated_bytes ();
+	g_test_timer_start ();
+	items = secret_service_search_sync (test->service, NULL, attributes,
+	                                    SECRET_SEARCH_ALL, NULL, &error);
+	elapsed = g_test_timer_elapsed ();
+	after = allocated_bytes ();
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (g_list_length (items), ==, count);
+	g_test_minimized_result (elapsed, "search %u items: %.3f sec", count, elapsed);
+	if (after > before) {
+		g_test_minimized_result (after - before, "%u items use %" G_GSIZE_FORMAT " KiB",
+		                         count, (after - before) / 1024);
+	}
+
+	g_list_free_full (items, g_object_unref);
+	g_hash_table_unref (attributes);
+}
+
+typedef struct {
+	gdouble first;
+	guint count;
+} StreamTimes;
+
+static gboolean
+on_stream_record_timed (SecretRecord *record,
+                        gpointer user_data)
+{
+	StreamTimes *times = user_data;
+	if (times->count++ == 0)
+		times->first = g_test_timer_elapsed ();
+	return TRUE;
+}
+
+static void
+test_benchmark_records_stream (Test *test,
+                               gconstpointer used)
+{
+	StreamTimes times = { 0, 0 };
+	GHashTable *attributes;
+	GError *error = NULL;
+	gdouble elapsed;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "many", "true");
+
+	g_test_timer_start ();
+	secret_service_search_records_stream_sync (test->service, NULL, attributes,
+	                                           SECRET_SEARCH_ALL, 0,
+	                                           on_stream_record_timed, &times,
+	                                           NULL, &error);
+	elapsed = g_test_timer_elapsed ();
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (times.count, ==, 10000);
+	g_test_minimized_result (times.first, "first of %u records: %.3f sec", times.count, times.first);
+	g_test_minimized_result (elapsed, "stream %u records: %.3f sec", times.count, elapsed);
+
+	/* Stopping early doesn't load the rest */
+	times.count = 0;
+	g_test_timer_start ();
+	secret_service_search_records_stream_sync (test->service, NULL, attributes,
+	                                           SECRET_SEARCH_ALL, 10,
+	                                           on_stream_record_timed, &times,
+	                                           NULL, &error);
+	elapsed = g_test_timer_elapsed ();
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (times.count, ==, 10);
+	g_test_minimized_result (elapsed, "stream first %u records: %.3f sec", times.count, elapsed);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_search_unlock_sync (Test *test,
+                         gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert (items != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (secret_item_get_locked (items->data) == FALSE);
+	g_assert (secret_item_get_secret (items->data) == NULL);
+
+	g_assert (items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_item_get_locked (items->next->data) == FALSE);
+	g_assert (secret_item_get_secret (items->next->data) == NULL);
+
+	g_assert (items->next->next == NULL);
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_search_unlock_async (Test *test,
+                          gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	GList *items;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
+	                       SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK, NULL,
+	                       on_complete_get_result, &result);
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	g_assert (G_IS_ASYNC_RESULT (result));
+	items = secret_service_search_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	g_assert (items != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (secret_item_get_locked (items->data) == FALSE);
+	g_assert (secret_item_get_secret (items->data) == NULL);
+
+	g_assert (items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_item_get_locked (items->next->data) == FALSE);
+	g_assert (secret_item_get_secret (items->next->data) == NULL);
+
+	g_assert (items->next->next == NULL);
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_search_secrets_sync (Test *test,
+                          gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	SecretValue *value;
+	GList *items;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	items = secret_service_search_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                    SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS,
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert (items != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (secret_item_get_locked (items->data) == FALSE);
+	value = secret_item_get_secret (items->data);
+	g_assert (value != NULL);
+	secret_value_unref (value);
+
+	g_assert (items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_item_get_locked (items->next->data) == TRUE);
+	g_assert (secret_item_get_secret (items->next->data) == NULL);
+
+	g_assert (items->next->next == NULL);
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_search_secrets_async (Test *test,
+                           gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	GError *error = NULL;
+	SecretValue *value;
+	GList *items;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+
+	secret_service_search (test->service, &MOCK_SCHEMA, attributes,
+	                       SECRET_SEARCH_ALL | SECRET_SEARCH_LOAD_SECRETS, NULL,
+	                       on_complete_get_result, &result);
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	g_assert (G_IS_ASYNC_RESULT (result));
+	items = secret_service_search_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	g_assert (items != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->data), ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (secret_item_get_locked (items->data) == FALSE);
+	value = secret_item_get_secret (items->data);
+	g_assert (value != NULL);
+	secret_value_unref (value);
+
+	g_assert (items->next != NULL);
+	g_assert_cmpstr (g_dbus_proxy_get_object_path (items->next->data), ==, "/org/freedesktop/secrets/collection/spanish/10");
+	g_assert (secret_item_get_locked (items->next->data) == TRUE);
+	g_assert (secret_item_get_secret (items->next->data) == NULL);
+
+	g_assert (items->next->next == NULL);
+	g_list_free_full (items, g_object_unref);
+}
+
+static void
+test_lock_sync (Test *test,
+                gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockone";
+	SecretCollection *collection;
+	GError *error = NULL;
+	GList *locked;
+	GList *objects;
+	gboolean ret;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	objects = g_list_append (NULL, collection);
+
+	ret = secret_service_lock_sync (test->service, objects, NULL, &locked, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_assert (locked != NULL);
+	g_assert (locked->data == collection);
+	g_assert (locked->next == NULL);
+	g_list_free_full (locked, g_object_unref);
+
+	g_list_free (objects);
+	g_object_unref (collection);
+}
+
+static void
+test_unlock_sync (Test *test,
+                  gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/lockone";
+	SecretCollection *collection;
+	GError *error = NULL;
+	GList *unlocked;
+	GList *objects;
+	gboolean ret;
+
+	collection = secret_collection_new_for_dbus_path_sync (test->service, collection_path,
+	                                                       SECRET_COLLECTION_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	objects = g_list_append (NULL, collection);
+
+	ret = secret_service_unlock_sync (test->service, objects, NULL, &unlocked, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_assert (unlocked != NULL);
+	g_assert (unlocked->data == collection);
+	g_assert (unlocked->next == NULL);
+	g_list_free_full (unlocked, g_object_unref);
+
+	g_list_free (objects);
+	g_object_unref (collection);
+}
+
+static void
+test_clear_sync (Test *test,
+                 gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
+	                                      NULL);
+
+	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_clear_async (Test *test,
+                  gconstpointer used)
+{
+	GError *error = NULL;
+	GAsyncResult *result = NULL;
+	GHashTable *attributes;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
+	                                      NULL);
+
+	secret_service_clear (test->service, &MOCK_SCHEMA, attributes, NULL,
+	                      on_complete_get_result, &result);
+
+	g_hash_table_unref (attributes);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	ret = secret_service_clear_finish (test->service, result, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_object_unref (result);
+}
+
+static void
+test_clear_locked (Test *test,
+                   gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "tres",
+	                                      "number", 3,
+	                                      NULL);
+
+	/* Locked items can't be removed via this API */
+	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_hash_table_unref (attributes);
+	g_assert_no_error (error);
+	g_assert (ret == FALSE);
+}
+
+static void
+test_clear_no_match (Test *test,
+                     gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", TRUE,
+	                                      "string", "one",
+	                                      NULL);
+
+	/* Won't match anything */
+	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_hash_table_unref (attributes);
+	g_assert_no_error (error);
+	g_assert (ret == FALSE);
+}
+
+static void
+test_clear_no_name (Test *test,
+                    gconstpointer used)
+{
+	const gchar *paths[] = { "/org/freedesktop/secrets/collection/german", NULL };
+	GError *error = NULL;
+	GHashTable *attributes;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "number", 5,
+	                                      NULL);
+
+	/* Shouldn't match anything, because no item with 5 in mock schema */
+	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == FALSE);
+
+	/* We need this collection unlocked for the next test */
+	secret_service_unlock_dbus_paths_sync (test->service, paths, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	/* We have an item with 5 in prime schema, but should match anyway becase of flags */
+	ret = secret_service_clear_sync (test->service, &NO_NAME_SCHEMA, attributes, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_hash_table_unref (attributes);
+}
+
+typedef struct {
+	guint calls;
+	guint cleared;
+	guint total;
+} ClearProgress;
+
+static void
+on_clear_progress (guint cleared,
+                   guint total,
+                   gpointer user_data)
+{
+	ClearProgress *progress = user_data;
+
+	g_assert_cmpuint (cleared, >=, progress->cleared);
+	progress->calls++;
+	progress->cleared = cleared;
+	progress->total = total;
+}
+
+static void
+test_clear_full (Test *test,
+                 gconstpointer used)
+{
+	ClearProgress progress = { 0, };
+	GError *error = NULL;
+	GHashTable *attributes;
+	gchar **unlocked;
+	guint cleared = 0;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      NULL);
+
+	ret = secret_service_clear_full_sync (test->service, &MOCK_SCHEMA, attributes, 1,
+	                                      on_clear_progress, &progress, NULL,
+	                                      &cleared, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Only the unlocked items are removed */
+	g_assert_cmpuint (cleared, ==, 2);
+	g_assert_cmpuint (progress.calls, >=, 1);
+	g_assert_cmpuint (progress.cleared, ==, 2);
+	g_assert_cmpuint (progress.total, ==, 2);
+
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &unlocked, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (unlocked[0] == NULL);
+	g_strfreev (unlocked);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_clear_full_mixed (Test *test,
+                       gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	guint cleared = 0;
+	gboolean ret;
+
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "batch", "true");
+
+	/* One item is removed directly, one after a prompt, one is locked */
+	ret = secret_service_clear_full_sync (test->service, NULL, attributes, 0,
+	                                      NULL, NULL, NULL, &cleared, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpuint (cleared, ==, 2);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_clear_full_cancelled (Test *test,
+                           gconstpointer used)
+{
+	GCancellable *cancellable;
 	GError *error = NULL;
 	GHashTable *attributes;
+	guint cleared = 1;
+	gboolean ret;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      NULL);
+
+	cancellable = g_cancellable_new ();
+	g_cancellable_cancel (cancellable);
+
+	ret = secret_service_clear_full_sync (test->service, &MOCK_SCHEMA, attributes, 0,
+	                                      NULL, NULL, cancellable, &cleared, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert (ret == FALSE);
+	g_assert_cmpuint (cleared, ==, 0);
+	g_clear_error (&error);
+
+	g_object_unref (cancellable);
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_benchmark_clear (Test *test,
+                      gconstpointer used)
+{
+	GHashTable *attributes;
+	GError *error = NULL;
+	gdouble elapsed;
+	guint cleared;
 	gboolean ret;
 
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "many", "true");
+
+	g_test_timer_start ();
+	ret = secret_service_clear_full_sync (test->service, NULL, attributes, 0,
+	                                      NULL, NULL, NULL, &cleared, &error);
+	elapsed = g_test_timer_elapsed ();
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_assert_cmpuint (cleared, ==, 10000);
+	g_test_minimized_result (elapsed, "clear %u items%s: %.3f sec", cleared,
+	                         _secret_service_has_capability (test->service, SECRET_CAPABILITY_DELETE_ITEMS) ?
+	                                 " with extension" : "",
+	                         elapsed);
+
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_lookup_sync (Test *test,
+                  gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+	gsize length;
+
 	attributes = secret_attributes_build (&MOCK_SCHEMA,
 	                                      "even", FALSE,
 	                                      "string", "one",
 	                                      "number", 1,
 	                                      NULL);
 
-	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, &length), ==, "111");
+	g_assert_cmpuint (length, ==, 3);
+
+	secret_value_unref (value);
+}
+
+static void
+test_lookup_async (Test *test,
+                   gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	GAsyncResult *result = NULL;
+	SecretValue *value;
+	gsize length;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
+	                                      NULL);
+
+	secret_service_lookup (test->service, &MOCK_SCHEMA, attributes, NULL,
+	                        on_complete_get_result, &result);
+
+	g_assert (result == NULL);
+	g_hash_table_unref (attributes);
+
+	egg_test_wait ();
+
+	value = secret_service_lookup_finish (test->service, result, &error);
+	g_assert_no_error (error);
+
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, &length), ==, "111");
+	g_assert_cmpuint (length, ==, 3);
+
+	secret_value_unref (value);
+	g_object_unref (result);
+}
+
+static void
+test_lookup_locked (Test *test,
+                    gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+	gsize length;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", FALSE,
+	                                      "string", "tres",
+	                                      "number", 3,
+	                                      NULL);
+
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_assert_no_error (error);
+	g_hash_table_unref (attributes);
+
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, &length), ==, "3333");
+	g_assert_cmpuint (length, ==, 4);
+
+	secret_value_unref (value);
+}
+
+static void
+test_lookup_no_match (Test *test,
+                      gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "even", TRUE,
+	                                      "string", "one",
+	                                      NULL);
+
+	/* Won't match anything */
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+
+	g_assert_no_error (error);
+	g_assert (value == NULL);
+	g_hash_table_unref (attributes);
+}
+
+static void
+test_lookup_no_name (Test *test,
+                     gconstpointer used)
+{
+	GError *error = NULL;
+	GHashTable *attributes;
+	SecretValue *value;
+	gsize length;
+
+	attributes = secret_attributes_build (&MOCK_SCHEMA,
+	                                      "number", 5,
+	                                      NULL);
+
+	/* should return null, because nothing with mock schema and 5 */
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value == NULL);
+
+	/* should return an item, because we have a prime schema with 5, and flags not to match name */
+	value = secret_service_lookup_sync (test->service, &NO_NAME_SCHEMA, attributes, NULL, &error);
 
 	g_assert_no_error (error);
-	g_assert (ret == TRUE);
 
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get (value, &length), ==, "555");
+	g_assert_cmpuint (length, ==, 3);
+
+	secret_value_unref (value);
 	g_hash_table_unref (attributes);
 }
 
 static void
-test_clear_async (Test *test,
-                  gconstpointer used)
+test_lookup_capability (Test *test,
+                        gconstpointer used)
+{
+	g_assert (_secret_service_has_capability (test->service, SECRET_CAPABILITY_LOOKUP_SECRET));
+	g_assert (!_secret_service_has_capability (test->service, "not-a-capability"));
+}
+
+static void
+test_lookup_no_capability (Test *test,
+                           gconstpointer used)
+{
+	g_assert (!_secret_service_has_capability (test->service, SECRET_CAPABILITY_LOOKUP_SECRET));
+}
+
+static void
+test_cache_lookup (Test *test,
+                   gconstpointer used)
 {
 	GError *error = NULL;
-	GAsyncResult *result = NULL;
 	GHashTable *attributes;
+	SecretValue *value;
+	guint64 hits, misses, invalidations;
+	gchar **paths;
 	gboolean ret;
+	guint i;
+
+	g_assert (secret_service_get_flags (test->service) & SECRET_SERVICE_CACHE_SEARCHES);
 
 	attributes = secret_attributes_build (&MOCK_SCHEMA,
 	                                      "even", FALSE,
@@ -486,102 +1668,175 @@ test_clear_async (Test *test,
 	                                      "number", 1,
 	                                      NULL);
 
-	secret_service_clear (test->service, &MOCK_SCHEMA, attributes, NULL,
-	                      on_complete_get_result, &result);
+	for (i = 0; i < 3; i++) {
+		value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+		g_assert_no_error (error);
+		g_assert (value != NULL);
+		g_assert_cmpstr (secret_value_get_text (value), ==, "111");
+		secret_value_unref (value);
+	}
 
 	g_hash_table_unref (attributes);
-	g_assert (result == NULL);
 
-	egg_test_wait ();
+	/* Same attributes inserted in another order */
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+	g_hash_table_insert (attributes, "string", "one");
+	g_hash_table_insert (attributes, "even", "false");
 
-	ret = secret_service_clear_finish (test->service, result, &error);
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &paths, NULL, &error);
 	g_assert_no_error (error);
 	g_assert (ret == TRUE);
+	g_assert (paths != NULL);
+	g_assert_cmpstr (paths[0], ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (paths[1] == NULL);
+	g_strfreev (paths);
+	g_hash_table_unref (attributes);
 
-	g_object_unref (result);
+	secret_service_get_search_cache_stats (test->service, &hits, &misses, &invalidations);
+	g_assert_cmpuint (misses, ==, 1);
+	g_assert_cmpuint (hits, ==, 3);
+	g_assert_cmpuint (invalidations, ==, 0);
 }
 
 static void
-test_clear_locked (Test *test,
-                   gconstpointer used)
+test_cache_created (Test *test,
+                    gconstpointer used)
 {
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/english";
 	GError *error = NULL;
 	GHashTable *attributes;
+	SecretValue *value;
+	guint64 hits, misses, invalidations;
 	gboolean ret;
 
 	attributes = secret_attributes_build (&MOCK_SCHEMA,
 	                                      "even", FALSE,
-	                                      "string", "tres",
-	                                      "number", 3,
+	                                      "string", "seventeen",
+	                                      "number", 17,
 	                                      NULL);
 
-	/* Locked items can't be removed via this API */
-	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	/* Remembers that nothing matched */
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value == NULL);
 
-	g_hash_table_unref (attributes);
+	value = secret_value_new ("apassword", -1, "text/plain");
+	ret = secret_service_store_sync (test->service, &MOCK_SCHEMA, attributes, collection_path,
+	                                 "New Item Label", value, NULL, &error);
 	g_assert_no_error (error);
-	g_assert (ret == FALSE);
+	g_assert (ret == TRUE);
+	secret_value_unref (value);
+
+	/* The ItemCreated signal arrived before the reply */
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "apassword");
+	secret_value_unref (value);
+
+	g_hash_table_unref (attributes);
+
+	secret_service_get_search_cache_stats (test->service, &hits, &misses, &invalidations);
+	g_assert_cmpuint (hits, ==, 0);
+	g_assert_cmpuint (misses, >=, 2);
+	g_assert_cmpuint (invalidations, >=, 1);
 }
 
 static void
-test_clear_no_match (Test *test,
-                     gconstpointer used)
+test_cache_deleted (Test *test,
+                    gconstpointer used)
 {
+	const gchar *path_item_one = "/org/freedesktop/secrets/collection/english/1";
 	GError *error = NULL;
 	GHashTable *attributes;
+	guint64 invalidations;
+	gchar **paths;
 	gboolean ret;
 
-	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "even", TRUE,
-	                                      "string", "one",
-	                                      NULL);
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+	g_hash_table_insert (attributes, "string", "one");
 
-	/* Won't match anything */
-	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &paths, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (paths[0], ==, path_item_one);
+	g_strfreev (paths);
 
-	g_hash_table_unref (attributes);
+	ret = secret_service_delete_item_dbus_path_sync (test->service, path_item_one, NULL, &error);
 	g_assert_no_error (error);
-	g_assert (ret == FALSE);
+	g_assert (ret == TRUE);
+
+	secret_service_get_search_cache_stats (test->service, NULL, NULL, &invalidations);
+	g_assert_cmpuint (invalidations, ==, 1);
+
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &paths, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert (paths != NULL);
+	g_assert (paths[0] == NULL);
+	g_strfreev (paths);
+
+	g_hash_table_unref (attributes);
 }
 
 static void
-test_clear_no_name (Test *test,
-                    gconstpointer used)
+test_cache_locked (Test *test,
+                   gconstpointer used)
 {
-	const gchar *paths[] = { "/org/freedesktop/secrets/collection/german", NULL };
+	const gchar *paths[] = { "/org/freedesktop/secrets/collection/english", NULL };
 	GError *error = NULL;
 	GHashTable *attributes;
+	gchar **unlocked;
+	gchar **locked;
 	gboolean ret;
+	gint count;
 
-	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "number", 5,
-	                                      NULL);
+	attributes = g_hash_table_new (g_str_hash, g_str_equal);
+	g_hash_table_insert (attributes, "number", "1");
+	g_hash_table_insert (attributes, "string", "one");
 
-	/* Shouldn't match anything, because no item with 5 in mock schema */
-	ret = secret_service_clear_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &unlocked, &locked, &error);
 	g_assert_no_error (error);
-	g_assert (ret == FALSE);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (unlocked[0], ==, "/org/freedesktop/secrets/collection/english/1");
+	g_assert (locked[0] == NULL);
+	g_strfreev (unlocked);
+	g_strfreev (locked);
 
-	/* We need this collection unlocked for the next test */
-	secret_service_unlock_dbus_paths_sync (test->service, paths, NULL, NULL, &error);
+	/* Only a PropertiesChanged for the collection is emitted */
+	count = secret_service_lock_dbus_paths_sync (test->service, paths, NULL, NULL, &error);
 	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
 
-	/* We have an item with 5 in prime schema, but should match anyway becase of flags */
-	ret = secret_service_clear_sync (test->service, &NO_NAME_SCHEMA, attributes, NULL, &error);
+	ret = secret_service_search_for_dbus_paths_sync (test->service, &MOCK_SCHEMA, attributes,
+	                                                 NULL, &unlocked, &locked, &error);
 	g_assert_no_error (error);
 	g_assert (ret == TRUE);
+	g_assert (unlocked[0] == NULL);
+	g_assert_cmpstr (locked[0], ==, "/org/freedesktop/secrets/collection/english/1");
+	g_strfreev (unlocked);
+	g_strfreev (locked);
 
 	g_hash_table_unref (attributes);
 }
 
 static void
-test_lookup_sync (Test *test,
-                  gconstpointer used)
+test_secret_cache_lookup (Test *test,
+                          gconstpointer used)
 {
 	GError *error = NULL;
 	GHashTable *attributes;
 	SecretValue *value;
-	gsize length;
+	guint64 hits, misses;
+	guint i;
+
+	secret_service_set_secret_cache_policy (test->service, -1, 0);
 
 	attributes = secret_attributes_build (&MOCK_SCHEMA,
 	                                      "even", FALSE,
@@ -589,129 +1844,125 @@ test_lookup_sync (Test *test,
 	                                      "number", 1,
 	                                      NULL);
 
-	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	for (i = 0; i < 3; i++) {
+		value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+		g_assert_no_error (error);
+		g_assert (value != NULL);
+		g_assert_cmpstr (secret_value_get_text (value), ==, "111");
+		secret_value_unref (value);
+	}
 
-	g_assert_no_error (error);
 	g_hash_table_unref (attributes);
 
-	g_assert (value != NULL);
-	g_assert_cmpstr (secret_value_get (value, &length), ==, "111");
-	g_assert_cmpuint (length, ==, 3);
-
-	secret_value_unref (value);
+	secret_service_get_secret_cache_stats (test->service, &hits, &misses, NULL, NULL);
+	g_assert_cmpuint (misses, ==, 1);
+	g_assert_cmpuint (hits, ==, 2);
 }
 
 static void
-test_lookup_async (Test *test,
-                   gconstpointer used)
+test_secret_cache_expires (Test *test,
+                           gconstpointer used)
 {
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
 	GError *error = NULL;
-	GHashTable *attributes;
-	GAsyncResult *result = NULL;
 	SecretValue *value;
-	gsize length;
+	guint64 hits, misses, evictions;
 
-	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "even", FALSE,
-	                                      "string", "one",
-	                                      "number", 1,
-	                                      NULL);
+	secret_service_set_secret_cache_policy (test->service, -1, 1);
 
-	secret_service_lookup (test->service, &MOCK_SCHEMA, attributes, NULL,
-	                        on_complete_get_result, &result);
+	value = secret_service_get_secret_for_dbus_path_sync (test->service, item_path, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value != NULL);
+	secret_value_unref (value);
 
-	g_assert (result == NULL);
-	g_hash_table_unref (attributes);
+	value = secret_service_get_secret_for_dbus_path_sync (test->service, item_path, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value != NULL);
+	secret_value_unref (value);
 
-	egg_test_wait ();
+	g_usleep (G_USEC_PER_SEC + G_USEC_PER_SEC / 10);
 
-	value = secret_service_lookup_finish (test->service, result, &error);
+	value = secret_service_get_secret_for_dbus_path_sync (test->service, item_path, NULL, &error);
 	g_assert_no_error (error);
-
 	g_assert (value != NULL);
-	g_assert_cmpstr (secret_value_get (value, &length), ==, "111");
-	g_assert_cmpuint (length, ==, 3);
-
+	g_assert_cmpstr (secret_value_get_text (value), ==, "111");
 	secret_value_unref (value);
-	g_object_unref (result);
+
+	secret_service_get_secret_cache_stats (test->service, &hits, &misses, &evictions, NULL);
+	g_assert_cmpuint (hits, ==, 1);
+	g_assert_cmpuint (misses, ==, 2);
+	g_assert_cmpuint (evictions, ==, 1);
 }
 
 static void
-test_lookup_locked (Test *test,
-                    gconstpointer used)
+test_secret_cache_locked (Test *test,
+                          gconstpointer used)
 {
+	const gchar *paths[] = { "/org/freedesktop/secrets/collection/english", NULL };
+	const gchar *item_path = "/org/freedesktop/secrets/collection/english/1";
 	GError *error = NULL;
-	GHashTable *attributes;
 	SecretValue *value;
-	gsize length;
-
-	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "even", FALSE,
-	                                      "string", "tres",
-	                                      "number", 3,
-	                                      NULL);
+	gsize bytes;
+	gint count;
 
-	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	secret_service_set_secret_cache_policy (test->service, -1, 0);
 
+	value = secret_service_get_secret_for_dbus_path_sync (test->service, item_path, NULL, &error);
 	g_assert_no_error (error);
-	g_hash_table_unref (attributes);
-
 	g_assert (value != NULL);
-	g_assert_cmpstr (secret_value_get (value, &length), ==, "3333");
-	g_assert_cmpuint (length, ==, 4);
-
 	secret_value_unref (value);
-}
 
-static void
-test_lookup_no_match (Test *test,
-                      gconstpointer used)
-{
-	GError *error = NULL;
-	GHashTable *attributes;
-	SecretValue *value;
+	secret_service_get_secret_cache_stats (test->service, NULL, NULL, NULL, &bytes);
+	g_assert_cmpuint (bytes, ==, 3);
 
-	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "even", TRUE,
-	                                      "string", "one",
-	                                      NULL);
+	count = secret_service_lock_dbus_paths_sync (test->service, paths, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (count, ==, 1);
 
-	/* Won't match anything */
-	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	secret_service_get_secret_cache_stats (test->service, NULL, NULL, NULL, &bytes);
+	g_assert_cmpuint (bytes, ==, 0);
 
+	value = secret_service_get_secret_for_dbus_path_sync (test->service, item_path, NULL, &error);
 	g_assert_no_error (error);
 	g_assert (value == NULL);
-	g_hash_table_unref (attributes);
 }
 
 static void
-test_lookup_no_name (Test *test,
-                     gconstpointer used)
+test_benchmark_lookup (Test *test,
+                       gconstpointer used)
 {
 	GError *error = NULL;
 	GHashTable *attributes;
 	SecretValue *value;
-	gsize length;
+	gdouble elapsed = 0;
+	guint iterations = 500;
+	guint i;
 
 	attributes = secret_attributes_build (&MOCK_SCHEMA,
-	                                      "number", 5,
+	                                      "even", FALSE,
+	                                      "string", "one",
+	                                      "number", 1,
 	                                      NULL);
 
-	/* should return null, because nothing with mock schema and 5 */
-	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+	/* Don't count opening the session */
+	secret_service_ensure_session_sync (test->service, NULL, &error);
 	g_assert_no_error (error);
-	g_assert (value == NULL);
 
-	/* should return an item, because we have a prime schema with 5, and flags not to match name */
-	value = secret_service_lookup_sync (test->service, &NO_NAME_SCHEMA, attributes, NULL, &error);
+	for (i = 0; i < iterations; i++) {
+		g_test_timer_start ();
+		value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes, NULL, &error);
+		elapsed += g_test_timer_elapsed ();
 
-	g_assert_no_error (error);
+		g_assert_no_error (error);
+		g_assert (value != NULL);
+		secret_value_unref (value);
+	}
 
-	g_assert (value != NULL);
-	g_assert_cmpstr (secret_value_get (value, &length), ==, "555");
-	g_assert_cmpuint (length, ==, 3);
+	g_test_minimized_result (elapsed / iterations, "lookup%s: %.3f msec",
+	                         _secret_service_has_capability (test->service, SECRET_CAPABILITY_LOOKUP_SECRET) ?
+	                                 " with extension" : "",
+	                         (elapsed / iterations) * 1000);
 
-	secret_value_unref (value);
 	g_hash_table_unref (attributes);
 }
 
@@ -765,6 +2016,130 @@ test_store_sync (Test *test,
 	g_strfreev (paths);
 }
 
+static void
+test_store_many_sync (Test *test,
+                      gconstpointer used)
+{
+	const gchar *labels[] = { "Label One", "Label Two", "Label Three" };
+	SecretValue *values[3];
+	GHashTable *attributes[3];
+	GPtrArray *errors = NULL;
+	GError *error = NULL;
+	SecretValue *value;
+	gboolean ret;
+	guint i;
+
+	for (i = 0; i < 3; i++) {
+		attributes[i] = secret_attributes_build (&MOCK_SCHEMA,
+		                                         "string", "many",
+		                                         "number", 100 + i,
+		                                         NULL);
+		values[i] = secret_value_new (labels[i], -1, "text/plain");
+	}
+
+	ret = secret_service_store_many_sync (test->service, &MOCK_SCHEMA, attributes, labels,
+	                                      values, 3, SECRET_COLLECTION_DEFAULT, NULL,
+	                                      &errors, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	g_assert (errors != NULL);
+	g_assert_cmpuint (errors->len, ==, 3);
+	for (i = 0; i < 3; i++)
+		g_assert (errors->pdata[i] == NULL);
+	g_ptr_array_unref (errors);
+
+	for (i = 0; i < 3; i++) {
+		value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes[i],
+		                                    NULL, &error);
+		g_assert_no_error (error);
+		g_assert (value != NULL);
+		g_assert_cmpstr (secret_value_get_text (value), ==, labels[i]);
+		secret_value_unref (value);
+
+		secret_value_unref (values[i]);
+		g_hash_table_unref (attributes[i]);
+	}
+}
+
+static void
+test_store_many_no_collection (Test *test,
+                               gconstpointer used)
+{
+	const gchar *collection_path = "/org/freedesktop/secrets/collection/nonexistent";
+	const gchar *labels[] = { "Label One", "Label Two" };
+	SecretValue *values[2];
+	GHashTable *attributes[2];
+	GPtrArray *errors = NULL;
+	GError *error = NULL;
+	gboolean ret;
+	guint i;
+
+	for (i = 0; i < 2; i++) {
+		attributes[i] = secret_attributes_build (&MOCK_SCHEMA, "number", 100 + i, NULL);
+		values[i] = secret_value_new ("apassword", -1, "text/plain");
+	}
+
+	/* Each item reports its own failure */
+	ret = secret_service_store_many_sync (test->service, &MOCK_SCHEMA, attributes, labels,
+	                                      values, 2, collection_path, NULL, &errors, &error);
+	g_assert (ret == FALSE);
+	g_assert (error != NULL);
+	g_clear_error (&error);
+
+	g_assert (errors != NULL);
+	g_assert_cmpuint (errors->len, ==, 2);
+	for (i = 0; i < 2; i++)
+		g_assert (errors->pdata[i] != NULL);
+	g_ptr_array_unref (errors);
+
+	/* An alias which doesn't exist fails as a whole */
+	ret = secret_service_store_many_sync (test->service, &MOCK_SCHEMA, attributes, labels,
+	                                      values, 2, "nonexistent", NULL, &errors, &error);
+	g_assert_error (error, SECRET_ERROR, SECRET_ERROR_NO_SUCH_OBJECT);
+	g_assert (ret == FALSE);
+	g_assert (errors == NULL);
+	g_clear_error (&error);
+
+	for (i = 0; i < 2; i++) {
+		secret_value_unref (values[i]);
+		g_hash_table_unref (attributes[i]);
+	}
+}
+
+static void
+test_store_many_no_default (Test *test,
+                            gconstpointer used)
+{
+	const gchar *labels[] = { "New Item Label" };
+	SecretValue *values[1];
+	GHashTable *attributes[1];
+	GError *error = NULL;
+	SecretValue *value;
+	gboolean ret;
+
+	attributes[0] = secret_attributes_build (&MOCK_SCHEMA,
+	                                         "string", "seventeen",
+	                                         "number", 17,
+	                                         NULL);
+	values[0] = secret_value_new ("apassword", -1, "text/plain");
+
+	ret = secret_service_store_many_sync (test->service, &MOCK_SCHEMA, attributes, labels,
+	                                      values, 1, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	value = secret_service_lookup_sync (test->service, &MOCK_SCHEMA, attributes[0],
+	                                    NULL, &error);
+	g_assert_no_error (error);
+	g_assert (value != NULL);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "apassword");
+
+	secret_value_unref (value);
+	secret_value_unref (values[0]);
+	g_hash_table_unref (attributes[0]);
+}
+
 static void
 test_store_replace (Test *test,
                     gconstpointer used)
@@ -965,8 +2340,23 @@ main (int argc, char **argv)
 
 	g_test_add ("/service/search-sync", Test, "mock-service-normal.py", setup, test_search_sync, teardown);
 	g_test_add ("/service/search-async", Test, "mock-service-normal.py", setup, test_search_async, teardown);
+	g_test_add ("/service/search-sync-notify", Test, "mock-service-normal.py", setup, test_search_sync_notify, teardown);
+	g_test_add ("/service/search-reuse", Test, "mock-service-normal.py", setup, test_search_reuse, teardown);
+	g_test_add ("/service/search-reuse-async", Test, "mock-service-normal.py", setup, test_search_reuse_async, teardown);
 	g_test_add ("/service/search-all-sync", Test, "mock-service-normal.py", setup, test_search_all_sync, teardown);
 	g_test_add ("/service/search-all-async", Test, "mock-service-normal.py", setup, test_search_all_async, teardown);
+	g_test_add ("/service/search-all-many-sync", Test, "mock-service-normal.py", setup_throttled, test_search_all_many_sync, teardown_throttled);
+	g_test_add ("/service/search-all-many-async", Test, "mock-service-normal.py", setup_throttled, test_search_all_many_async, teardown_throttled);
+	g_test_add ("/service/search-records-sync", Test, "mock-service-normal.py", setup, test_search_records_sync, teardown);
+	g_test_add ("/service/search-records-async", Test, "mock-service-normal.py", setup, test_search_records_async, teardown);
+	g_test_add ("/service/search-records-first", Test, "mock-service-normal.py", setup, test_search_records_first, teardown);
+	g_test_add ("/service/search-records-unlock", Test, "mock-service-normal.py", setup, test_search_records_unlock, teardown);
+	g_test_add ("/service/search-records-stream", Test, "mock-service-normal.py", setup, test_search_records_stream, teardown);
+	g_test_add ("/service/search-records-stream-limit", Test, "mock-service-normal.py", setup, test_search_records_stream_limit, teardown);
+	g_test_add ("/service/search-records-stream-stop", Test, "mock-service-normal.py", setup, test_search_records_stream_stop, teardown);
+	g_test_add ("/service/search-records-stream-nested", Test, "mock-service-normal.py", setup, test_search_records_stream_nested, teardown);
+	g_test_add ("/service/search-records-stream-collection", Test, "mock-service-normal.py", setup, test_search_records_stream_collection, teardown);
+	g_test_add ("/service/search-records-stream-collection-locked", Test, "mock-service-normal.py", setup, test_search_records_stream_collection_locked, teardown);
 	g_test_add ("/service/search-unlock-sync", Test, "mock-service-normal.py", setup, test_search_unlock_sync, teardown);
 	g_test_add ("/service/search-unlock-async", Test, "mock-service-normal.py", setup, test_search_unlock_async, teardown);
 	g_test_add ("/service/search-secrets-sync", Test, "mock-service-normal.py", setup, test_search_secrets_sync, teardown);
@@ -981,19 +2371,52 @@ main (int argc, char **argv)
 	g_test_add ("/service/lookup-locked", Test, "mock-service-normal.py", setup, test_lookup_locked, teardown);
 	g_test_add ("/service/lookup-no-match", Test, "mock-service-normal.py", setup, test_lookup_no_match, teardown);
 	g_test_add ("/service/lookup-no-name", Test, "mock-service-normal.py", setup, test_lookup_no_name, teardown);
+	g_test_add ("/service/lookup-capability", Test, "mock-service-normal.py", setup, test_lookup_capability, teardown);
+	g_test_add ("/service/lookup-no-capability", Test, "mock-service-no-extensions.py", setup, test_lookup_no_capability, teardown);
+	g_test_add ("/service/lookup-sync-no-extensions", Test, "mock-service-no-extensions.py", setup, test_lookup_sync, teardown);
+	g_test_add ("/service/lookup-async-no-extensions", Test, "mock-service-no-extensions.py", setup, test_lookup_async, teardown);
+	g_test_add ("/service/lookup-locked-no-extensions", Test, "mock-service-no-extensions.py", setup, test_lookup_locked, teardown);
+	g_test_add ("/service/lookup-sync-malformed", Test, "mock-service-lookup-malformed.py", setup, test_lookup_sync, teardown);
+	g_test_add ("/service/lookup-async-malformed", Test, "mock-service-lookup-malformed.py", setup, test_lookup_async, teardown);
+	g_test_add ("/service/lookup-no-match-no-extensions", Test, "mock-service-no-extensions.py", setup, test_lookup_no_match, teardown);
+
+	g_test_add ("/service/cache-lookup", Test, "mock-service-normal.py", setup_cache, test_cache_lookup, teardown);
+	g_test_add ("/service/cache-created", Test, "mock-service-signals.py", setup_cache, test_cache_created, teardown);
+	g_test_add ("/service/cache-deleted", Test, "mock-service-signals.py", setup_cache, test_cache_deleted, teardown);
+	g_test_add ("/service/cache-locked", Test, "mock-service-normal.py", setup_cache, test_cache_locked, teardown);
+	g_test_add ("/service/secret-cache-lookup", Test, "mock-service-normal.py", setup_cache, test_secret_cache_lookup, teardown);
+	g_test_add ("/service/secret-cache-expires", Test, "mock-service-normal.py", setup, test_secret_cache_expires, teardown);
+	g_test_add ("/service/secret-cache-locked", Test, "mock-service-normal.py", setup, test_secret_cache_locked, teardown);
 
 	g_test_add ("/service/clear-sync", Test, "mock-service-delete.py", setup, test_clear_sync, teardown);
 	g_test_add ("/service/clear-async", Test, "mock-service-delete.py", setup, test_clear_async, teardown);
 	g_test_add ("/service/clear-locked", Test, "mock-service-delete.py", setup, test_clear_locked, teardown);
 	g_test_add ("/service/clear-no-match", Test, "mock-service-delete.py", setup, test_clear_no_match, teardown);
 	g_test_add ("/service/clear-no-name", Test, "mock-service-delete.py", setup, test_clear_no_name, teardown);
+	g_test_add ("/service/clear-full", Test, "mock-service-normal.py", setup, test_clear_full, teardown);
+	g_test_add ("/service/clear-full-no-extensions", Test, "mock-service-no-extensions.py", setup, test_clear_full, teardown);
+	g_test_add ("/service/clear-full-mixed", Test, "mock-service-delete.py", setup, test_clear_full_mixed, teardown);
+	g_test_add ("/service/clear-full-cancelled", Test, "mock-service-normal.py", setup, test_clear_full_cancelled, teardown);
 
 	g_test_add ("/service/store-sync", Test, "mock-service-normal.py", setup, test_store_sync, teardown);
 	g_test_add ("/service/store-async", Test, "mock-service-normal.py", setup, test_store_async, teardown);
 	g_test_add ("/service/store-replace", Test, "mock-service-normal.py", setup, test_store_replace, teardown);
 	g_test_add ("/service/store-no-default", Test, "mock-service-empty.py", setup, test_store_no_default, teardown);
+	g_test_add ("/service/store-many-sync", Test, "mock-service-normal.py", setup, test_store_many_sync, teardown);
+	g_test_add ("/service/store-many-no-collection", Test, "mock-service-normal.py", setup, test_store_many_no_collection, teardown);
+	g_test_add ("/service/store-many-no-default", Test, "mock-service-empty.py", setup, test_store_many_no_default, teardown);
 
 	g_test_add ("/service/set-alias-sync", Test, "mock-service-normal.py", setup, test_set_alias_sync, teardown);
 
+	if (g_test_perf ()) {
+		g_test_add ("/service/benchmark-lookup", Test, "mock-service-normal.py", setup, test_benchmark_lookup, teardown);
+		g_test_add ("/service/benchmark-lookup-no-extensions", Test, "mock-service-no-extensions.py", setup, test_benchmark_lookup, teardown);
+		g_test_add ("/service/benchmark-lookup-cached", Test, "mock-service-normal.py", setup_cache, test_benchmark_lookup, teardown);
+		g_test_add ("/service/benchmark-records", Test, "mock-service-many.py", setup, test_benchmark_records, teardown);
+		g_test_add ("/service/benchmark-records-stream", Test, "mock-service-many.py", setup, test_benchmark_records_stream, teardown);
+		g_test_add ("/service/benchmark-clear", Test, "mock-service-many.py", setup, test_benchmark_clear, teardown);
+		g_test_add ("/service/benchmark-clear-no-extensions", Test, "mock-service-many-no-extensions.py", setup, test_benchmark_clear, teardown);
+	}
+
 	return egg_tests_run_with_loop ();
 }
@@ -14,6 +14,7 @@
 
 #include "config.h"
 
+#include "secret-attributes.h"
 #include "secret-password.h"
 #include "secret-paths.h"
 #include "secret-private.h"
@@ -79,6 +80,22 @@ teardown (Test *test,
 	mock_service_stop ();
 }
 
+static void
+setup_io_thread (Test *test,
+                 gconstpointer data)
+{
+	setup (test, data);
+	secret_service_set_io_thread (TRUE);
+}
+
+static void
+teardown_io_thread (Test *test,
+                    gconstpointer unused)
+{
+	secret_service_set_io_thread (FALSE);
+	teardown (test, unused);
+}
+
 static void
 on_complete_get_result (GObject *source,
                         GAsyncResult *result,
@@ -160,6 +177,127 @@ test_lookup_no_name (Test *test,
 	secret_password_free (password);
 }
 
+static void
+test_lookup_many_sync (Test *test,
+                       gconstpointer used)
+{
+	GHashTable *attributes[5];
+	GPtrArray *passwords;
+	GError *error = NULL;
+	guint i;
+
+	attributes[0] = secret_attributes_build (&MOCK_SCHEMA, "number", 1, "string", "one", NULL);
+	attributes[1] = secret_attributes_build (&MOCK_SCHEMA, "number", 5, NULL);
+	attributes[2] = secret_attributes_build (&MOCK_SCHEMA, "string", "three", NULL);
+	attributes[3] = secret_attributes_build (&MOCK_SCHEMA, "number", 1, "string", "one", NULL);
+	attributes[4] = secret_attributes_build (&MOCK_SCHEMA, "string", "dos", NULL);
+
+	passwords = secret_password_lookup_many_sync (&MOCK_SCHEMA, attributes,
+	                                              G_N_ELEMENTS (attributes),
+	                                              NULL, &error);
+	g_assert_no_error (error);
+
+	/* Results are positional, with NULL for no match, and locked items unlocked */
+	g_assert_cmpuint (passwords->len, ==, 5);
+	g_assert_cmpstr (passwords->pdata[0], ==, "111");
+	g_assert (passwords->pdata[1] == NULL);
+	g_assert_cmpstr (passwords->pdata[2], ==, "333");
+	g_assert_cmpstr (passwords->pdata[3], ==, "111");
+	g_assert_cmpstr (passwords->pdata[4], ==, "222");
+
+	g_ptr_array_unref (passwords);
+	for (i = 0; i < G_N_ELEMENTS (attributes); i++)
+		g_hash_table_unref (attributes[i]);
+}
+
+static void
+test_lookup_many_async (Test *test,
+                        gconstpointer used)
+{
+	GAsyncResult *result = NULL;
+	GPtrArray *passwords;
+	GError *error = NULL;
+	GList *attributes = NULL;
+
+	attributes = g_list_append (attributes, secret_attributes_build (&MOCK_SCHEMA, "number", 2, NULL));
+	attributes = g_list_append (attributes, secret_attributes_build (&MOCK_SCHEMA, "string", "none", NULL));
+	attributes = g_list_append (attributes, secret_attributes_build (&MOCK_SCHEMA, "string", "one", NULL));
+
+	secret_password_lookup_manyv (&MOCK_SCHEMA, attributes, NULL,
+	                              on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	passwords = secret_password_lookup_many_finish (result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	g_assert_cmpuint (passwords->len, ==, 3);
+	g_assert_cmpstr (passwords->pdata[0], ==, "222");
+	g_assert (passwords->pdata[1] == NULL);
+	g_assert_cmpstr (passwords->pdata[2], ==, "111");
+
+	g_ptr_array_unref (passwords);
+	g_list_free_full (attributes, (GDestroyNotify)g_hash_table_unref);
+}
+
+static void
+test_lookup_many_empty (Test *test,
+                        gconstpointer used)
+{
+	GPtrArray *passwords;
+	GError *error = NULL;
+
+	passwords = secret_password_lookup_many_sync (&MOCK_SCHEMA, NULL, 0, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpuint (passwords->len, ==, 0);
+	g_ptr_array_unref (passwords);
+}
+
+static void
+test_store_many_async (Test *test,
+                       gconstpointer used)
+{
+	const gchar *labels[] = { "Label One", "Label Two" };
+	const gchar *passwords[] = { "the password", "another password" };
+	GHashTable *attributes[2];
+	GAsyncResult *result = NULL;
+	GPtrArray *found;
+	GPtrArray *errors;
+	GError *error = NULL;
+	gboolean ret;
+
+	attributes[0] = secret_attributes_build (&MOCK_SCHEMA, "string", "twelve", "number", 12, NULL);
+	attributes[1] = secret_attributes_build (&MOCK_SCHEMA, "string", "thirteen", "number", 13, NULL);
+
+	secret_password_store_many (&MOCK_SCHEMA, attributes, labels, passwords, 2,
+	                            SECRET_COLLECTION_DEFAULT, NULL,
+	                            on_complete_get_result, &result);
+	g_assert (result == NULL);
+
+	egg_test_wait ();
+
+	ret = secret_password_store_many_finish (result, &errors, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_object_unref (result);
+
+	g_assert_cmpuint (errors->len, ==, 2);
+	g_assert (errors->pdata[0] == NULL);
+	g_assert (errors->pdata[1] == NULL);
+	g_ptr_array_unref (errors);
+
+	found = secret_password_lookup_many_sync (&MOCK_SCHEMA, attributes, 2, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (found->pdata[0], ==, "the password");
+	g_assert_cmpstr (found->pdata[1], ==, "another password");
+	g_ptr_array_unref (found);
+
+	g_hash_table_unref (attributes[0]);
+	g_hash_table_unref (attributes[1]);
+}
+
 static void
 test_store_sync (Test *test,
                   gconstpointer used)
@@ -364,6 +502,114 @@ test_clear_no_name (Test *test,
 	g_assert (ret == TRUE);
 }
 
+static gpointer
+lookup_in_thread (gpointer data)
+{
+	guint iterations = GPOINTER_TO_UINT (data);
+	GError *error = NULL;
+	gchar *password;
+	guint i;
+
+	for (i = 0; i < iterations; i++) {
+		password = secret_password_lookup_sync (&MOCK_SCHEMA, NULL, &error,
+		                                        "even", FALSE,
+		                                        "string", "one",
+		                                        "number", 1,
+		                                        NULL);
+		g_assert_no_error (error);
+		g_assert_cmpstr (password, ==, "111");
+		secret_password_free (password);
+	}
+
+	return NULL;
+}
+
+static gdouble
+lookup_in_threads (guint n_threads,
+                   guint iterations)
+{
+	GThread **threads;
+	gdouble elapsed;
+	guint i;
+
+	threads = g_new0 (GThread *, n_threads);
+
+	g_test_timer_start ();
+	for (i = 0; i < n_threads; i++)
+		threads[i] = g_thread_new ("lookup", lookup_in_thread, GUINT_TO_POINTER (iterations));
+	for (i = 0; i < n_threads; i++)
+		g_thread_join (threads[i]);
+	elapsed = g_test_timer_elapsed ();
+
+	g_free (threads);
+	return elapsed;
+}
+
+static void
+test_io_thread (Test *test,
+                gconstpointer used)
+{
+	GError *error = NULL;
+	gchar *password;
+	gboolean ret;
+
+	lookup_in_threads (8, 10);
+
+	ret = secret_password_store_sync (&MOCK_SCHEMA, "/org/freedesktop/secrets/collection/english",
+	                                  "Label here", "the password", NULL, &error,
+	                                  "string", "twenty two",
+	                                  "number", 22,
+	                                  "even", TRUE,
+	                                  NULL);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	password = secret_password_lookup_sync (&MOCK_SCHEMA, NULL, &error,
+	                                        "string", "twenty two",
+	                                        "number", 22,
+	                                        "even", TRUE,
+	                                        NULL);
+	g_assert_no_error (error);
+	g_assert_cmpstr (password, ==, "the password");
+	secret_password_free (password);
+
+	ret = secret_password_clear_sync (&MOCK_SCHEMA, NULL, &error,
+	                                  "string", "twenty two",
+	                                  "number", 22,
+	                                  "even", TRUE,
+	                                  NULL);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+}
+
+static void
+benchmark_threads (const gchar *mode)
+{
+	guint iterations = 50;
+	gdouble elapsed;
+	guint n;
+
+	for (n = 1; n <= 64; n *= 2) {
+		elapsed = lookup_in_threads (n, iterations);
+		g_test_minimized_result (elapsed, "%u threads%s: %.0f lookups/sec",
+		                         n, mode, (n * iterations) / elapsed);
+	}
+}
+
+static void
+test_benchmark_threads (Test *test,
+                        gconstpointer used)
+{
+	benchmark_threads ("");
+}
+
+static void
+test_benchmark_threads_io_thread (Test *test,
+                                  gconstpointer used)
+{
+	benchmark_threads (" with io thread");
+}
+
 static void
 test_password_free_null (void)
 {
@@ -382,16 +628,27 @@ main (int argc, char **argv)
 	g_test_add ("/password/lookup-sync", Test, "mock-service-normal.py", setup, test_lookup_sync, teardown);
 	g_test_add ("/password/lookup-async", Test, "mock-service-normal.py", setup, test_lookup_async, teardown);
 	g_test_add ("/password/lookup-no-name", Test, "mock-service-normal.py", setup, test_lookup_no_name, teardown);
+	g_test_add ("/password/lookup-many-sync", Test, "mock-service-normal.py", setup, test_lookup_many_sync, teardown);
+	g_test_add ("/password/lookup-many-async", Test, "mock-service-normal.py", setup, test_lookup_many_async, teardown);
+	g_test_add ("/password/lookup-many-empty", Test, "mock-service-normal.py", setup, test_lookup_many_empty, teardown);
 
 	g_test_add ("/password/store-sync", Test, "mock-service-normal.py", setup, test_store_sync, teardown);
 	g_test_add ("/password/store-async", Test, "mock-service-normal.py", setup, test_store_async, teardown);
 	g_test_add ("/password/store-unlock", Test, "mock-service-normal.py", setup, test_store_unlock, teardown);
+	g_test_add ("/password/store-many-async", Test, "mock-service-normal.py", setup, test_store_many_async, teardown);
 
 	g_test_add ("/password/delete-sync", Test, "mock-service-delete.py", setup, test_delete_sync, teardown);
 	g_test_add ("/password/delete-async", Test, "mock-service-delete.py", setup, test_delete_async, teardown);
 	g_test_add ("/password/clear-no-name", Test, "mock-service-delete.py", setup, test_clear_no_name, teardown);
 
+	g_test_add ("/password/io-thread", Test, "mock-service-normal.py", setup_io_thread, test_io_thread, teardown_io_thread);
+
 	g_test_add_func ("/password/free-null", test_password_free_null);
 
+	if (g_test_perf ()) {
+		g_test_add ("/password/benchmark-threads", Test, "mock-service-normal.py", setup, test_benchmark_threads, teardown);
+		g_test_add ("/password/benchmark-threads-io-thread", Test, "mock-service-normal.py", setup_io_thread, test_benchmark_threads_io_thread, teardown_io_thread);
+	}
+
 	return egg_tests_run_with_loop ();
 }
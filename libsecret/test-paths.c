@@ -436,6 +436,43 @@ test_delete_for_path_sync_prompt (Test *test,
 	g_assert (ret == TRUE);
 }
 
+static void
+test_delete_for_path_sync_error (Test *test,
+                                 gconstpointer used)
+
+{
+	const gchar *path_item_one = "/org/freedesktop/secrets/collection/todelete/item";
+	GAsyncResult *result = NULL;
+	GError *error = NULL;
+	gchar *message;
+	gboolean ret;
+
+	ret = secret_service_delete_item_dbus_path_sync (test->service, path_item_one, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	/* Already gone, and the message reads the same as the async one */
+	ret = secret_service_delete_item_dbus_path_sync (test->service, path_item_one, NULL, &error);
+	g_assert (error != NULL);
+	g_assert (ret == FALSE);
+	g_assert (!g_dbus_error_is_remote_error (error));
+	g_assert (!g_str_has_prefix (error->message, "GDBus.Error:"));
+	message = g_strdup (error->message);
+	g_clear_error (&error);
+
+	secret_service_delete_item_dbus_path (test->service, path_item_one, NULL,
+	                                      on_complete_get_result, &result);
+	egg_test_wait ();
+
+	ret = secret_service_delete_item_dbus_path_finish (test->service, result, &error);
+	g_assert (error != NULL);
+	g_assert (ret == FALSE);
+	g_assert_cmpstr (error->message, ==, message);
+	g_clear_error (&error);
+	g_object_unref (result);
+	g_free (message);
+}
+
 static void
 test_lock_paths_sync (Test *test,
                       gconstpointer used)
@@ -757,6 +794,7 @@ main (int argc, char **argv)
 	g_test_add ("/service/secrets-for-paths-async", Test, "mock-service-normal.py", setup, test_secrets_for_paths_async, teardown);
 
 	g_test_add ("/service/delete-for-path", Test, "mock-service-delete.py", setup, test_delete_for_path_sync, teardown);
+	g_test_add ("/service/delete-for-path-error", Test, "mock-service-delete.py", setup, test_delete_for_path_sync_error, teardown);
 	g_test_add ("/service/delete-for-path-with-prompt", Test, "mock-service-delete.py", setup, test_delete_for_path_sync_prompt, teardown);
 
 	g_test_add ("/service/lock-paths-sync", Test, "mock-service-lock.py", setup, test_lock_paths_sync, teardown);
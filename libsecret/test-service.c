@@ -166,6 +166,162 @@ test_get_async (Test *test,
 	g_assert (service3 == NULL);
 }
 
+static void
+on_complete_get_results (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	GPtrArray *results = user_data;
+	g_ptr_array_add (results, g_object_ref (result));
+	if (results->len == 3)
+		egg_test_wait_stop ();
+}
+
+static void
+test_get_concurrent (Test *test,
+                     gconstpointer data)
+{
+	SecretService *services[3];
+	GPtrArray *results;
+	GError *error = NULL;
+	GList *collections;
+	guint i;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* All started before the proxy exists, so these share its creation */
+	secret_service_get (SECRET_SERVICE_NONE, NULL, on_complete_get_results, results);
+	secret_service_get (SECRET_SERVICE_OPEN_SESSION, NULL, on_complete_get_results, results);
+	secret_service_get (SECRET_SERVICE_LOAD_COLLECTIONS, NULL, on_complete_get_results, results);
+	g_assert_cmpuint (results->len, ==, 0);
+
+	egg_test_wait ();
+	g_assert_cmpuint (results->len, ==, 3);
+
+	for (i = 0; i < 3; i++) {
+		services[i] = secret_service_get_finish (results->pdata[i], &error);
+		g_assert_no_error (error);
+		g_assert (SECRET_IS_SERVICE (services[i]));
+	}
+
+	g_assert (services[0] == services[1]);
+	g_assert (services[1] == services[2]);
+
+	/* The later callers' flags were ensured on the shared proxy */
+	g_assert (secret_service_get_session_dbus_path (services[0]) != NULL);
+	collections = secret_service_get_collections (services[0]);
+	g_assert (collections != NULL);
+	g_list_free_full (collections, g_object_unref);
+
+	for (i = 0; i < 3; i++)
+		g_object_unref (services[i]);
+	g_ptr_array_unref (results);
+}
+
+static gpointer
+get_sync_thread (gpointer unused)
+{
+	GError *error = NULL;
+	SecretService *service;
+
+	service = secret_service_get_sync (SECRET_SERVICE_NONE, NULL, &error);
+	g_assert_no_error (error);
+	return service;
+}
+
+static void
+test_get_concurrent_sync (Test *test,
+                          gconstpointer data)
+{
+	GAsyncResult *result = NULL;
+	SecretService *service;
+	SecretService *same;
+	SecretService *other;
+	GError *error = NULL;
+	GThread *thread;
+
+	/* Another thread waits for the creation started here */
+	secret_service_get (SECRET_SERVICE_NONE, NULL, on_complete_get_result, &result);
+	thread = g_thread_new ("get-sync", get_sync_thread, NULL);
+
+	/* This thread started the creation, so creates its own, but gets the same proxy */
+	same = secret_service_get_sync (SECRET_SERVICE_NONE, NULL, &error);
+	g_assert_no_error (error);
+
+	egg_test_wait ();
+	service = secret_service_get_finish (result, &error);
+	g_assert_no_error (error);
+	g_object_unref (result);
+
+	other = g_thread_join (thread);
+
+	g_assert (SECRET_IS_SERVICE (service));
+	g_assert (service == same);
+	g_assert (service == other);
+
+	g_object_unref (service);
+	g_object_unref (same);
+	g_object_unref (other);
+}
+
+typedef struct {
+	GAsyncResult *result;
+	guint *completed;
+} GetResult;
+
+static void
+on_complete_get_slot (GObject *source,
+                      GAsyncResult *result,
+                      gpointer user_data)
+{
+	GetResult *slot = user_data;
+	g_assert (slot->result == NULL);
+	slot->result = g_object_ref (result);
+	if (++(*slot->completed) == 3)
+		egg_test_wait_stop ();
+}
+
+static void
+test_get_concurrent_flags (Test *test,
+                           gconstpointer data)
+{
+	GetResult slots[3] = { { NULL, }, };
+	SecretService *service;
+	GError *error = NULL;
+	guint completed = 0;
+	guint i;
+
+	for (i = 0; i < 3; i++)
+		slots[i].completed = &completed;
+
+	/* The first caller's flags fail, which mustn't fail the shared creation */
+	secret_service_get (SECRET_SERVICE_OPEN_SESSION, NULL, on_complete_get_slot, &slots[0]);
+	secret_service_get (SECRET_SERVICE_NONE, NULL, on_complete_get_slot, &slots[1]);
+	secret_service_get (SECRET_SERVICE_LOAD_COLLECTIONS, NULL, on_complete_get_slot, &slots[2]);
+
+	egg_test_wait ();
+	g_assert_cmpuint (completed, ==, 3);
+
+	service = secret_service_get_finish (slots[0].result, &error);
+	g_assert (error != NULL);
+	g_assert (service == NULL);
+	g_clear_error (&error);
+
+	service = secret_service_get_finish (slots[1].result, &error);
+	g_assert_no_error (error);
+	g_assert (SECRET_IS_SERVICE (service));
+	g_assert (secret_service_get_session_dbus_path (service) == NULL);
+	g_object_unref (service);
+
+	service = secret_service_get_finish (slots[2].result, &error);
+	g_assert_no_error (error);
+	g_assert (secret_service_get_flags (service) & SECRET_SERVICE_LOAD_COLLECTIONS);
+	g_object_unref (service);
+
+	for (i = 0; i < 3; i++)
+		g_object_unref (slots[i].result);
+}
+
 static void
 test_get_more_sync (Test *test,
                     gconstpointer data)
@@ -606,6 +762,9 @@ main (int argc, char **argv)
 
 	g_test_add ("/service/get-sync", Test, "mock-service-normal.py", setup_mock, test_get_sync, teardown_mock);
 	g_test_add ("/service/get-async", Test, "mock-service-normal.py", setup_mock, test_get_async, teardown_mock);
+	g_test_add ("/service/get-concurrent", Test, "mock-service-normal.py", setup_mock, test_get_concurrent, teardown_mock);
+	g_test_add ("/service/get-concurrent-sync", Test, "mock-service-normal.py", setup_mock, test_get_concurrent_sync, teardown_mock);
+	g_test_add ("/service/get-concurrent-flags", Test, "mock-service-no-session.py", setup_mock, test_get_concurrent_flags, teardown_mock);
 	g_test_add ("/service/get-more-sync", Test, "mock-service-normal.py", setup_mock, test_get_more_sync, teardown_mock);
 	g_test_add ("/service/get-more-async", Test, "mock-service-normal.py", setup_mock, test_get_more_async, teardown_mock);
 
@@ -26,6 +26,15 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_GCRY_ECC_MUL_POINT
+#define PREFERRED_ALGORITHMS "x25519-sha256-aes128-gcm"
+#define FALLBACK_ALGORITHMS "x25519-sha256-aes128-cbc-pkcs7"
+#else
+#define PREFERRED_ALGORITHMS "dh-ietf1024-sha256-aes128-cbc-pkcs7"
+#define FALLBACK_ALGORITHMS "dh-ietf1024-sha256-aes128-cbc-pkcs7"
+#endif
 
 typedef struct {
 	SecretService *service;
@@ -71,7 +80,7 @@ test_ensure (Test *test,
 	g_assert_no_error (error);
 	g_assert (ret == TRUE);
 	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
-	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, PREFERRED_ALGORITHMS);
 }
 
 static void
@@ -89,18 +98,172 @@ test_ensure_twice (Test *test,
 	g_assert_no_error (error);
 	g_assert (ret == TRUE);
 	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
-	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, PREFERRED_ALGORITHMS);
 
 	path = g_strdup (secret_service_get_session_dbus_path (test->service));
 	ret = secret_service_ensure_session_sync (test->service, NULL, &error);
 	g_assert_no_error (error);
 	g_assert (ret == TRUE);
 	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), ==, path);
-	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, PREFERRED_ALGORITHMS);
 
 	g_free (path);
 }
 
+static void
+test_ensure_dh (Test *test,
+                gconstpointer unused)
+{
+	GError *error = NULL;
+	gboolean ret;
+
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), ==, NULL);
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, NULL);
+
+	ret = secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+}
+
+static void
+wait_for_pregenerated (void)
+{
+	gboolean ready = FALSE;
+	guint i;
+
+	for (i = 0; i < 5000 && !ready; i++) {
+		g_usleep (1000);
+		_secret_session_get_pregenerate_stats (NULL, NULL, NULL, &ready);
+	}
+
+	g_assert (ready == TRUE);
+}
+
+static void
+test_pregenerate_dh (Test *test,
+                     gconstpointer unused)
+{
+	SecretService *other;
+	GError *error = NULL;
+	gboolean pending;
+	guint missed;
+	guint taken;
+	gboolean ret;
+
+	_secret_session_set_pregenerate (TRUE);
+
+	/* Nothing ready yet, so the key pair is generated while opening */
+	ret = secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+
+	_secret_session_get_pregenerate_stats (&taken, &missed, &pending, NULL);
+	g_assert_cmpuint (taken, ==, 0);
+	g_assert_cmpuint (missed, ==, 1);
+	g_assert (pending == TRUE);
+
+	/* The next session uses the key pair generated in the background */
+	wait_for_pregenerated ();
+	other = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_NONE,
+	                                  NULL, &error);
+	g_assert_no_error (error);
+	ret = secret_service_ensure_session_sync (other, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_algorithms (other), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+
+	_secret_session_get_pregenerate_stats (&taken, &missed, NULL, NULL);
+	g_assert_cmpuint (taken, ==, 1);
+	g_assert_cmpuint (missed, ==, 1);
+
+	g_object_unref (other);
+	_secret_session_set_pregenerate (FALSE);
+}
+
+static void
+test_pregenerate_init (Test *test,
+                       gconstpointer unused)
+{
+	SecretService *other;
+	GError *error = NULL;
+	gboolean pending;
+	guint missed;
+	guint taken;
+	gboolean ret;
+
+	_secret_session_set_pregenerate (TRUE);
+
+	/* Before any session was opened, initializing the service starts on one */
+	other = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_NONE,
+	                                  NULL, &error);
+	g_assert_no_error (error);
+
+	_secret_session_get_pregenerate_stats (NULL, NULL, &pending, NULL);
+	g_assert (pending == TRUE);
+
+	wait_for_pregenerated ();
+	ret = secret_service_ensure_session_sync (other, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_algorithms (other), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+
+	_secret_session_get_pregenerate_stats (&taken, &missed, NULL, NULL);
+	g_assert_cmpuint (taken, ==, 1);
+	g_assert_cmpuint (missed, ==, 0);
+
+	g_object_unref (other);
+	_secret_session_set_pregenerate (FALSE);
+}
+
+static void
+test_pregenerate_x25519 (Test *test,
+                         gconstpointer unused)
+{
+	SecretService *other;
+	GError *error = NULL;
+	gboolean pending;
+	gboolean ret;
+
+	_secret_session_set_pregenerate (TRUE);
+
+	ret = secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, PREFERRED_ALGORITHMS);
+
+	/* No key pair is worked on that nobody is going to use */
+	_secret_session_get_pregenerate_stats (NULL, NULL, &pending, NULL);
+	g_assert (pending == FALSE);
+
+	/* Not even when another service is initialized */
+	other = secret_service_open_sync (SECRET_TYPE_SERVICE, NULL, SECRET_SERVICE_NONE,
+	                                  NULL, &error);
+	g_assert_no_error (error);
+	_secret_session_get_pregenerate_stats (NULL, NULL, &pending, NULL);
+	g_assert (pending == FALSE);
+	g_object_unref (other);
+
+	_secret_session_set_pregenerate (FALSE);
+}
+
+static void
+test_ensure_no_aead (Test *test,
+                     gconstpointer unused)
+{
+	GError *error = NULL;
+	gboolean ret;
+
+	ret = secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+
+	g_assert (ret == TRUE);
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, FALLBACK_ALGORITHMS);
+}
+
 static void
 test_ensure_plain (Test *test,
                    gconstpointer unused)
@@ -170,7 +333,7 @@ test_ensure_async_aes (Test *test,
 
 	g_assert (ret == TRUE);
 	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
-	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, "dh-ietf1024-sha256-aes128-cbc-pkcs7");
+	g_assert_cmpstr (secret_service_get_session_algorithms (test->service), ==, PREFERRED_ALGORITHMS);
 
 	g_object_unref (result);
 }
@@ -214,6 +377,329 @@ test_ensure_async_twice (Test *test,
 	g_free (path);
 }
 
+static void
+on_complete_get_results (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	GPtrArray *results = user_data;
+	g_ptr_array_add (results, g_object_ref (result));
+	if (results->len == 4)
+		egg_test_wait_stop ();
+}
+
+static void
+test_ensure_concurrent (Test *test,
+                        gconstpointer unused)
+{
+	GPtrArray *results;
+	GError *error = NULL;
+	guint opened;
+	guint coalesced;
+	guint i;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* Only the first of these negotiates, the others wait for it */
+	for (i = 0; i < 4; i++)
+		secret_service_ensure_session (test->service, NULL, on_complete_get_results, results);
+	egg_test_wait ();
+
+	g_assert_cmpuint (results->len, ==, 4);
+	for (i = 0; i < results->len; i++) {
+		g_assert (secret_service_ensure_session_finish (test->service, results->pdata[i], &error));
+		g_assert_no_error (error);
+	}
+
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
+
+	_secret_service_get_session_stats (test->service, &opened, &coalesced);
+	g_assert_cmpuint (opened, ==, 1);
+	g_assert_cmpuint (coalesced, ==, 3);
+
+	g_ptr_array_unref (results);
+}
+
+static void
+test_ensure_concurrent_cancel (Test *test,
+                               gconstpointer unused)
+{
+	GCancellable *cancellable;
+	GPtrArray *results;
+	GError *error = NULL;
+	guint cancelled = 0;
+	guint i;
+
+	results = g_ptr_array_new_with_free_func (g_object_unref);
+	cancellable = g_cancellable_new ();
+
+	/* Cancelling one waiter leaves the shared negotiation to the others */
+	for (i = 0; i < 4; i++)
+		secret_service_ensure_session (test->service, i == 2 ? cancellable : NULL,
+		                               on_complete_get_results, results);
+	g_cancellable_cancel (cancellable);
+	egg_test_wait ();
+
+	g_assert_cmpuint (results->len, ==, 4);
+	for (i = 0; i < results->len; i++) {
+		if (secret_service_ensure_session_finish (test->service, results->pdata[i], &error)) {
+			g_assert_no_error (error);
+		} else {
+			g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+			g_clear_error (&error);
+			cancelled++;
+		}
+	}
+
+	g_assert_cmpuint (cancelled, ==, 1);
+	g_assert_cmpstr (secret_service_get_session_dbus_path (test->service), !=, NULL);
+
+	g_object_unref (cancellable);
+	g_ptr_array_unref (results);
+}
+
+static void
+test_decode_many (Test *test,
+                  gconstpointer unused)
+{
+	SecretSession *session;
+	GError *error = NULL;
+	GVariant *encoded[1000];
+	SecretValue *decoded[1000];
+	SecretValue *value;
+	const gchar *data;
+	gchar *text;
+	gsize length;
+	guint i;
+
+	secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+
+	session = _secret_service_get_session (test->service);
+	g_assert (session != NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (encoded); i++) {
+		text = g_strdup_printf ("secret number %u", i);
+		value = secret_value_new (text, -1, "text/plain");
+		encoded[i] = g_variant_ref_sink (_secret_session_encode_secret (session, value));
+		secret_value_unref (value);
+		g_free (text);
+	}
+
+	/* A large total size forces the parallel path for AES sessions */
+	_secret_session_decode_secrets (session, encoded, decoded,
+	                                G_N_ELEMENTS (encoded), G_MAXSIZE);
+
+	for (i = 0; i < G_N_ELEMENTS (encoded); i++) {
+		g_assert (decoded[i] != NULL);
+		text = g_strdup_printf ("secret number %u", i);
+		data = secret_value_get (decoded[i], &length);
+		g_assert_cmpuint (length, ==, strlen (text));
+		g_assert (memcmp (data, text, length) == 0);
+		g_free (text);
+
+		secret_value_unref (decoded[i]);
+		g_variant_unref (encoded[i]);
+	}
+}
+
+static void
+test_decode_large_plain (Test *test,
+                         gconstpointer unused)
+{
+	SecretSession *session;
+	GError *error = NULL;
+	GVariant *encoded;
+	SecretValue *value;
+	SecretValue *decoded;
+	const gchar *reply;
+	const gchar *data;
+	gchar *text;
+	gsize n_reply;
+	gsize length;
+
+	/* Borrowing the reply is opt in */
+	g_setenv ("SECRET_PLAIN_BORROW", "1", TRUE);
+	secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_unsetenv ("SECRET_PLAIN_BORROW");
+	g_assert_no_error (error);
+
+	session = _secret_service_get_session (test->service);
+	g_assert_cmpstr (_secret_session_get_algorithms (session), ==, "plain");
+
+	length = 64 * 1024;
+	text = g_malloc (length);
+	memset (text, 'x', length);
+	value = secret_value_new (text, length, "application/octet-stream");
+
+	encoded = g_variant_ref_sink (_secret_session_encode_secret (session, value));
+	reply = g_variant_get_data (encoded);
+	n_reply = g_variant_get_size (encoded);
+
+	decoded = _secret_session_decode_secret (session, encoded);
+	g_assert (decoded != NULL);
+
+	/* The decoded value should point into the reply */
+	data = secret_value_get (decoded, &length);
+	g_assert_cmpuint (length, ==, 64 * 1024);
+	g_assert (data >= reply && data + length <= reply + n_reply);
+	g_assert (memcmp (data, text, length) == 0);
+
+	/* And survive the reply going away */
+	g_variant_unref (encoded);
+	data = secret_value_get (decoded, &length);
+	g_assert (memcmp (data, text, length) == 0);
+
+	decoded = secret_value_move_to_secure (decoded);
+	data = secret_value_get (decoded, &length);
+	g_assert_cmpuint (length, ==, 64 * 1024);
+	g_assert (memcmp (data, text, length) == 0);
+
+	secret_value_unref (decoded);
+	secret_value_unref (value);
+	g_free (text);
+}
+
+static void
+test_decode_large_plain_secure (Test *test,
+                                gconstpointer unused)
+{
+	SecretSession *session;
+	GError *error = NULL;
+	GVariant *encoded;
+	SecretValue *value;
+	SecretValue *decoded;
+	const gchar *reply;
+	const gchar *data;
+	gchar *text;
+	gsize n_reply;
+	gsize length;
+
+	secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+
+	session = _secret_service_get_session (test->service);
+	g_assert_cmpstr (_secret_session_get_algorithms (session), ==, "plain");
+
+	length = 64 * 1024;
+	text = g_malloc (length);
+	memset (text, 'x', length);
+	value = secret_value_new (text, length, "application/octet-stream");
+
+	encoded = g_variant_ref_sink (_secret_session_encode_secret (session, value));
+	reply = g_variant_get_data (encoded);
+	n_reply = g_variant_get_size (encoded);
+
+	decoded = _secret_session_decode_secret (session, encoded);
+	g_assert (decoded != NULL);
+
+	/* Without opting in the value is copied out of the reply */
+	data = secret_value_get (decoded, &length);
+	g_assert_cmpuint (length, ==, 64 * 1024);
+	g_assert (data + length <= reply || data >= reply + n_reply);
+	g_assert (memcmp (data, text, length) == 0);
+
+	/* So already in secure memory */
+	g_assert (secret_value_move_to_secure (secret_value_ref (decoded)) == decoded);
+	secret_value_unref (decoded);
+
+	g_variant_unref (encoded);
+	secret_value_unref (decoded);
+	secret_value_unref (value);
+	g_free (text);
+}
+
+static void
+benchmark_roundtrip (SecretSession *session,
+                     gsize length,
+                     guint iterations)
+{
+	SecretValue *value;
+	SecretValue *check;
+	GVariant *encoded;
+	gdouble encode = 0;
+	gdouble decode = 0;
+	gchar *data;
+	guint i;
+
+	data = g_malloc (length);
+	memset (data, 'x', length);
+	value = secret_value_new (data, length, "text/plain");
+	g_free (data);
+
+	for (i = 0; i < iterations; i++) {
+		g_test_timer_start ();
+		encoded = _secret_session_encode_secret (session, value);
+		encode += g_test_timer_elapsed ();
+		g_assert (encoded != NULL);
+		g_variant_ref_sink (encoded);
+
+		g_test_timer_start ();
+		check = _secret_session_decode_secret (session, encoded);
+		decode += g_test_timer_elapsed ();
+		g_assert (check != NULL);
+
+		g_variant_unref (encoded);
+		secret_value_unref (check);
+	}
+
+	g_test_minimized_result (encode / iterations,
+	                         "%s encode %" G_GSIZE_FORMAT " bytes: %.3f usec per secret",
+	                         _secret_session_get_algorithms (session), length,
+	                         (encode / iterations) * G_USEC_PER_SEC);
+	g_test_minimized_result (decode / iterations,
+	                         "%s decode %" G_GSIZE_FORMAT " bytes: %.3f usec per secret",
+	                         _secret_session_get_algorithms (session), length,
+	                         (decode / iterations) * G_USEC_PER_SEC);
+
+	secret_value_unref (value);
+}
+
+static void
+test_benchmark_open (Test *test,
+                     gconstpointer unused)
+{
+	GAsyncResult *result;
+	GError *error = NULL;
+	gdouble elapsed = 0;
+	guint iterations = 50;
+	guint i;
+
+	for (i = 0; i < iterations; i++) {
+		result = NULL;
+		g_test_timer_start ();
+		_secret_session_open (test->service, NULL, on_complete_get_result, &result);
+		egg_test_wait ();
+		elapsed += g_test_timer_elapsed ();
+
+		_secret_session_open_finish (result, &error);
+		g_assert_no_error (error);
+		g_object_unref (result);
+	}
+
+	g_test_minimized_result (elapsed / iterations, "%s open session: %.3f msec",
+	                         secret_service_get_session_algorithms (test->service),
+	                         (elapsed / iterations) * 1000);
+}
+
+static void
+test_benchmark_secrets (Test *test,
+                        gconstpointer unused)
+{
+	SecretSession *session;
+	GError *error = NULL;
+
+	secret_service_ensure_session_sync (test->service, NULL, &error);
+	g_assert_no_error (error);
+
+	session = _secret_service_get_session (test->service);
+	g_assert (session != NULL);
+
+	benchmark_roundtrip (session, 32, 5000);
+	benchmark_roundtrip (session, 4096, 2000);
+	benchmark_roundtrip (session, 1024 * 1024, 20);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -225,10 +711,32 @@ main (int argc, char **argv)
 
 	g_test_add ("/session/ensure-aes", Test, "mock-service-normal.py", setup, test_ensure, teardown);
 	g_test_add ("/session/ensure-twice", Test, "mock-service-normal.py", setup, test_ensure_twice, teardown);
+	g_test_add ("/session/ensure-dh", Test, "mock-service-only-dh.py", setup, test_ensure_dh, teardown);
+	g_test_add ("/session/pregenerate-dh", Test, "mock-service-only-dh.py", setup, test_pregenerate_dh, teardown);
+	g_test_add ("/session/pregenerate-init", Test, "mock-service-only-dh.py", setup, test_pregenerate_init, teardown);
+#ifdef HAVE_GCRY_ECC_MUL_POINT
+	g_test_add ("/session/pregenerate-x25519", Test, "mock-service-normal.py", setup, test_pregenerate_x25519, teardown);
+#endif
+	g_test_add ("/session/ensure-no-aead", Test, "mock-service-no-aead.py", setup, test_ensure_no_aead, teardown);
 	g_test_add ("/session/ensure-plain", Test, "mock-service-only-plain.py", setup, test_ensure_plain, teardown);
 	g_test_add ("/session/ensure-async-aes", Test, "mock-service-normal.py", setup, test_ensure_async_aes, teardown);
 	g_test_add ("/session/ensure-async-plain", Test, "mock-service-only-plain.py", setup, test_ensure_async_plain, teardown);
 	g_test_add ("/session/ensure-async-twice", Test, "mock-service-only-plain.py", setup, test_ensure_async_twice, teardown);
+	g_test_add ("/session/ensure-concurrent", Test, "mock-service-normal.py", setup, test_ensure_concurrent, teardown);
+	g_test_add ("/session/ensure-concurrent-cancel", Test, "mock-service-normal.py", setup, test_ensure_concurrent_cancel, teardown);
+	g_test_add ("/session/decode-many-aes", Test, "mock-service-normal.py", setup, test_decode_many, teardown);
+	g_test_add ("/session/decode-many-cbc", Test, "mock-service-no-aead.py", setup, test_decode_many, teardown);
+	g_test_add ("/session/decode-many-plain", Test, "mock-service-only-plain.py", setup, test_decode_many, teardown);
+	g_test_add ("/session/decode-large-plain", Test, "mock-service-only-plain.py", setup, test_decode_large_plain, teardown);
+	g_test_add ("/session/decode-large-plain-secure", Test, "mock-service-only-plain.py", setup, test_decode_large_plain_secure, teardown);
+
+	if (g_test_perf ()) {
+		g_test_add ("/session/benchmark-open", Test, "mock-service-normal.py", setup, test_benchmark_open, teardown);
+		g_test_add ("/session/benchmark-open-dh", Test, "mock-service-only-dh.py", setup, test_benchmark_open, teardown);
+		g_test_add ("/session/benchmark-aes", Test, "mock-service-normal.py", setup, test_benchmark_secrets, teardown);
+		g_test_add ("/session/benchmark-cbc", Test, "mock-service-no-aead.py", setup, test_benchmark_secrets, teardown);
+		g_test_add ("/session/benchmark-plain", Test, "mock-service-only-plain.py", setup, test_benchmark_secrets, teardown);
+	}
 
 	return egg_tests_run_with_loop ();
 }
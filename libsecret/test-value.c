@@ -116,6 +116,104 @@ test_new_empty (void)
 	secret_value_unref (value);
 }
 
+static void
+on_bytes_freed (gpointer user_data)
+{
+	gboolean *freed = user_data;
+	g_assert (!*freed);
+	*freed = TRUE;
+}
+
+static void
+test_new_for_bytes (void)
+{
+	SecretValue *value;
+	GBytes *bytes;
+	gboolean freed = FALSE;
+	gchar data[] = { 'b', 'l', 'a', 'h', 'X' };
+	gsize length;
+
+	bytes = g_bytes_new_with_free_func (data, 4, on_bytes_freed, &freed);
+	value = secret_value_new_for_bytes (bytes, "text/plain");
+	g_bytes_unref (bytes);
+	g_assert (!freed);
+
+	/* No copy done here */
+	g_assert (secret_value_get (value, &length) == data);
+	g_assert_cmpuint (length, ==, 4);
+
+	/* But the text is null-terminated */
+	g_assert_cmpstr (secret_value_get_text (value), ==, "blah");
+	g_assert (secret_value_get_text (value) != data);
+	g_assert (secret_value_get_text (value) == secret_value_get_text (value));
+
+	secret_value_unref (value);
+	g_assert (freed);
+}
+
+static void
+test_new_for_bytes_empty (void)
+{
+	SecretValue *value;
+	GBytes *bytes;
+	gsize length;
+
+	bytes = g_bytes_new (NULL, 0);
+	value = secret_value_new_for_bytes (bytes, "text/plain");
+	g_bytes_unref (bytes);
+
+	secret_value_get (value, &length);
+	g_assert_cmpuint (length, ==, 0);
+	g_assert_cmpstr (secret_value_get_text (value), ==, "");
+
+	secret_value_unref (value);
+}
+
+static void
+test_move_to_secure (void)
+{
+	SecretValue *value;
+	SecretValue *secure;
+	GBytes *bytes;
+	gboolean freed = FALSE;
+	gchar data[] = { 'b', 'l', 'a', 'h' };
+	gsize length;
+
+	bytes = g_bytes_new_with_free_func (data, 4, on_bytes_freed, &freed);
+	value = secret_value_new_for_bytes (bytes, "application/x-test");
+	g_bytes_unref (bytes);
+
+	secure = secret_value_move_to_secure (value);
+	g_assert (freed);
+	g_assert (secure != value);
+	g_assert_cmpstr (secret_value_get (secure, &length), ==, "blah");
+	g_assert_cmpuint (length, ==, 4);
+	g_assert_cmpstr (secret_value_get_content_type (secure), ==, "application/x-test");
+
+	/* Already secure, nothing to do */
+	value = secret_value_move_to_secure (secure);
+	g_assert (value == secure);
+
+	secret_value_unref (value);
+}
+
+static void
+test_to_password_for_bytes (void)
+{
+	SecretValue *value;
+	GBytes *bytes;
+	gchar *password;
+
+	bytes = g_bytes_new ("blahXXX", 4);
+	value = secret_value_new_for_bytes (bytes, "text/plain");
+	g_bytes_unref (bytes);
+
+	password = _secret_value_unref_to_password (value);
+	g_assert_cmpstr (password, ==, "blah");
+
+	egg_secure_free (password);
+}
+
 static void
 test_ref_unref (void)
 {
@@ -225,12 +323,16 @@ main (int argc, char **argv)
 	g_test_add_func ("/value/new-full", test_new_full);
 	g_test_add_func ("/value/new-full-terminated", test_new_full_terminated);
 	g_test_add_func ("/value/new-empty", test_new_empty);
+	g_test_add_func ("/value/new-for-bytes", test_new_for_bytes);
+	g_test_add_func ("/value/new-for-bytes-empty", test_new_for_bytes_empty);
+	g_test_add_func ("/value/move-to-secure", test_move_to_secure);
 	g_test_add_func ("/value/ref-unref", test_ref_unref);
 	g_test_add_func ("/value/boxed", test_boxed);
 	g_test_add_func ("/value/to-password", test_to_password);
 	g_test_add_func ("/value/to-password-bad-destroy", test_to_password_bad_destroy);
 	g_test_add_func ("/value/to-password-bad-content", test_to_password_bad_content);
 	g_test_add_func ("/value/to-password-extra-ref", test_to_password_extra_ref);
+	g_test_add_func ("/value/to-password-for-bytes", test_to_password_for_bytes);
 
 	return egg_tests_run_with_loop ();
 }